@@ -0,0 +1,542 @@
+/**
+ * @file
+ *
+ * @brief This file contains a tool that measures the throughput of the
+ *        parser.
+ *
+ * The tool measures the structural index (stage 1) on its own and the whole
+ * conversion with and without the structural index for every given file. It
+ * also measures the recognizer of the check mode, which does not create keys.
+ * In directory mode the tool measures how long it takes to convert all files
+ * of a directory tree with and without reading files ahead of the parser,
+ * once with a cold and once with a warm page cache. In watch mode the tool
+ * measures how long readers wait for the keys of a file while the file
+ * changes, once with a lock and once with a watcher.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <kdb.hpp>
+
+#include "check.hpp"
+#include "convert.hpp"
+#include "directory.hpp"
+#include "file.hpp"
+#include "options.hpp"
+#include "structure.hpp"
+
+#if defined(__linux__)
+#include "watcher.hpp"
+#endif
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::exception;
+using std::function;
+using std::lock_guard;
+using std::mutex;
+using std::ofstream;
+using std::string;
+using std::system_category;
+using std::system_error;
+using std::thread;
+using std::to_string;
+using std::vector;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+using kdb::Key;
+using kdb::KeySet;
+
+using yaypeg::checkBuffer;
+using yaypeg::addToKeySet;
+using yaypeg::convertBuffer;
+using yaypeg::loadDirectory;
+using yaypeg::LoadedDirectory;
+using yaypeg::MappedFile;
+using yaypeg::Options;
+using yaypeg::StructuralIndex;
+
+// -- Constants ----------------------------------------------------------------
+
+namespace {
+
+/** @brief This constant specifies how often the tool repeats every
+ *         measurement by default. */
+constexpr size_t defaultIterations = 20;
+
+/** @brief This constant specifies how many generated files the tool stores
+ *         in a single subdirectory. */
+constexpr size_t filesPerDirectory = 100;
+
+#if defined(__linux__)
+/** @brief This constant specifies how many latencies the tool records for
+ *         every reader thread at most. */
+constexpr size_t maximumSamples = 1 << 20;
+#endif
+
+// -- Functions ----------------------------------------------------------------
+
+/**
+ * @brief This function measures the throughput of an operation.
+ *
+ * @param bytes This number specifies how many bytes `operation` processes.
+ * @param iterations This number specifies how often the function runs
+ *                   `operation`.
+ * @param operation This function stores the operation the function measures.
+ *
+ * @return The throughput of the fastest run in megabytes per second
+ */
+double throughput(size_t bytes, size_t iterations,
+                  function<void()> const &operation) {
+  double fastest = 0;
+  for (size_t iteration = 0; iteration < iterations; iteration++) {
+    auto start = steady_clock::now();
+    operation();
+    duration<double> seconds = steady_clock::now() - start;
+    if (iteration == 0 || seconds.count() < fastest) {
+      fastest = seconds.count();
+    }
+  }
+  return fastest > 0 ? static_cast<double>(bytes) / fastest / 1e6 : 0;
+}
+
+/**
+ * @brief This function measures the throughput of the parser for the given
+ *        file.
+ *
+ * @param filename This text stores the path of the file.
+ * @param iterations This number specifies how often the function repeats
+ *                   every measurement.
+ *
+ * @throws system_error if the function is unable to read `filename`
+ * @throws parse_error if the file does not contain (supported) YAML data
+ */
+void benchmark(string const &filename, size_t iterations) {
+  MappedFile file{filename};
+  string input{file.data(), file.size()};
+
+  size_t lines = 0;
+  double stage = throughput(input.size(), iterations, [&input, &lines]() {
+    lines = StructuralIndex{input.data(), input.size()}.lines();
+  });
+
+  Key parent{"user", KEY_END};
+  Options options;
+  auto convert = [&parent, &input, &filename, &options]() {
+    convertBuffer(parent, input.data(), input.size(), filename, options);
+  };
+  double pipeline = throughput(input.size(), iterations, convert);
+  options.structuralIndex = false;
+  double withoutIndex = throughput(input.size(), iterations, convert);
+  double check = throughput(input.size(), iterations, [&input, &filename]() {
+    checkBuffer(input.data(), input.size(), filename);
+  });
+
+  char line[256];
+  snprintf(line, sizeof(line),
+           "%-32s %9zu B %7zu L %9.1f MB/s stage 1 %8.1f MB/s conversion "
+           "%8.1f MB/s without index %8.1f MB/s check",
+           filename.c_str(), input.size(), lines, stage, pipeline,
+           withoutIndex, check);
+  cout << line << endl;
+}
+
+/**
+ * @brief This function creates a directory, if it does not exist already.
+ *
+ * @param path This text stores the path of the directory.
+ *
+ * @throws system_error if the function is unable to create `path`
+ */
+void createDirectory(string const &path) {
+  if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+    throw system_error(errno, system_category(),
+                       "Unable to create directory “" + path + "”");
+  }
+}
+
+/**
+ * @brief This function creates configuration files for the directory
+ *        benchmark.
+ *
+ * @param directory This text stores the path of the directory that stores
+ *                  the files.
+ * @param count This number specifies how many files the function creates.
+ *
+ * @throws system_error if the function is unable to create a file
+ */
+void generate(string const &directory, size_t count) {
+  createDirectory(directory);
+  for (size_t file = 0; file < count; file++) {
+    string group = directory + "/group" + to_string(file / filesPerDirectory);
+    if (file % filesPerDirectory == 0) {
+      createDirectory(group);
+    }
+    string filename = group + "/service" + to_string(file) + ".yaml";
+    ofstream output{filename};
+    output << "name: service" << file << "\n"
+           << "port: " << 8000 + file % 1000 << "\n"
+           << "enabled: true\n"
+           << "tags:\n  - alpha\n  - beta\n"
+           << "limits:\n  memory: 512M\n  cpu: 2\n"
+           << "description: Generated configuration file number " << file
+           << "\n";
+    if (!output.flush()) {
+      throw system_error(errno, system_category(),
+                         "Unable to write file “" + filename + "”");
+    }
+  }
+}
+
+/**
+ * @brief This function removes a file from the page cache.
+ *
+ * The kernel only drops pages that are not modified and not mapped by
+ * another process, so the result only approximates a cold cache. Systems
+ * without `posix_fadvise` (e.g. macOS) keep the file in the cache.
+ *
+ * @param path This text stores the path of the file.
+ * @param type This number specifies the type of the file.
+ *
+ * @return 0 to continue the directory walk
+ */
+int evict(char const *path, struct stat const *, int type, struct FTW *) {
+  if (type != FTW_F) {
+    return 0;
+  }
+#if defined(POSIX_FADV_DONTNEED)
+  int descriptor = open(path, O_RDONLY);
+  if (descriptor >= 0) {
+    fsync(descriptor);
+    posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+    close(descriptor);
+  }
+#else
+  (void)path;
+#endif
+  return 0;
+}
+
+/**
+ * @brief This function measures how long it takes to convert all files of a
+ *        directory tree.
+ *
+ * @param directory This text stores the path of the directory.
+ * @param readers This number specifies how many threads read files ahead of
+ *                the parser.
+ *
+ * @throws system_error if the function is unable to read `directory`
+ */
+void benchmarkDirectory(string const &directory, size_t readers) {
+  Key parent{"user", KEY_END};
+  Options options;
+
+  for (bool cold : {true, false}) {
+    for (size_t threads : {size_t{0}, readers}) {
+      if (cold) {
+        nftw(directory.c_str(), evict, 16, FTW_PHYS);
+      }
+      auto start = steady_clock::now();
+      LoadedDirectory loaded =
+          loadDirectory(parent, directory, options, threads);
+      duration<double> seconds = steady_clock::now() - start;
+
+      char line[192];
+      snprintf(line, sizeof(line),
+               "%-4s cache %2zu readers %7zu files %11zu B %9.3f s "
+               "%8.1f MB/s %zu failures",
+               cold ? "cold" : "warm", threads, loaded.files, loaded.bytes,
+               seconds.count(),
+               static_cast<double>(loaded.bytes) / seconds.count() / 1e6,
+               loaded.failures.size());
+      cout << line << endl;
+    }
+  }
+}
+
+#if defined(__linux__)
+/**
+ * @brief This function measures how long readers wait for keys while
+ *        another thread reloads them.
+ *
+ * @param readers This number specifies how many threads read keys.
+ * @param reloads This number specifies how often the function reloads the
+ *                keys.
+ * @param read This function reads a key.
+ * @param reload This function changes the keys.
+ *
+ * @return The sorted latencies of all reads in microseconds
+ */
+vector<double> latencies(size_t readers, size_t reloads,
+                         function<void()> const &read,
+                         function<void()> const &reload) {
+  std::atomic<bool> done{false};
+  vector<vector<double>> samples(readers);
+  vector<thread> threads;
+  for (size_t reader = 0; reader < readers; reader++) {
+    threads.emplace_back([&done, &read, &own = samples[reader]]() {
+      own.reserve(maximumSamples);
+      while (!done.load(std::memory_order_relaxed)) {
+        auto start = steady_clock::now();
+        read();
+        duration<double, std::micro> waited = steady_clock::now() - start;
+        if (own.size() < maximumSamples) {
+          own.push_back(waited.count());
+        }
+      }
+    });
+  }
+
+  for (size_t iteration = 0; iteration < reloads; iteration++) {
+    reload();
+  }
+  done = true;
+  for (auto &reader : threads) {
+    reader.join();
+  }
+
+  vector<double> all;
+  for (auto const &own : samples) {
+    all.insert(all.end(), own.begin(), own.end());
+  }
+  std::sort(all.begin(), all.end());
+  return all;
+}
+
+/**
+ * @brief This function prints a summary of reader latencies.
+ *
+ * @param name This text describes the way readers accessed the keys.
+ * @param readers This number specifies how many threads read keys.
+ * @param samples This vector stores the sorted latencies in microseconds.
+ */
+void printLatencies(char const *name, size_t readers,
+                    vector<double> const &samples) {
+  auto percentile = [&samples](double fraction) {
+    return samples.empty() ? 0
+                           : samples[static_cast<size_t>(
+                                 fraction * (samples.size() - 1))];
+  };
+  char line[192];
+  snprintf(line, sizeof(line),
+           "%-7s %2zu readers %10zu reads %9.3f µs median %9.3f µs p99 "
+           "%9.3f µs p99.9 %10.3f µs max",
+           name, readers, samples.size(), percentile(0.5), percentile(0.99),
+           percentile(0.999), percentile(1));
+  cout << line << endl;
+}
+
+/**
+ * @brief This function measures the latency of readers while the keys of a
+ *        file change.
+ *
+ * The function compares a key set that a lock protects during reloads with
+ * the snapshots of a watcher. It writes the content of the given file to a
+ * temporary file multiple times and reloads the keys after every write.
+ *
+ * @param filename This text stores the path of the file.
+ * @param readers This number specifies how many threads read keys.
+ * @param reloads This number specifies how often the function changes the
+ *                file.
+ *
+ * @throws system_error if the function is unable to read or write a file
+ * @throws runtime_error if the watcher does not notice a change
+ */
+void benchmarkReload(string const &filename, size_t readers, size_t reloads) {
+  string content = yaypeg::readFile(filename);
+  char path[] = "/tmp/yaypeg-watch-XXXXXX.yaml";
+  int descriptor = mkstemps(path, 5);
+  if (descriptor < 0) {
+    throw system_error(errno, system_category(),
+                       "Unable to create temporary file");
+  }
+  close(descriptor);
+  auto rewrite = [&path, &content]() {
+    ofstream output{path, std::ios::trunc};
+    output << content;
+  };
+  rewrite();
+
+  Key parent{"user", KEY_END};
+  Options options;
+  KeySet keys;
+  addToKeySet(keys, parent, path, options);
+  string name = keys.size() > 0 ? keys.at(0).getName() : "user";
+
+  mutex lock;
+  auto locked = latencies(
+      readers, reloads,
+      [&lock, &keys, &name]() {
+        lock_guard<mutex> guard{lock};
+        keys.lookup(name);
+      },
+      [&]() {
+        rewrite();
+        lock_guard<mutex> guard{lock};
+        keys.clear();
+        addToKeySet(keys, parent, path, options);
+      });
+  printLatencies("lock", readers, locked);
+
+  try {
+    yaypeg::Watcher watcher{parent, {path}, options};
+    auto watched = latencies(
+        readers, reloads,
+        [&watcher, &name]() { watcher.snapshot().lookup(name); },
+        [&watcher, &rewrite]() {
+          uint64_t version = watcher.version();
+          uint64_t failures = watcher.failures();
+          rewrite();
+          auto start = steady_clock::now();
+          while (watcher.version() == version &&
+                 watcher.failures() == failures) {
+            if (steady_clock::now() - start > std::chrono::seconds{5}) {
+              throw std::runtime_error("The watcher did not reload the file");
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds{100});
+          }
+        });
+    printLatencies("watcher", readers, watched);
+  } catch (...) {
+    unlink(path);
+    throw;
+  }
+  unlink(path);
+}
+#endif
+
+/**
+ * @brief This function parses a positive number.
+ *
+ * @param text This text stores the number.
+ * @param number The function stores the number in this variable.
+ *
+ * @retval true If `text` contains a positive number
+ * @retval false Otherwise
+ */
+bool parseCount(char const *text, size_t &number) {
+  number = std::strtoull(text, nullptr, 10);
+  return number > 0;
+}
+
+} // namespace
+
+// -- Main ---------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+  string tool = argv[0];
+  string usage =
+      "Usage: " + tool + " [--iterations count] filename…\n       " + tool +
+      " [--generate count] [--readers count] --directory path\n       " +
+      tool + " [--iterations count] [--readers count] --watch filename";
+
+  size_t iterations = defaultIterations;
+  size_t files = 0;
+  size_t readers = yaypeg::defaultReaders;
+  string directory;
+  string watched;
+  int argument = 1;
+  for (; argument < argc && strncmp(argv[argument], "--", 2) == 0;
+       argument += 2) {
+    string option = argv[argument];
+    bool valid = argument + 1 < argc;
+    if (valid && option == "--iterations") {
+      valid = parseCount(argv[argument + 1], iterations);
+    } else if (valid && option == "--generate") {
+      valid = parseCount(argv[argument + 1], files);
+    } else if (valid && option == "--readers") {
+      valid = parseCount(argv[argument + 1], readers);
+    } else if (valid && option == "--directory") {
+      directory = argv[argument + 1];
+    } else if (valid && option == "--watch") {
+      watched = argv[argument + 1];
+    } else {
+      valid = false;
+    }
+    if (!valid) {
+      cerr << usage << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!watched.empty()) {
+    if (argument < argc) {
+      cerr << usage << endl;
+      return EXIT_FAILURE;
+    }
+#if defined(__linux__)
+    try {
+      benchmarkReload(watched, readers, iterations);
+    } catch (exception const &error) {
+      cerr << error.what() << endl;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+#else
+    cerr << "The watch mode requires inotify, which only Linux provides"
+         << endl;
+    return EXIT_FAILURE;
+#endif
+  }
+  if (!directory.empty()) {
+    if (argument < argc) {
+      cerr << usage << endl;
+      return EXIT_FAILURE;
+    }
+    try {
+      if (files > 0) {
+        generate(directory, files);
+      }
+      benchmarkDirectory(directory, readers);
+    } catch (system_error const &error) {
+      cerr << error.what() << endl;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+  if (argument >= argc) {
+    cerr << usage << endl;
+    return EXIT_FAILURE;
+  }
+
+  int status = EXIT_SUCCESS;
+  for (; argument < argc; argument++) {
+    try {
+      benchmark(argv[argument], iterations);
+    } catch (system_error const &error) {
+      cerr << "Unable to open input: " << error.what() << endl;
+      status = EXIT_FAILURE;
+    } catch (exception const &error) {
+      cerr << argv[argument] << ": " << error.what() << endl;
+      status = EXIT_FAILURE;
+    }
+  }
+  return status;
+}
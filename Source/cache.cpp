@@ -0,0 +1,131 @@
+/**
+ * @file
+ *
+ * @brief This file contains the implementation of a cache for converted YAML
+ *        files.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <system_error>
+
+#include "cache.hpp"
+#include "convert.hpp"
+#include "hash.hpp"
+
+using kdb::Key;
+using kdb::KeySet;
+using std::string;
+using std::system_error;
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief This function creates a deep copy of the given key set.
+ *
+ * Keys in Elektra are reference counted. If we return the same keys that we
+ * store in the cache, then changes of the caller would also change the cache.
+ * We therefore duplicate every key, which is still much cheaper than parsing
+ * the file again.
+ *
+ * @param keys This argument specifies the key set this function copies.
+ *
+ * @return A copy of `keys`
+ */
+KeySet duplicate(KeySet const &keys) {
+  KeySet copy;
+  for (auto key : keys) {
+    copy.append(Key{key.dup()});
+  }
+  return copy;
+}
+
+} // namespace
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This method converts the given YAML file to a key set.
+ *
+ * @param parent This key specifies the parent of all keys the method
+ *               creates.
+ * @param filename This parameter stores the path of the YAML file this
+ *                 method converts.
+ *
+ * @throws std::system_error if the method is unable to read `filename`
+ * @throws parse_error if the file does not contain (supported) YAML data
+ *
+ * @return A key set containing the data stored in `filename`, or an empty
+ *         key set if `filename` does not exist. The caller is free to modify
+ *         the returned key set and its keys.
+ */
+KeySet Cache::get(Key const &parent, string const &filename) {
+  FileStatus status;
+  try {
+    status = fileStatus(filename);
+  } catch (system_error const &error) {
+    // The mount point of a new configuration refers to a file the first
+    // `kdbSet` creates
+    if (error.code() == std::errc::no_such_file_or_directory) {
+      entries.erase(filename);
+      return KeySet{};
+    }
+    throw;
+  }
+  string parentName = parent.getName();
+
+  auto entry = entries.find(filename);
+  bool known = entry != entries.end() && entry->second.parent == parentName;
+
+  // If size and modification time did not change, and the file was last
+  // modified in an earlier second than the one we read it in, then any later
+  // write would have updated the modification time. In this case we do not
+  // need to read the file at all. This is the same approach Git uses to
+  // detect “racily clean” files.
+  if (known && entry->second.status == status &&
+      status.seconds < entry->second.read) {
+    return duplicate(entry->second.keys);
+  }
+
+  time_t read = time(nullptr);
+  string content = readFile(filename);
+  uint64_t checksum = hash(content.data(), content.size());
+
+  if (known && entry->second.hash == checksum &&
+      entry->second.status.size == content.size()) {
+    entry->second.status = status;
+    entry->second.read = read;
+    return duplicate(entry->second.keys);
+  }
+
+  KeySet keys = convertBuffer(parent, content.data(), content.size(), filename);
+
+  Entry &update = entries[filename];
+  update.parent = parentName;
+  update.status = status;
+  update.hash = checksum;
+  update.read = read;
+  update.keys = keys;
+
+  return duplicate(keys);
+}
+
+/**
+ * @brief This method removes all entries from the cache.
+ */
+void Cache::clear() { entries.clear(); }
+
+/**
+ * @brief This method returns the number of files stored in the cache.
+ *
+ * @return The number of cache entries
+ */
+size_t Cache::size() const { return entries.size(); }
+
+} // namespace yaypeg
@@ -0,0 +1,91 @@
+/**
+ * @file
+ *
+ * @brief This file contains the declaration of a cache for converted YAML
+ *        files.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_CACHE_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_CACHE_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <ctime>
+#include <string>
+#include <unordered_map>
+
+#include <kdb.hpp>
+
+#include "file.hpp"
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This class stores the key sets of already converted YAML files.
+ *
+ * The cache identifies a file by its path, size, modification time and the
+ * hash of its content. If a file did not change since the last conversion,
+ * then the cache returns a copy of the stored key set instead of parsing the
+ * file again.
+ */
+class Cache {
+
+  /**
+   * @brief This struct stores the data of a single converted file.
+   */
+  struct Entry {
+    /** @brief This variable stores the name of the parent key of `keys`. */
+    std::string parent;
+    /** @brief This variable stores size and modification time of the file. */
+    FileStatus status;
+    /** @brief This variable stores the hash value of the file content. */
+    uint64_t hash = 0;
+    /** @brief This variable stores the (wall clock) time the cache read the
+     *         file. */
+    time_t read = 0;
+    /** @brief This key set stores the converted data of the file. */
+    kdb::KeySet keys;
+  };
+
+  /** @brief This map stores the cache entries using the path of the file as
+   *         key. */
+  std::unordered_map<std::string, Entry> entries;
+
+public:
+  /**
+   * @brief This method converts the given YAML file to a key set.
+   *
+   * @param parent This key specifies the parent of all keys the method
+   *               creates.
+   * @param filename This parameter stores the path of the YAML file this
+   *                 method converts.
+   *
+   * @throws std::system_error if the method is unable to read `filename`
+   * @throws parse_error if the file does not contain (supported) YAML data
+   *
+   * @return A key set containing the data stored in `filename`, or an empty
+   *         key set if `filename` does not exist. The caller is free to
+   *         modify the returned key set and its keys.
+   */
+  kdb::KeySet get(kdb::Key const &parent, std::string const &filename);
+
+  /**
+   * @brief This method removes all entries from the cache.
+   */
+  void clear();
+
+  /**
+   * @brief This method returns the number of files stored in the cache.
+   *
+   * @return The number of cache entries
+   */
+  size_t size() const;
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_CACHE_HPP
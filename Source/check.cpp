@@ -0,0 +1,166 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions that check if YAML data is valid
+ *        without converting it.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <memory>
+
+#include "check.hpp"
+#include "control.hpp"
+#include "encoding.hpp"
+#include "parser.hpp"
+#include "state.hpp"
+#include "structure.hpp"
+
+#define TAO_PEGTL_NAMESPACE yaypeg
+
+#include <tao/pegtl.hpp>
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using std::string;
+
+using tao::TAO_PEGTL_NAMESPACE::memory_input;
+using tao::TAO_PEGTL_NAMESPACE::tracking_mode;
+
+using yaypeg::detectEncoding;
+using yaypeg::Encoding;
+using yaypeg::Options;
+using yaypeg::State;
+using yaypeg::StructuralIndex;
+
+/**
+ * @brief This function matches the given UTF-8 input against the grammar.
+ *
+ * @param input This variable stores the YAML input the function checks.
+ * @param options This argument specifies options for the recognizer.
+ *
+ * @throws parse_error if the input does not contain (supported) YAML data
+ * @throws limit_error if the recognizer exceeded one of the limits
+ */
+template <typename Input> void recognize(Input &input, Options const &options) {
+  using tao::TAO_PEGTL_NAMESPACE::parse;
+  using yaypeg::action;
+  using yaypeg::limited;
+  using yaypeg::yaml;
+
+  State state;
+  state.limits = options.limits;
+  state.logger = options.logger.get();
+
+  std::unique_ptr<StructuralIndex> structure;
+  if (options.structuralIndex) {
+    structure = std::make_unique<StructuralIndex>(input.begin(), input.size());
+    state.structure = structure.get();
+  }
+
+  auto report = [&state, &options]() {
+    if (uint64_t *invocations = options.invocations) {
+      *invocations = state.invocations;
+    }
+  };
+  try {
+    // Without the parse tree control and selector, the parser only stores
+    // its context and indentation stacks. The grammar rule `yaml` raises an
+    // exception, if the input does not match.
+    parse<yaml, action, limited>(input, state);
+    report();
+  } catch (...) {
+    report();
+    throw;
+  }
+}
+
+/**
+ * @brief This function checks the given YAML input.
+ *
+ * @param input This variable stores the YAML input the function checks.
+ * @param options This argument specifies options for the recognizer.
+ *
+ * @throws parse_error if the input does not contain (supported) YAML data
+ * @throws limit_error if the recognizer exceeded one of the limits
+ */
+template <typename Input> void check(Input &input, Options const &options) {
+  Encoding encoding = detectEncoding(input.begin(), input.size());
+  if (encoding != Encoding::UTF_8) {
+    string text =
+        yaypeg::toUtf8(input.begin(), input.size(), encoding, input.source());
+    memory_input<tracking_mode::LAZY> transcoded{text.data(), text.size(),
+                                                 input.source()};
+    recognize(transcoded, options);
+    return;
+  }
+  recognize(input, options);
+}
+
+} // namespace
+
+namespace yaypeg {
+
+/**
+ * @brief This function returns the default options of the recognizer.
+ *
+ * The structural index needs about half a byte for every byte of the input.
+ * The default options therefore disable it, so that the recognizer only needs
+ * its stacks besides the input.
+ *
+ * @return Default options without structural index
+ */
+Options checkOptions() {
+  Options options;
+  options.structuralIndex = false;
+  return options;
+}
+
+/**
+ * @brief This function checks if the given YAML file matches the grammar.
+ *
+ * The function maps the file into memory and only runs the recognizer. It
+ * does not create a parse tree, a listener or keys. Since the function does
+ * not resolve aliases, it does not report aliases that refer to unknown
+ * anchors.
+ *
+ * @param filename This parameter stores the path of the YAML file.
+ * @param options This argument specifies the limits, the logger and if the
+ *                recognizer uses the structural index.
+ *
+ * @throws input_error if the function is unable to read `filename`
+ * @throws parse_error if the file does not contain (supported) YAML data
+ * @throws limit_error if the recognizer exceeded one of the limits
+ */
+void checkFile(string const &filename, Options const &options) {
+  using tao::TAO_PEGTL_NAMESPACE::file_input;
+
+  file_input<tracking_mode::LAZY> input{filename};
+  check(input, options);
+}
+
+/**
+ * @brief This function checks if the YAML data stored in the given buffer
+ *        matches the grammar.
+ *
+ * @param data This variable stores the start of the YAML data.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param source This text describes the origin of `data`. The function uses
+ *               it in error messages.
+ * @param options This argument specifies the limits, the logger and if the
+ *                recognizer uses the structural index.
+ *
+ * @throws parse_error if the buffer does not contain (supported) YAML data
+ * @throws limit_error if the recognizer exceeded one of the limits
+ */
+void checkBuffer(char const *data, size_t size, string const &source,
+                 Options const &options) {
+  memory_input<tracking_mode::LAZY> input{data, size, source};
+  check(input, options);
+}
+
+} // namespace yaypeg
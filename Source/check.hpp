@@ -0,0 +1,72 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions that check if YAML data is valid
+ *        without converting it.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_CHECK_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_CHECK_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <string>
+
+#include "options.hpp"
+
+// -- Functions ----------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This function returns the default options of the recognizer.
+ *
+ * The structural index needs about half a byte for every byte of the input.
+ * The default options therefore disable it, so that the recognizer only
+ * needs its stacks besides the input.
+ *
+ * @return Default options without structural index
+ */
+Options checkOptions();
+
+/**
+ * @brief This function checks if the given YAML file matches the grammar.
+ *
+ * The function maps the file into memory and only runs the recognizer. It
+ * does not create a parse tree, a listener or keys. Since the function does
+ * not resolve aliases, it does not report aliases that refer to unknown
+ * anchors.
+ *
+ * @param filename This parameter stores the path of the YAML file.
+ * @param options This argument specifies the limits, the logger and if the
+ *                recognizer uses the structural index.
+ *
+ * @throws input_error if the function is unable to read `filename`
+ * @throws parse_error if the file does not contain (supported) YAML data
+ * @throws limit_error if the recognizer exceeded one of the limits
+ */
+void checkFile(std::string const &filename,
+               Options const &options = checkOptions());
+
+/**
+ * @brief This function checks if the YAML data stored in the given buffer
+ *        matches the grammar.
+ *
+ * @param data This variable stores the start of the YAML data.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param source This text describes the origin of `data`. The function uses
+ *               it in error messages.
+ * @param options This argument specifies the limits, the logger and if the
+ *                recognizer uses the structural index.
+ *
+ * @throws parse_error if the buffer does not contain (supported) YAML data
+ * @throws limit_error if the recognizer exceeded one of the limits
+ */
+void checkBuffer(char const *data, size_t size, std::string const &source,
+                 Options const &options = checkOptions());
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_CHECK_HPP
@@ -0,0 +1,361 @@
+/**
+ * @file
+ *
+ * @brief This file contains a tool that detects input for which the parser
+ *        needs more than linear time.
+ *
+ * The tool grows known problematic input patterns and reports patterns where
+ * the number of invoked grammar rules or the run time grows faster than the
+ * size of the input. If the user specifies files, then the tool checks that
+ * the parser converts each file within a linear rule invocation budget.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#define TAO_PEGTL_NAMESPACE yaypeg
+
+#include <tao/pegtl.hpp>
+
+#include <kdb.hpp>
+
+#include "convert.hpp"
+#include "file.hpp"
+#include "limits.hpp"
+#include "memory.hpp"
+#include "options.hpp"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::function;
+using std::string;
+using std::system_error;
+using std::vector;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+using tao::TAO_PEGTL_NAMESPACE::parse_error;
+
+using kdb::Key;
+
+using yaypeg::convertBuffer;
+using yaypeg::limit_error;
+using yaypeg::MappedFile;
+using yaypeg::MemoryUsage;
+using yaypeg::Options;
+
+// -- Types --------------------------------------------------------------------
+
+namespace {
+
+/** @brief This struct stores the cost of a single conversion. */
+struct Measurement {
+  /** @brief This number stores the length of the input in bytes. */
+  size_t bytes;
+  /** @brief This number stores how often the parser invoked grammar rules. */
+  uint64_t invocations;
+  /** @brief This number stores the run time of the conversion in seconds. */
+  double seconds;
+  /** @brief This variable specifies if the input contained valid YAML. */
+  bool valid;
+  /** @brief This number stores the peak memory usage of the conversion per
+   *         byte of input. */
+  double memory;
+};
+
+/** @brief This struct describes an input pattern that grows with `n`. */
+struct Pattern {
+  /** @brief This text stores the name of the pattern. */
+  char const *name;
+  /** @brief This number specifies the largest `n` the tool checks. Nested
+   *         patterns use smaller values to stay within the stack size. */
+  size_t maximum;
+  /** @brief This function returns the input for a given `n`. */
+  function<string(size_t)> generate;
+};
+
+// -- Constants ----------------------------------------------------------------
+
+/** @brief This constant specifies the default linear invocation budget. */
+constexpr uint64_t defaultBudget = 1000;
+
+/**
+ * @brief This constant specifies how much slower (per byte) a large input may
+ *        be compared to the smallest measured input of the same pattern.
+ */
+constexpr double slack = 4;
+
+/**
+ * @brief This constant specifies the minimum run time of a measurement the
+ *        tool uses as base for time comparisons. Shorter run times are too
+ *        noisy.
+ */
+constexpr double minimumSeconds = 0.001;
+
+// -- Functions ----------------------------------------------------------------
+
+/**
+ * @brief This function returns `count` copies of the given text.
+ *
+ * @param text This argument stores the text the function repeats.
+ * @param count This number specifies how often the function repeats `text`.
+ *
+ * @return The concatenation of `count` copies of `text`
+ */
+string repeat(string const &text, size_t count) {
+  string result;
+  result.reserve(text.size() * count);
+  for (size_t copy = 0; copy < count; copy++) {
+    result += text;
+  }
+  return result;
+}
+
+/**
+ * @brief This function returns the input patterns the tool checks.
+ *
+ * @return A list of input patterns that caused super linear behavior in the
+ *         past
+ */
+vector<Pattern> patterns() {
+  // Keys just below the limit of `ns_s_implicit_yaml_key`
+  string const longKey(1020, 'k');
+
+  return {
+      {"Sequence Chain", 512,
+       [](size_t n) { return repeat("- ", n) + "scalar\n"; }},
+      {"Sequence Chain (Lines)", 256,
+       [](size_t n) {
+         string input;
+         for (size_t level = 0; level < n; level++) {
+           input += string(2 * level, ' ') + "-\n";
+         }
+         return input + string(2 * n, ' ') + "scalar\n";
+       }},
+      {"Long Implicit Keys", 256,
+       [longKey](size_t n) {
+         string input;
+         for (size_t entry = 0; entry < n; entry++) {
+           input += longKey + ":\n  " + longKey + ": value\n";
+         }
+         return input;
+       }},
+      {"Nested Implicit Keys", 64,
+       [longKey](size_t n) {
+         string input;
+         for (size_t level = 0; level < n; level++) {
+           input += string(2 * level, ' ') + longKey + ":\n";
+         }
+         return input + string(2 * n, ' ') + "value\n";
+       }},
+      {"Comment Storm", 4096,
+       [](size_t n) {
+         return repeat("# comment\n   # comment   \n\n", n) + "key: value\n" +
+                repeat("# comment # comment\n  \t\n", n);
+       }},
+      {"Billion Laughs", 64,
+       [](size_t n) {
+         string input = "level0: &level0 lol\n";
+         for (size_t level = 1; level <= n; level++) {
+           string name = "level" + std::to_string(level);
+           input += name + ": &" + name + "\n" +
+                    repeat("  - *level" + std::to_string(level - 1) + "\n", 9);
+         }
+         return input;
+       }},
+      {"Block Scalar", 4096,
+       [](size_t n) {
+         return "literal: |\n" + repeat("  line\n\n", n) + "folded: >\n" +
+                repeat("  line\n   more\n", n);
+       }},
+      {"Trailing Comments", 4096,
+       [](size_t n) {
+         string input;
+         for (size_t entry = 0; entry < n; entry++) {
+           input += "key" + std::to_string(entry) + ": value # comment\n";
+         }
+         return input;
+       }},
+  };
+}
+
+/**
+ * @brief This function converts the given input and measures the cost of the
+ *        conversion.
+ *
+ * @param input This argument stores the YAML input.
+ * @param source This text describes the origin of `input`.
+ * @param budget This number specifies how many rule invocations per byte the
+ *               parser may use.
+ *
+ * @return The cost of the conversion
+ */
+Measurement measure(string const &input, string const &source,
+                    uint64_t budget) {
+  uint64_t invocations = 0;
+  MemoryUsage memory;
+  Options options;
+  options.invocations = &invocations;
+  options.memory = &memory;
+  options.limits.maximumRuleInvocations = budget * (input.size() + 1);
+
+  Key parent{"user", KEY_END};
+  bool valid = true;
+  auto start = steady_clock::now();
+  try {
+    convertBuffer(parent, input.data(), input.size(), source, options);
+  } catch (parse_error const &) {
+    valid = false;
+  } catch (limit_error const &) {
+    valid = false;
+  }
+  duration<double> seconds = steady_clock::now() - start;
+
+  return Measurement{input.size(), invocations, seconds.count(), valid,
+                     valid ? memory.bytesPerInputByte() : 0};
+}
+
+/**
+ * @brief This function prints the given measurement.
+ *
+ * @param name This text describes the input of the measurement.
+ * @param measurement This argument stores the measurement the function
+ *                    prints.
+ * @param problem This text describes the problem of the measurement or is
+ *                empty, if the measurement is within budget.
+ */
+void print(string const &name, Measurement const &measurement,
+           string const &problem) {
+  char line[192];
+  snprintf(line, sizeof(line),
+           "%-24s %9zu B %12llu R %8.1f R/B %10.3f ms %8.1f M/B %s",
+           name.c_str(), measurement.bytes,
+           static_cast<unsigned long long>(measurement.invocations),
+           static_cast<double>(measurement.invocations) /
+               static_cast<double>(measurement.bytes + 1),
+           measurement.seconds * 1000, measurement.memory,
+           measurement.valid ? "" : "(invalid)");
+  cout << line << (problem.empty() ? "" : " — " + problem) << endl;
+}
+
+/**
+ * @brief This function grows the given pattern and checks that the cost of
+ *        the conversion grows linearly.
+ *
+ * @param pattern This argument stores the pattern the function checks.
+ * @param budget This number specifies how many rule invocations per byte the
+ *               parser may use.
+ *
+ * @retval true If the cost of the conversion grows linearly
+ * @retval false Otherwise
+ */
+bool check(Pattern const &pattern, uint64_t budget) {
+  bool linear = true;
+  double baseInvocations = 0;
+  double baseSeconds = 0;
+
+  for (size_t n = 1; n <= pattern.maximum; n *= 2) {
+    Measurement result = measure(pattern.generate(n), pattern.name, budget);
+    double bytes = static_cast<double>(result.bytes + 1);
+    double invocations = static_cast<double>(result.invocations) / bytes;
+    double seconds = result.seconds / bytes;
+
+    string problem;
+    if (result.invocations >= budget * (result.bytes + 1)) {
+      problem = "rule invocation budget exceeded";
+    } else if (baseInvocations > 0 && invocations > slack * baseInvocations) {
+      problem = "rule invocations grow faster than input";
+    } else if (baseSeconds > 0 && seconds > slack * baseSeconds) {
+      problem = "run time grows faster than input";
+    }
+
+    if (baseInvocations == 0) {
+      baseInvocations = invocations;
+    }
+    if (baseSeconds == 0 && result.seconds >= minimumSeconds) {
+      baseSeconds = seconds;
+    }
+
+    print(string{pattern.name} + " (n = " + std::to_string(n) + ")", result,
+          problem);
+    if (!problem.empty()) {
+      linear = false;
+      // Larger inputs would only take even longer.
+      break;
+    }
+  }
+  return linear;
+}
+
+/**
+ * @brief This function checks that the parser converts the given file within
+ *        the rule invocation budget.
+ *
+ * @param filename This text stores the path of the file.
+ * @param budget This number specifies how many rule invocations per byte the
+ *               parser may use.
+ *
+ * @retval true If the parser converted the file within budget
+ * @retval false Otherwise
+ */
+bool check(string const &filename, uint64_t budget) {
+  MappedFile file{filename};
+  string input{file.data(), file.size()};
+  Measurement result = measure(input, filename, budget);
+  string problem = result.invocations >= budget * (result.bytes + 1)
+                       ? "rule invocation budget exceeded"
+                       : "";
+  print(filename, result, problem);
+  return problem.empty();
+}
+
+} // namespace
+
+// -- Main ---------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+  string usage =
+      string{"Usage: "} + argv[0] + " [--budget invocations] [filename…]";
+
+  uint64_t budget = defaultBudget;
+  int argument = 1;
+  if (argument < argc && strcmp(argv[argument], "--budget") == 0) {
+    if (argument + 1 >= argc ||
+        (budget = std::strtoull(argv[argument + 1], nullptr, 10)) == 0) {
+      cerr << usage << endl;
+      return EXIT_FAILURE;
+    }
+    argument += 2;
+  }
+
+  bool linear = true;
+  if (argument >= argc) {
+    for (auto const &pattern : patterns()) {
+      linear = check(pattern, budget) && linear;
+    }
+    return linear ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  for (; argument < argc; argument++) {
+    try {
+      linear = check(argv[argument], budget) && linear;
+    } catch (system_error const &error) {
+      cerr << "Unable to open input: " << error.what() << endl;
+      linear = false;
+    }
+  }
+  return linear ? EXIT_SUCCESS : EXIT_FAILURE;
+}
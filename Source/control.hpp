@@ -0,0 +1,160 @@
+/**
+ * @file
+ *
+ * @brief This file contains a control class that enforces resource limits.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_CONTROL_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_CONTROL_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <chrono>
+#include <string>
+#include <type_traits>
+
+#include "limits.hpp"
+#include "lines.hpp"
+#include "parser.hpp"
+#include "state.hpp"
+
+// -- Functions ----------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This constant specifies if a grammar rule matches a collection.
+ */
+template <typename Rule>
+constexpr bool isCollection =
+    std::is_same<Rule, l_plus_block_sequence>::value ||
+    std::is_same<Rule, l_plus_block_mapping>::value;
+
+/**
+ * @brief This function returns the current position of the given input.
+ *
+ * The parser does not track lines and columns while it reads the input. The
+ * function therefore calculates the position with a line index.
+ *
+ * @param input This variable stores the current state of the parser input.
+ *
+ * @return The position of the current character of `input`
+ */
+template <typename Input>
+tao::TAO_PEGTL_NAMESPACE::position locate(Input const &input) {
+  return LineIndex{input.begin(), input.source()}.locate(input.current());
+}
+
+/**
+ * @brief This function throws a limit error for the current input position.
+ *
+ * @param input This variable stores the current state of the parser input.
+ * @param problem This text describes the exceeded limit.
+ *
+ * @throws limit_error in any case
+ */
+template <typename Input>
+[[noreturn]] void exceeded(Input const &input, std::string const &problem) {
+  throw limit_error(to_string(locate(input)) + ": " + problem);
+}
+
+/**
+ * @brief This function updates the counters of the parser state before the
+ *        parser tries to match `Rule`.
+ *
+ * @param input This variable stores the current state of the parser input.
+ * @param state This variable stores the counters and limits of the parser.
+ *
+ * @throws limit_error if the parser exceeded a limit
+ */
+template <typename Rule, typename Input>
+void enter(Input const &input, State &state) {
+  using std::to_string;
+  using std::chrono::steady_clock;
+
+  if (++state.invocations > state.limits.maximumRuleInvocations) {
+    exceeded(input, "Maximum number of rule invocations (" +
+                        to_string(state.limits.maximumRuleInvocations) +
+                        ") exceeded");
+  }
+
+  // Reading the clock is much more expensive than matching a rule. We
+  // therefore only check the time budget every few thousand invocations.
+  if ((state.invocations & 0xfff) == 0) {
+    if (steady_clock::now() > state.limits.deadline) {
+      exceeded(input, "Time budget exceeded");
+    }
+    if (state.limits.cancelled && state.limits.cancelled()) {
+      exceeded(input, "Conversion cancelled");
+    }
+  }
+
+  if constexpr (isCollection<Rule>) {
+    if (++state.depth > state.limits.maximumDepth) {
+      exceeded(input, "Maximum nesting depth (" +
+                          to_string(state.limits.maximumDepth) +
+                          ") exceeded");
+    }
+  }
+}
+
+/**
+ * @brief This function ignores states that do not store limits.
+ */
+template <typename Rule, typename Input, typename Other>
+void enter(Input const &, Other const &) {}
+
+/**
+ * @brief This function updates the counters of the parser state after the
+ *        parser tried to match `Rule`.
+ *
+ * @param state This variable stores the counters of the parser.
+ */
+template <typename Rule> void leave(State &state) {
+  if constexpr (isCollection<Rule>) {
+    state.depth--;
+  }
+}
+
+/**
+ * @brief This function ignores states that do not store limits.
+ */
+template <typename Rule, typename Other> void leave(Other const &) {}
+
+/**
+ * @brief This control class enforces the limits stored in the parser state.
+ *
+ * Please use the control class `tracer` instead of this class for detailed
+ * debugging information.
+ */
+template <typename Rule>
+struct limited : tao::TAO_PEGTL_NAMESPACE::normal<Rule> {
+  template <typename Input, typename... States>
+  static void start(Input const &input, States &&... states) {
+    (enter<Rule>(input, states), ...);
+  }
+
+  template <typename Input, typename... States>
+  static void success(Input const &, States &&... states) {
+    (leave<Rule>(states), ...);
+  }
+
+  template <typename Input, typename... States>
+  static void failure(Input const &, States &&... states) {
+    (leave<Rule>(states), ...);
+  }
+
+  template <typename Input, typename... States>
+  [[noreturn]] static void raise(Input const &input, States &&...) {
+    throw tao::TAO_PEGTL_NAMESPACE::parse_error(
+        "parse error matching " +
+            tao::TAO_PEGTL_NAMESPACE::internal::demangle<Rule>(),
+        locate(input));
+  }
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_CONTROL_HPP
@@ -8,16 +8,204 @@
 
 // -- Imports ------------------------------------------------------------------
 
+#include "control.hpp"
 #include "convert.hpp"
+#include "encoding.hpp"
+#include "json.hpp"
+#include "lines.hpp"
 #include "listener.hpp"
+#include "memory.hpp"
 #include "parser.hpp"
 #include "state.hpp"
+#include "structure.hpp"
 #include "walk.hpp"
 
 #define TAO_PEGTL_NAMESPACE yaypeg
 
 #include <tao/pegtl/contrib/parse_tree.hpp>
 
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using kdb::Key;
+using kdb::KeySet;
+
+using tao::TAO_PEGTL_NAMESPACE::parse_tree::node;
+
+using yaypeg::detectEncoding;
+using yaypeg::Encoding;
+using yaypeg::LineIndex;
+using yaypeg::Listener;
+using yaypeg::looksLikeJson;
+using yaypeg::MemoryUsage;
+using yaypeg::Options;
+using yaypeg::parseJson;
+using yaypeg::State;
+using yaypeg::StructuralIndex;
+
+/**
+ * @brief This function returns the memory usage of a parse tree.
+ *
+ * @param tree This argument stores the root of the tree.
+ *
+ * @return The size of all nodes, child lists and (not inlined) source
+ *         strings of `tree` in bytes
+ */
+size_t treeBytes(node const &tree) {
+  size_t bytes = sizeof(node) +
+                 tree.children.capacity() * sizeof(std::unique_ptr<node>);
+  // Short strings store their characters inside the string object
+  auto object = reinterpret_cast<char const *>(&tree.source);
+  if (tree.source.data() < object ||
+      tree.source.data() >= object + sizeof(tree.source)) {
+    bytes += tree.source.capacity() + 1;
+  }
+  for (auto const &child : tree.children) {
+    bytes += treeBytes(*child);
+  }
+  return bytes;
+}
+
+/**
+ * @brief This function stores the memory usage of the listener.
+ *
+ * @param listener This argument stores the listener of a finished
+ *                 conversion.
+ * @param usage The function stores the memory usage in this variable.
+ */
+void measureListener(Listener const &listener, MemoryUsage &usage) {
+  usage.listenerPeakBytes = listener.getMemory().peak;
+  usage.keySetBytes = yaypeg::keySetBytes(listener.getKeySet());
+}
+
+/**
+ * @brief This function converts the given YAML input calling the methods of
+ *        the given listener.
+ *
+ * @param listener The function calls the methods of this listener.
+ * @param input This variable stores the YAML input the function converts.
+ */
+template <typename Input> void convert(Listener &listener, Input &input) {
+  using tao::TAO_PEGTL_NAMESPACE::parse_tree::parse;
+  using yaypeg::action;
+  using yaypeg::limited;
+  using yaypeg::selector;
+  using yaypeg::yaml;
+
+  MemoryUsage *usage = listener.getOptions().memory;
+  if (usage) {
+    *usage = MemoryUsage{};
+    usage->inputBytes = input.size();
+  }
+
+  // Machine written JSON is much faster to convert with the dedicated JSON
+  // parser. If the input is not valid JSON we discard the partial result and
+  // fall back to the YAML grammar.
+  if (looksLikeJson(input.begin(), input.size())) {
+    if (parseJson(input.begin(), input.size(), listener)) {
+      if (usage) {
+        measureListener(listener, *usage);
+      }
+      return;
+    }
+    listener.reset();
+  }
+
+#ifndef NDEBUG
+  using std::cerr;
+  using std::endl;
+  using std::runtime_error;
+  using tao::TAO_PEGTL_NAMESPACE::analyze;
+
+  // Check grammar for problematic code
+  cerr << "— Analyzer ————\n" << endl;
+  if (analyze<yaml>() != 0) {
+    throw runtime_error("PEGTLs analyze function found problems while "
+                        "checking the top level grammar rule `yaml`!");
+  }
+
+  cerr << "— Recognizer ————\n" << endl;
+#endif
+
+  // Every conversion uses its own state and logger. This way multiple
+  // threads can convert documents at the same time.
+  State state;
+  state.limits = listener.getOptions().limits;
+  state.logger = listener.getOptions().logger.get();
+
+  // Stage 1: Classify all characters of the input at once, so the grammar
+  // rules do not need to read indentation and comments character by
+  // character.
+  std::unique_ptr<StructuralIndex> structure;
+  if (listener.getOptions().structuralIndex) {
+    structure = std::make_unique<StructuralIndex>(input.begin(), input.size());
+    state.structure = structure.get();
+  }
+
+  // Pathological input is often invalid. We therefore also report the number
+  // of rule invocations if the parser fails.
+  auto report = [&state, &listener]() {
+    if (uint64_t *invocations = listener.getOptions().invocations) {
+      *invocations = state.invocations;
+    }
+  };
+  try {
+    /* For detailed debugging information, please use the control class
+     * `tracer` instead of `limited`. */
+    auto root = parse<yaml, selector, action, limited>(input, state);
+    report();
+    // The walker does not need the index anymore
+    size_t indexBytes = structure ? structure->bytes() : 0;
+    structure.reset();
+    state.structure = nullptr;
+    listener.setBlockIndentation(std::move(state.blockIndentation));
+    yaypeg::walk(listener, *root, LineIndex{input.begin(), input.source()});
+    if (usage) {
+      usage->parserPeakBytes = state.memory.peak;
+      usage->indexBytes = indexBytes;
+      usage->treeBytes = treeBytes(*root);
+      measureListener(listener, *usage);
+    }
+  } catch (...) {
+    report();
+    throw;
+  }
+}
+
+/**
+ * @brief This function converts the given YAML input to a key set.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param input This variable stores the YAML input the function converts.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @return A key set containing the data stored in `input`
+ */
+template <typename Input>
+KeySet convert(Key const &parent, Input &input, Options const &options) {
+  using tao::TAO_PEGTL_NAMESPACE::memory_input;
+  using tao::TAO_PEGTL_NAMESPACE::tracking_mode;
+
+  Listener listener{parent, options};
+  // The grammar only matches UTF-8. We therefore convert UTF-16 and UTF-32
+  // input before we parse it.
+  Encoding encoding = detectEncoding(input.begin(), input.size());
+  if (encoding != Encoding::UTF_8) {
+    std::string text =
+        yaypeg::toUtf8(input.begin(), input.size(), encoding, input.source());
+    memory_input<tracking_mode::LAZY> transcoded{text.data(), text.size(),
+                                                 input.source()};
+    convert(listener, transcoded);
+    return listener.getKeySet();
+  }
+  convert(listener, input);
+  return listener.getKeySet();
+}
+
+} // namespace
+
 namespace yaypeg {
 
 using kdb::Key;
@@ -26,6 +214,79 @@ using std::string;
 
 // -- Function -----------------------------------------------------------------
 
+/**
+ * @brief This function converts the given YAML file to a key set.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param filename This parameter stores the path of the YAML file this
+ *                 function converts.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @throws input_error if the function is unable to read `filename`
+ * @throws parse_error if the file does not contain (supported) YAML data
+ *
+ * @return A key set containing the data stored in `filename`
+ */
+KeySet convertFile(Key const &parent, string const &filename,
+                   Options const &options) {
+  using tao::TAO_PEGTL_NAMESPACE::file_input;
+  using tao::TAO_PEGTL_NAMESPACE::tracking_mode;
+
+  file_input<tracking_mode::LAZY> input{filename};
+  return convert(parent, input, options);
+}
+
+/**
+ * @brief This function converts the YAML data stored in the given buffer to a
+ *        key set.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param data This variable stores the start of the YAML data.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param source This text describes the origin of `data`. The function uses
+ *               it in error messages.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @throws parse_error if the buffer does not contain (supported) YAML data
+ *
+ * @return A key set containing the data stored in `data`
+ */
+KeySet convertBuffer(Key const &parent, char const *data, size_t size,
+                     string const &source, Options const &options) {
+  using tao::TAO_PEGTL_NAMESPACE::memory_input;
+  using tao::TAO_PEGTL_NAMESPACE::tracking_mode;
+
+  memory_input<tracking_mode::LAZY> input{data, size, source};
+  return convert(parent, input, options);
+}
+
+/**
+ * @brief This function converts the YAML data stored in the given buffer
+ *        calling the methods of the given listener.
+ *
+ * @pre `data` has to contain UTF-8. Callers that keep references to the
+ *      input have to convert other encodings themselves (`toUtf8`).
+ *
+ * @param listener The function calls the methods of this listener. The
+ *                 listener may keep references to `data`.
+ * @param data This variable stores the start of the YAML data.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param source This text describes the origin of `data`. The function uses
+ *               it in error messages.
+ *
+ * @throws parse_error if the buffer does not contain (supported) YAML data
+ */
+void convertBuffer(Listener &listener, char const *data, size_t size,
+                   string const &source) {
+  using tao::TAO_PEGTL_NAMESPACE::memory_input;
+  using tao::TAO_PEGTL_NAMESPACE::tracking_mode;
+
+  memory_input<tracking_mode::LAZY> input{data, size, source};
+  convert(listener, input);
+}
+
 /**
  * @brief This function converts the given YAML file to keys and adds the
  *        result to `keySet`.
@@ -35,47 +296,22 @@ using std::string;
  *               information.
  * @param filename This parameter stores the path of the YAML file this
  *                 function converts.
+ * @param options This argument specifies options for the conversion.
  *
  * @retval -1 if there was an error converting the YAML file
  * @retval  0 if parsing was successful and the function did not change the
  *            given keyset
  * @retval  1 if parsing was successful and the function did change `keySet`
  */
-int addToKeySet(KeySet &keySet, Key &parent, string const &filename) {
+int addToKeySet(KeySet &keySet, Key &parent, string const &filename,
+                Options const &options) {
   using std::cerr;
-  using std::cout;
   using std::endl;
   using std::exception;
-  using tao::TAO_PEGTL_NAMESPACE::analyze;
-  using tao::TAO_PEGTL_NAMESPACE::file_input;
-  using tao::TAO_PEGTL_NAMESPACE::normal;
-  using tao::TAO_PEGTL_NAMESPACE::parse_error;
-  using tao::TAO_PEGTL_NAMESPACE::parse_tree::parse;
-
-  State state;
-
-  // Check grammar for problematic code
-  cout << "— Analyzer ————\n" << endl;
-  if (analyze<yaml>() != 0) {
-    cerr << "PEGTLs analyze function found problems while checking the top "
-            "level grammar rule `yaml`!"
-         << endl;
-    return -1;
-  }
 
   KeySet keys;
   try {
-    file_input<> input{filename};
-
-    cerr << "— Recognizer ————\n" << endl;
-    /* For detailed debugging information, please use the control class
-     * `tracer` instead of `normal`. */
-    auto root = parse<yaml, selector, action, normal>(input, state);
-
-    Listener listener{parent};
-    walk(listener, *root);
-    keys = listener.getKeySet();
-
+    keys = convertFile(parent, filename, options);
   } catch (exception const &error) {
     cerr << error.what() << endl;
     return -1;
@@ -13,10 +13,69 @@
 
 #include <kdb.hpp>
 
+#include "listener.hpp"
+#include "options.hpp"
+
 // -- Function -----------------------------------------------------------------
 
 namespace yaypeg {
 
+/**
+ * @brief This function converts the given YAML file to a key set.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param filename This parameter stores the path of the YAML file this
+ *                 function converts.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @throws input_error if the function is unable to read `filename`
+ * @throws parse_error if the file does not contain (supported) YAML data
+ *
+ * @return A key set containing the data stored in `filename`
+ */
+kdb::KeySet convertFile(kdb::Key const &parent, std::string const &filename,
+                        Options const &options = Options{});
+
+/**
+ * @brief This function converts the YAML data stored in the given buffer to a
+ *        key set.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param data This variable stores the start of the YAML data.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param source This text describes the origin of `data`. The function uses
+ *               it in error messages.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @throws parse_error if the buffer does not contain (supported) YAML data
+ *
+ * @return A key set containing the data stored in `data`
+ */
+kdb::KeySet convertBuffer(kdb::Key const &parent, char const *data,
+                          size_t size, std::string const &source,
+                          Options const &options = Options{});
+
+/**
+ * @brief This function converts the YAML data stored in the given buffer
+ *        calling the methods of the given listener.
+ *
+ * @pre `data` has to contain UTF-8. Callers that keep references to the
+ *      input have to convert other encodings themselves (`toUtf8`).
+ *
+ * @param listener The function calls the methods of this listener. The
+ *                 listener may keep references to `data`.
+ * @param data This variable stores the start of the YAML data.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param source This text describes the origin of `data`. The function uses
+ *               it in error messages.
+ *
+ * @throws parse_error if the buffer does not contain (supported) YAML data
+ */
+void convertBuffer(Listener &listener, char const *data, size_t size,
+                   std::string const &source);
+
 /**
  * @brief This function converts the given YAML file to keys and adds the
  *        result to `keySet`.
@@ -26,13 +85,16 @@ namespace yaypeg {
  *               information.
  * @param filename This parameter stores the path of the YAML file this
  *                 function converts.
+ * @param options This argument specifies options for the conversion.
  *
+ * @retval -1 if there was an error converting the YAML file
  * @retval  0 if parsing was successful and the function did not change the
  *            given keyset
  * @retval  1 if parsing was successful and the function did change `keySet`
  */
 int addToKeySet(kdb::KeySet &keySet, kdb::Key &parent,
-                std::string const &filename);
+                std::string const &filename,
+                Options const &options = Options{});
 
 } // namespace yaypeg
 
@@ -0,0 +1,329 @@
+/**
+ * @file
+ *
+ * @brief This file contains a function that converts all YAML files of a
+ *        directory tree.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include "directory.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "convert.hpp"
+#include "file.hpp"
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using std::condition_variable;
+using std::exception;
+using std::lock_guard;
+using std::mutex;
+using std::string;
+using std::system_category;
+using std::system_error;
+using std::thread;
+using std::unique_lock;
+using std::unordered_map;
+using std::vector;
+
+using kdb::Key;
+
+using yaypeg::LoadedDirectory;
+
+/**
+ * @brief This constant specifies how many files the readers may read ahead
+ *        of the parser.
+ */
+constexpr size_t lookahead = 64;
+
+/**
+ * @brief This struct stores a file a reader loaded into memory.
+ */
+struct Slot {
+  /** @brief This text stores the content of the file. */
+  string content;
+  /** @brief This text describes why the reader was unable to read the file,
+   *         or is empty. */
+  string error;
+  /** @brief This variable specifies if the reader already loaded the file. */
+  bool ready = false;
+};
+
+/**
+ * @brief This function checks if a file name has the extension of a YAML
+ *        file.
+ *
+ * @param name This text stores the name of the file.
+ *
+ * @retval true If `name` ends with `.yaml` or `.yml`
+ * @retval false Otherwise
+ */
+bool isYaml(string const &name) {
+  for (string extension : {".yaml", ".yml"}) {
+    if (name.size() > extension.size() &&
+        name.compare(name.size() - extension.size(), extension.size(),
+                     extension) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief This function collects the YAML files of a directory tree.
+ *
+ * The function skips hidden files and directories and symbolic links.
+ *
+ * @param root This text stores the path of the top level directory.
+ * @param relative This text stores the path of the current directory
+ *                 relative to `root`.
+ * @param files The function adds the paths (relative to `root`) of all YAML
+ *              files to this vector.
+ * @param failures The function adds subdirectories it is unable to read to
+ *                 this vector.
+ *
+ * @throws system_error if the function is unable to read `root`
+ */
+void collect(string const &root, string const &relative, vector<string> &files,
+             vector<LoadedDirectory::Failure> &failures) {
+  string path = relative.empty() ? root : root + "/" + relative;
+  DIR *handle = opendir(path.c_str());
+  if (!handle) {
+    system_error error{errno, system_category(),
+                       "Unable to open directory “" + path + "”"};
+    if (relative.empty()) {
+      throw error;
+    }
+    failures.push_back(LoadedDirectory::Failure{path, error.what()});
+    return;
+  }
+
+  while (dirent *entry = readdir(handle)) {
+    string name = entry->d_name;
+    if (name[0] == '.') {
+      continue;
+    }
+    string child = relative.empty() ? name : relative + "/" + name;
+    bool directory = entry->d_type == DT_DIR;
+    bool regular = entry->d_type == DT_REG;
+    // Some file systems do not report the type of an entry. `lstat` does not
+    // follow links, so links are neither directories nor regular files.
+    if (entry->d_type == DT_UNKNOWN) {
+      struct stat information;
+      if (lstat((root + "/" + child).c_str(), &information) == 0) {
+        directory = S_ISDIR(information.st_mode);
+        regular = S_ISREG(information.st_mode);
+      }
+    }
+
+    if (directory) {
+      collect(root, child, files, failures);
+    } else if (regular && isYaml(name)) {
+      files.push_back(child);
+    }
+  }
+  closedir(handle);
+}
+
+/**
+ * @brief This function returns the key below which the loader stores the
+ *        data of a file.
+ *
+ * @param parent This key specifies the parent of all keys of the directory.
+ * @param relative This text stores the path of the file relative to the
+ *                 directory.
+ *
+ * @return A key below `parent` that contains one part for every directory
+ *         of `relative` and the name of the file without extension
+ */
+Key mountpoint(Key const &parent, string const &relative) {
+  Key key = parent.dup();
+  size_t start = 0;
+  for (size_t slash; (slash = relative.find('/', start)) != string::npos;
+       start = slash + 1) {
+    key.addBaseName(relative.substr(start, slash - start));
+  }
+  string name = relative.substr(start);
+  key.addBaseName(name.substr(0, name.rfind('.')));
+  return key;
+}
+
+/**
+ * @brief This function reads a file into a slot.
+ *
+ * @param filename This text stores the path of the file.
+ *
+ * @return A slot that contains the content of the file or a description of
+ *         the problem
+ */
+Slot load(string const &filename) {
+  Slot slot;
+  try {
+    slot.content = yaypeg::readFile(filename);
+  } catch (system_error const &error) {
+    slot.error = error.what();
+  }
+  slot.ready = true;
+  return slot;
+}
+
+} // namespace
+
+namespace yaypeg {
+
+/**
+ * @brief This function converts all YAML files (`.yaml`, `.yml`) in the
+ *        given directory and its subdirectories.
+ *
+ * Reader threads load the files into memory, while the calling thread
+ * converts the files that were already read. The readers stay at most a
+ * fixed number of files ahead of the parser, which bounds the memory usage.
+ * The function converts the files in the order of their (sorted) paths and
+ * stores the keys of each file below a key derived from the path of the
+ * file relative to `directory`: The file `network/dns.yaml` becomes the key
+ * `network/dns` below `parent`. If two files only differ in their extension
+ * (`dns.yaml`, `dns.yml`), then the function only converts the first one and
+ * reports the other one as failure. The function skips symbolic links.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param directory This text stores the path of the directory.
+ * @param options This argument specifies options for the conversion of each
+ *                file.
+ * @param readers This number specifies how many threads read files ahead of
+ *                the parser. The value 0 reads every file right before its
+ *                conversion.
+ *
+ * @throws std::system_error if the function is unable to read `directory`
+ *
+ * @return The keys of all files and a list of files the function was unable
+ *         to convert
+ */
+LoadedDirectory loadDirectory(Key const &parent, string const &directory,
+                              Options const &options, size_t readers) {
+  LoadedDirectory result;
+  vector<string> files;
+  collect(directory, "", files, result.failures);
+  std::sort(files.begin(), files.end());
+  result.files = files.size();
+
+  // Files that only differ in their extension (`a.yaml`, `a.yml`) would
+  // store their keys below the same key. We only convert the first one.
+  unordered_map<string, string> stems;
+  vector<string> distinct;
+  for (auto const &file : files) {
+    auto stem = stems.emplace(file.substr(0, file.rfind('.')), file);
+    if (stem.second) {
+      distinct.push_back(file);
+      continue;
+    }
+    result.failures.push_back(LoadedDirectory::Failure{
+        directory + "/" + file,
+        "File uses the same key as “" + stem.first->second + "”"});
+  }
+  files = std::move(distinct);
+
+  vector<Slot> slots(files.size());
+  mutex lock;
+  condition_variable readable;
+  condition_variable writable;
+  size_t next = 0;
+  size_t converted = 0;
+
+  auto prefetch = [&]() {
+    for (;;) {
+      size_t file;
+      {
+        unique_lock<mutex> guard{lock};
+        writable.wait(guard, [&]() {
+          return next >= files.size() || next < converted + lookahead;
+        });
+        if (next >= files.size()) {
+          return;
+        }
+        file = next++;
+      }
+      Slot slot = load(directory + "/" + files[file]);
+      {
+        lock_guard<mutex> guard{lock};
+        slots[file] = std::move(slot);
+      }
+      readable.notify_all();
+    }
+  };
+  vector<thread> threads;
+  for (size_t reader = 0; reader < readers && reader < files.size();
+       reader++) {
+    threads.emplace_back(prefetch);
+  }
+
+  auto stop = [&]() {
+    {
+      lock_guard<mutex> guard{lock};
+      next = files.size();
+    }
+    writable.notify_all();
+    for (auto &reader : threads) {
+      reader.join();
+    }
+  };
+
+  try {
+    for (size_t file = 0; file < files.size(); file++) {
+      string filename = directory + "/" + files[file];
+      Slot slot;
+      if (threads.empty()) {
+        slot = load(filename);
+      } else {
+        unique_lock<mutex> guard{lock};
+        readable.wait(guard, [&]() { return slots[file].ready; });
+        slot = std::move(slots[file]);
+      }
+
+      if (!slot.error.empty()) {
+        result.failures.push_back(LoadedDirectory::Failure{filename,
+                                                           slot.error});
+      } else {
+        result.bytes += slot.content.size();
+        try {
+          result.keys.append(convertBuffer(mountpoint(parent, files[file]),
+                                           slot.content.data(),
+                                           slot.content.size(), filename,
+                                           options));
+        } catch (exception const &error) {
+          result.failures.push_back(
+              LoadedDirectory::Failure{filename, error.what()});
+        }
+      }
+
+      {
+        lock_guard<mutex> guard{lock};
+        converted++;
+      }
+      writable.notify_all();
+    }
+  } catch (...) {
+    stop();
+    throw;
+  }
+  stop();
+  return result;
+}
+
+} // namespace yaypeg
@@ -0,0 +1,90 @@
+/**
+ * @file
+ *
+ * @brief This file contains a function that converts all YAML files of a
+ *        directory tree.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_DIRECTORY_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_DIRECTORY_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+
+#include <kdb.hpp>
+
+#include "options.hpp"
+
+// -- Types & Functions --------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This struct stores the result of converting a directory tree.
+ */
+struct LoadedDirectory {
+  /** @brief This struct describes a file the loader was unable to convert. */
+  struct Failure {
+    /** @brief This text stores the path of the file. */
+    std::string filename;
+    /** @brief This text describes the problem. */
+    std::string message;
+  };
+
+  /** @brief This key set contains the keys of all converted files. */
+  kdb::KeySet keys;
+  /** @brief This vector stores the files the loader was unable to read or
+   *         convert. */
+  std::vector<Failure> failures;
+  /** @brief This number stores how many files the loader found. */
+  size_t files = 0;
+  /** @brief This number stores the size of all files in bytes. */
+  size_t bytes = 0;
+};
+
+/**
+ * @brief This constant specifies the default number of threads that read
+ *        files ahead of the parser.
+ */
+constexpr size_t defaultReaders = 4;
+
+/**
+ * @brief This function converts all YAML files (`.yaml`, `.yml`) in the
+ *        given directory and its subdirectories.
+ *
+ * Reader threads load the files into memory, while the calling thread
+ * converts the files that were already read. The readers stay at most a
+ * fixed number of files ahead of the parser, which bounds the memory usage.
+ * The function converts the files in the order of their (sorted) paths and
+ * stores the keys of each file below a key derived from the path of the
+ * file relative to `directory`: The file `network/dns.yaml` becomes the key
+ * `network/dns` below `parent`. If two files only differ in their extension
+ * (`dns.yaml`, `dns.yml`), then the function only converts the first one and
+ * reports the other one as failure. The function skips symbolic links.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param directory This text stores the path of the directory.
+ * @param options This argument specifies options for the conversion of each
+ *                file.
+ * @param readers This number specifies how many threads read files ahead of
+ *                the parser. The value 0 reads every file right before its
+ *                conversion.
+ *
+ * @throws std::system_error if the function is unable to read `directory`
+ *
+ * @return The keys of all files and a list of files the function was unable
+ *         to convert
+ */
+LoadedDirectory loadDirectory(kdb::Key const &parent,
+                              std::string const &directory,
+                              Options const &options = Options{},
+                              size_t readers = defaultReaders);
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_DIRECTORY_HPP
@@ -0,0 +1,503 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions to convert a key set to YAML.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "emitter.hpp"
+#include "schema.hpp"
+
+using kdb::Key;
+using kdb::KeySet;
+using std::invalid_argument;
+using std::string;
+using std::string_view;
+using std::vector;
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using yaypeg::Writer;
+
+/** @brief This enumeration specifies the styles of YAML scalars. */
+enum class Style { PLAIN, SINGLE_QUOTED, DOUBLE_QUOTED };
+
+/**
+ * @brief This function splits the name of a key into its (unescaped) parts.
+ *
+ * @param key This argument specifies the key the function splits.
+ * @param parts The function stores the parts of the name in this vector.
+ */
+void split(ckdb::Key const *key, vector<string_view> &parts) {
+  auto name = static_cast<char const *>(ckdb::keyUnescapedName(key));
+  auto end = name + ckdb::keyGetUnescapedNameSize(key);
+
+  parts.clear();
+  while (name < end) {
+    string_view part{name};
+    parts.push_back(part);
+    name += part.size() + 1;
+  }
+}
+
+/**
+ * @brief This function checks if the given key part is an array element.
+ *
+ * @param part This argument stores the part of a key name.
+ *
+ * @retval true If `part` has the form `#`, `_` × (n - 1), n digits
+ * @retval false Otherwise
+ */
+bool isArrayIndex(string_view part) {
+  if (part.size() < 2 || part[0] != '#') {
+    return false;
+  }
+  size_t underscores = 1;
+  while (underscores < part.size() && part[underscores] == '_') {
+    underscores++;
+  }
+  if (part.size() - underscores != underscores) {
+    return false;
+  }
+  for (size_t position = underscores; position < part.size(); position++) {
+    if (part[position] < '0' || part[position] > '9') {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief This function checks if the given character is a YAML indicator
+ *        (`c_indicator`).
+ *
+ * @param character This argument stores the character the function checks.
+ *
+ * @retval true If `character` is an indicator
+ * @retval false Otherwise
+ */
+bool isIndicator(char character) {
+  switch (character) {
+  case '-':
+  case '?':
+  case ':':
+  case ',':
+  case '[':
+  case ']':
+  case '{':
+  case '}':
+  case '#':
+  case '&':
+  case '*':
+  case '!':
+  case '|':
+  case '>':
+  case '\'':
+  case '"':
+  case '%':
+  case '@':
+  case '`':
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief This function determines the cheapest style that represents the
+ *        given text correctly.
+ *
+ * @param text This argument stores the text of a scalar.
+ *
+ * @return `PLAIN` if the text satisfies `ns_plain_first` and
+ *         `ns_plain_char` (block context), `SINGLE_QUOTED` if the text only
+ *         contains printable characters on a single line, and
+ *         `DOUBLE_QUOTED` otherwise
+ */
+Style styleOf(string_view text) {
+  Style style = Style::PLAIN;
+
+  if (text.empty() || text[0] == ' ' || text.back() == ' ' ||
+      text.back() == ':' || (isIndicator(text[0]) &&
+                             (text.size() < 2 || text[1] == ' ' ||
+                              !(text[0] == '-' || text[0] == '?' ||
+                                text[0] == ':'))) ||
+      text.substr(0, 3) == "---" || text.substr(0, 3) == "...") {
+    style = Style::SINGLE_QUOTED;
+  }
+
+  for (size_t position = 0; position < text.size(); position++) {
+    auto character = static_cast<unsigned char>(text[position]);
+    if (character < 0x20 || character == 0x7f ||
+        (character == 0xc2 && position + 1 < text.size() &&
+         static_cast<unsigned char>(text[position + 1]) < 0xa0)) {
+      // Control characters (including line breaks, tabs and C1 controls)
+      // require escape sequences
+      return Style::DOUBLE_QUOTED;
+    }
+    if ((character == ':' && position + 1 < text.size() &&
+         text[position + 1] == ' ') ||
+        (character == '#' && position > 0 && text[position - 1] == ' ')) {
+      style = Style::SINGLE_QUOTED;
+    }
+  }
+  return style;
+}
+
+/**
+ * @brief This function writes a double quoted scalar.
+ *
+ * @param text This argument stores the text of the scalar.
+ * @param writer The function writes the scalar to this output.
+ */
+void writeDoubleQuoted(string_view text, Writer &writer) {
+  static char const digits[] = "0123456789abcdef";
+
+  writer.put('"');
+  size_t start = 0;
+  for (size_t position = 0; position < text.size(); position++) {
+    auto character = static_cast<unsigned char>(text[position]);
+    char const *escape = nullptr;
+    unsigned code = character;
+    size_t length = 1;
+
+    if (character == '"') {
+      escape = "\\\"";
+    } else if (character == '\\') {
+      escape = "\\\\";
+    } else if (character == '\n') {
+      escape = "\\n";
+    } else if (character == '\t') {
+      escape = "\\t";
+    } else if (character == '\r') {
+      escape = "\\r";
+    } else if (character == 0) {
+      escape = "\\0";
+    } else if (character == 0xc2 && position + 1 < text.size() &&
+               static_cast<unsigned char>(text[position + 1]) < 0xa0) {
+      code = static_cast<unsigned char>(text[position + 1]);
+      length = 2;
+    } else if (character >= 0x20 && character != 0x7f) {
+      continue;
+    }
+
+    writer.write(text.data() + start, position - start);
+    if (escape) {
+      writer.write(escape);
+    } else {
+      char hex[] = {'\\', 'x', digits[code >> 4], digits[code & 0xf]};
+      writer.write(hex, sizeof(hex));
+    }
+    position += length - 1;
+    start = position + 1;
+  }
+  writer.write(text.data() + start, text.size() - start);
+  writer.put('"');
+}
+
+/**
+ * @brief This function writes a YAML scalar using the given style.
+ *
+ * @param text This argument stores the text of the scalar.
+ * @param style This value specifies a style that represents `text`
+ *              correctly.
+ * @param writer The function writes the scalar to this output.
+ */
+void writeScalar(string_view text, Style style, Writer &writer) {
+  switch (style) {
+  case Style::PLAIN:
+    writer.write(text);
+    return;
+  case Style::SINGLE_QUOTED:
+    writer.put('\'');
+    for (size_t start = 0;;) {
+      size_t quote = text.find('\'', start);
+      if (quote == string_view::npos) {
+        writer.write(text.substr(start));
+        break;
+      }
+      writer.write(text.substr(start, quote + 1 - start));
+      writer.put('\''); // Single quotes are escaped by doubling them
+      start = quote + 1;
+    }
+    writer.put('\'');
+    return;
+  case Style::DOUBLE_QUOTED:
+    writeDoubleQuoted(text, writer);
+    return;
+  }
+}
+
+/**
+ * @brief This function returns the length of a YAML scalar written in the
+ *        given style.
+ *
+ * @param text This argument stores the text of the scalar.
+ * @param style This value specifies a style that represents `text`
+ *              correctly.
+ *
+ * @return The number of bytes `writeScalar` writes for `text`
+ */
+size_t scalarLength(string_view text, Style style) {
+  if (style == Style::PLAIN) {
+    return text.size();
+  }
+  size_t length = text.size() + 2;
+  for (size_t position = 0; position < text.size(); position++) {
+    auto character = static_cast<unsigned char>(text[position]);
+    if (style == Style::SINGLE_QUOTED) {
+      length += character == '\'' ? 1 : 0;
+    } else if (character == '"' || character == '\\' || character == '\n' ||
+               character == '\t' || character == '\r' || character == 0) {
+      length += 1;
+    } else if (character == 0xc2 && position + 1 < text.size() &&
+               static_cast<unsigned char>(text[position + 1]) < 0xa0) {
+      length += 2; // Two bytes become `\xXX`
+      position++;
+    } else if (character < 0x20 || character == 0x7f) {
+      length += 3;
+    }
+  }
+  return length;
+}
+
+/**
+ * @brief This function writes a YAML scalar using the cheapest correct style.
+ *
+ * @param text This argument stores the text of the scalar.
+ * @param writer The function writes the scalar to this output.
+ */
+void writeScalar(string_view text, Writer &writer) {
+  writeScalar(text, styleOf(text), writer);
+}
+
+/**
+ * @brief This function writes the value of a key as YAML scalar.
+ *
+ * The function writes the canonical values of booleans (metakey `type`) as
+ * `true` and `false` and of special floats as `.inf`, `-.inf` and `.nan`, so
+ * that the type resolution of the parser restores them. It quotes plain
+ * scalars that the core schema would resolve to another type than the one
+ * stored in the metakey `type` (e.g. the string `42`).
+ *
+ * @param key This argument specifies the key that stores the value.
+ * @param writer The function writes the scalar to this output.
+ */
+void writeKeyScalar(ckdb::Key *key, Writer &writer) {
+  using yaypeg::resolveScalar;
+  using yaypeg::ScalarType;
+  using yaypeg::typeName;
+  using yaypeg::ValueBuffer;
+
+  string_view value = ckdb::keyString(key);
+  ckdb::Key const *meta = ckdb::keyGetMeta(key, "type");
+  string_view type = meta ? ckdb::keyString(meta) : "";
+  if (type == "boolean" && (value == "1" || value == "0")) {
+    writer.write(value == "1" ? "true" : "false");
+    return;
+  }
+  if (type == "double" && (value == "inf" || value == "-inf")) {
+    writer.write(value == "inf" ? ".inf" : "-.inf");
+    return;
+  }
+  if (type == "double" && value == "nan") {
+    writer.write(".nan");
+    return;
+  }
+
+  Style style = styleOf(value);
+  if (style == Style::PLAIN) {
+    ValueBuffer buffer;
+    ScalarType resolved = resolveScalar(value, buffer).type;
+    char const *name = typeName(resolved);
+    if (resolved != ScalarType::STRING && (!name || type != name)) {
+      style = Style::SINGLE_QUOTED;
+    }
+  }
+  writeScalar(value, style, writer);
+}
+
+/**
+ * @brief This function writes the value of a key after its name (or at the
+ *        start of the document).
+ *
+ * @param key This argument specifies the key that stores the value.
+ * @param writer The function writes the value to this output.
+ */
+void writeValue(ckdb::Key *key, Writer &writer) {
+  if (ckdb::keyGetValueSize(key) > 1) {
+    writer.put(' ');
+    writeKeyScalar(key, writer);
+  } else if (ckdb::keyGetMeta(key, "array")) {
+    writer.write(" []"); // An array without elements
+  }
+  writer.put('\n');
+}
+
+} // namespace
+
+namespace yaypeg {
+
+/**
+ * @brief This function writes the given key set as YAML data.
+ *
+ * The function ignores keys that are not located below `parent`. It converts
+ * keys with array base names (`#0`, `#_10`, …) to block sequences and all
+ * other keys to block mappings.
+ *
+ * @param keys This key set stores the keys the function converts.
+ * @param parent This key specifies the root of the YAML document.
+ * @param writer The function writes the YAML data to this output.
+ *
+ * @throws std::system_error if writing the data fails
+ * @throws std::invalid_argument if YAML is unable to represent the keys: a
+ *         key stores a value and has child keys, the child keys of a key mix
+ *         array elements with other names, or a part of a name is longer
+ *         than an implicit key (1024 characters)
+ */
+void emit(KeySet const &keys, Key const &parent, Writer &writer) {
+  ckdb::KeySet *handle = keys.getKeySet();
+  ckdb::Key *root = parent.getKey();
+
+  vector<string_view> rootParts;
+  split(root, rootParts);
+  size_t offset = rootParts.size();
+
+  // A key set is sorted, so every key directly precedes its descendants. We
+  // therefore only need to compare a key with the previous path (to find the
+  // levels we did not write yet) and the next key (to find out if the key
+  // is a leaf).
+  vector<string_view> previous;
+  vector<string_view> parts;
+  // This vector stores for every level of the previous path if its parent
+  // is a sequence.
+  vector<bool> sequences;
+  ssize_t size = ckdb::ksGetSize(handle);
+  for (ssize_t cursor = 0; cursor < size; cursor++) {
+    ckdb::Key *key = ckdb::ksAtCursor(handle, cursor);
+    if (!ckdb::keyIsBelowOrSame(root, key)) {
+      continue;
+    }
+    ckdb::Key *next =
+        cursor + 1 < size ? ckdb::ksAtCursor(handle, cursor + 1) : nullptr;
+    bool leaf = !next || !ckdb::keyIsBelow(key, next);
+    if (!leaf && ckdb::keyGetValueSize(key) > 1) {
+      throw invalid_argument("Key “" + string{ckdb::keyName(key)} +
+                             "” stores a value and has child keys");
+    }
+
+    split(key, parts);
+    if (parts.size() <= offset) {
+      if (leaf && ckdb::keyGetValueSize(key) > 1) {
+        // The whole document is a single scalar
+        writeKeyScalar(key, writer);
+        writer.put('\n');
+      }
+      continue;
+    }
+
+    size_t common = 0;
+    while (common < previous.size() && common + offset < parts.size() &&
+           previous[common] == parts[common + offset]) {
+      common++;
+    }
+
+    sequences.resize(parts.size() - offset);
+    for (size_t level = common; level + offset < parts.size(); level++) {
+      string_view part = parts[level + offset];
+      bool element = isArrayIndex(part);
+      // A sibling of the previous part has to use the same collection type
+      if (level == common && level < previous.size() &&
+          element != sequences[level]) {
+        throw invalid_argument("Key “" + string{ckdb::keyName(key)} +
+                               "” mixes array elements and other keys below "
+                               "the same parent");
+      }
+      sequences[level] = element;
+
+      writer.indent(2 * level);
+      if (element) {
+        writer.put('-');
+      } else {
+        // The grammar restricts implicit keys to 1024 characters
+        Style style = styleOf(part);
+        if (scalarLength(part, style) > 1024) {
+          throw invalid_argument("Key “" + string{ckdb::keyName(key)} +
+                                 "” contains a part longer than 1024 "
+                                 "characters");
+        }
+        writeScalar(part, style, writer);
+        writer.put(':');
+      }
+      if (level + offset + 1 < parts.size() || !leaf) {
+        writer.put('\n');
+      }
+    }
+    if (leaf) {
+      writeValue(key, writer);
+    }
+
+    previous.assign(parts.begin() + offset, parts.end());
+  }
+}
+
+/**
+ * @brief This function stores the given key set in a YAML file.
+ *
+ * The function writes a temporary file first and only replaces `filename`
+ * if it was able to convert all keys.
+ *
+ * @param keys This key set stores the keys the function saves.
+ * @param parent This key specifies the root of the YAML document.
+ * @param filename This parameter stores the path of the YAML file.
+ *
+ * @throws std::system_error if the function is unable to write `filename`
+ * @throws std::invalid_argument if YAML is unable to represent the keys
+ */
+void emitFile(KeySet const &keys, Key const &parent, string const &filename) {
+  using std::system_category;
+  using std::system_error;
+
+  string temporary = filename + ".XXXXXX";
+  int descriptor = mkstemp(&temporary[0]);
+  if (descriptor < 0) {
+    throw system_error(errno, system_category(),
+                       "Unable to open “" + filename + "”");
+  }
+
+  try {
+    fchmod(descriptor, 0644);
+    Writer writer{descriptor};
+    emit(keys, parent, writer);
+    writer.flush();
+  } catch (...) {
+    close(descriptor);
+    unlink(temporary.c_str());
+    throw;
+  }
+  if (close(descriptor) != 0 ||
+      rename(temporary.c_str(), filename.c_str()) != 0) {
+    int error = errno;
+    unlink(temporary.c_str());
+    throw system_error(error, system_category(),
+                       "Unable to write “" + filename + "”");
+  }
+}
+
+} // namespace yaypeg
@@ -0,0 +1,61 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions to convert a key set to YAML.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_EMITTER_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_EMITTER_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <string>
+
+#include <kdb.hpp>
+
+#include "writer.hpp"
+
+// -- Functions ----------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This function writes the given key set as YAML data.
+ *
+ * The function ignores keys that are not located below `parent`. It converts
+ * keys with array base names (`#0`, `#_10`, …) to block sequences and all
+ * other keys to block mappings.
+ *
+ * @param keys This key set stores the keys the function converts.
+ * @param parent This key specifies the root of the YAML document.
+ * @param writer The function writes the YAML data to this output.
+ *
+ * @throws std::system_error if writing the data fails
+ * @throws std::invalid_argument if YAML is unable to represent the keys: a
+ *         key stores a value and has child keys, the child keys of a key mix
+ *         array elements with other names, or a part of a name is longer
+ *         than an implicit key (1024 characters)
+ */
+void emit(kdb::KeySet const &keys, kdb::Key const &parent, Writer &writer);
+
+/**
+ * @brief This function stores the given key set in a YAML file.
+ *
+ * The function writes a temporary file first and only replaces `filename`
+ * if it was able to convert all keys.
+ *
+ * @param keys This key set stores the keys the function saves.
+ * @param parent This key specifies the root of the YAML document.
+ * @param filename This parameter stores the path of the YAML file.
+ *
+ * @throws std::system_error if the function is unable to write `filename`
+ * @throws std::invalid_argument if YAML is unable to represent the keys
+ */
+void emitFile(kdb::KeySet const &keys, kdb::Key const &parent,
+              std::string const &filename);
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_EMITTER_HPP
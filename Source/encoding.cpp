@@ -0,0 +1,323 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions that detect the encoding of YAML input
+ *        and convert UTF-16 and UTF-32 input to UTF-8.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "encoding.hpp"
+
+#define TAO_PEGTL_NAMESPACE yaypeg
+
+#include <tao/pegtl/parse_error.hpp>
+#include <tao/pegtl/position.hpp>
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using std::string;
+using std::to_string;
+
+using tao::TAO_PEGTL_NAMESPACE::parse_error;
+using tao::TAO_PEGTL_NAMESPACE::position;
+
+/**
+ * @brief This function reads a code unit.
+ *
+ * @tparam width This number specifies the size of a code unit in bytes.
+ *
+ * @param location This variable points to the first byte of the code unit.
+ * @param bigEndian This variable specifies if the input stores the most
+ *                  significant byte first.
+ *
+ * @return The value of the code unit
+ */
+template <size_t width>
+char32_t unit(unsigned char const *location, bool bigEndian) noexcept {
+  char32_t value = 0;
+  for (size_t byte = 0; byte < width; byte++) {
+    size_t shift = bigEndian ? width - 1 - byte : byte;
+    value |= static_cast<char32_t>(location[byte]) << (8 * shift);
+  }
+  return value;
+}
+
+/**
+ * @brief This function returns the position of a code unit.
+ *
+ * @tparam width This number specifies the size of a code unit in bytes.
+ *
+ * @param begin This variable stores the start of the input.
+ * @param location This variable points to the code unit.
+ * @param bigEndian This variable specifies if the input stores the most
+ *                  significant byte first.
+ * @param source This text describes the origin of the input.
+ *
+ * @return The position (offset, line and column in bytes) of `location`
+ */
+template <size_t width>
+position locate(unsigned char const *begin, unsigned char const *location,
+                bool bigEndian, string const &source) {
+  size_t line = 1;
+  unsigned char const *start = begin;
+  for (auto current = begin; current < location; current += width) {
+    if (unit<width>(current, bigEndian) == '\n') {
+      line++;
+      start = current + width;
+    }
+  }
+  return position{
+      tao::TAO_PEGTL_NAMESPACE::internal::iterator{
+          reinterpret_cast<char const *>(location),
+          static_cast<size_t>(location - begin), line,
+          static_cast<size_t>(location - start)},
+      source};
+}
+
+/**
+ * @brief This function stores the UTF-8 encoding of a code point.
+ *
+ * @param output This variable points to the memory the function writes to.
+ * @param code This number stores a Unicode code point.
+ *
+ * @return The location after the last byte the function wrote
+ */
+char *encode(char *output, char32_t code) noexcept {
+  if (code < 0x80) {
+    *output++ = static_cast<char>(code);
+  } else if (code < 0x800) {
+    *output++ = static_cast<char>(0xC0 | (code >> 6));
+    *output++ = static_cast<char>(0x80 | (code & 0x3F));
+  } else if (code < 0x10000) {
+    *output++ = static_cast<char>(0xE0 | (code >> 12));
+    *output++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    *output++ = static_cast<char>(0x80 | (code & 0x3F));
+  } else {
+    *output++ = static_cast<char>(0xF0 | (code >> 18));
+    *output++ = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+    *output++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    *output++ = static_cast<char>(0x80 | (code & 0x3F));
+  }
+  return output;
+}
+
+/**
+ * @brief This function copies the ASCII characters at the start of the
+ *        given code units.
+ *
+ * @tparam width This number specifies the size of a code unit in bytes.
+ *
+ * @param input This variable points to the first code unit.
+ * @param units This number specifies how many code units `input` contains.
+ * @param bigEndian This variable specifies if the input stores the most
+ *                  significant byte first.
+ * @param output The function stores the copied characters here.
+ *
+ * @return The number of characters the function copied
+ */
+template <size_t width>
+size_t copyAscii(unsigned char const *input, size_t units, bool bigEndian,
+                 char *output) noexcept {
+  size_t copied = 0;
+
+#if defined(__SSE2__)
+  // A block of 16 bytes contains only ASCII characters, if all bits except
+  // the lowest 7 of every code unit are zero. The function then packs the
+  // low bytes of the code units with saturation.
+  constexpr size_t block = 16 / width;
+  if constexpr (width == 2) {
+    __m128i const mask =
+        _mm_set1_epi16(static_cast<short>(bigEndian ? 0x80FF : 0xFF80));
+    for (; units - copied >= block; copied += block) {
+      __m128i data = _mm_loadu_si128(
+          reinterpret_cast<__m128i const *>(input + copied * width));
+      __m128i test = _mm_and_si128(data, mask);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(test, _mm_setzero_si128())) !=
+          0xFFFF) {
+        break;
+      }
+      if (bigEndian) {
+        data = _mm_srli_epi16(data, 8);
+      }
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(output + copied),
+                       _mm_packus_epi16(data, data));
+    }
+  } else {
+    __m128i const mask = _mm_set1_epi32(
+        static_cast<int>(bigEndian ? 0x80FFFFFFu : 0xFFFFFF80u));
+    for (; units - copied >= block; copied += block) {
+      __m128i data = _mm_loadu_si128(
+          reinterpret_cast<__m128i const *>(input + copied * width));
+      __m128i test = _mm_and_si128(data, mask);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(test, _mm_setzero_si128())) !=
+          0xFFFF) {
+        break;
+      }
+      if (bigEndian) {
+        data = _mm_srli_epi32(data, 24);
+      }
+      data = _mm_packs_epi32(data, data);
+      int characters = _mm_cvtsi128_si32(_mm_packus_epi16(data, data));
+      std::memcpy(output + copied, &characters, block);
+    }
+  }
+#endif
+
+  for (; copied < units; copied++) {
+    char32_t code = unit<width>(input + copied * width, bigEndian);
+    if (code >= 0x80) {
+      break;
+    }
+    output[copied] = static_cast<char>(code);
+  }
+  return copied;
+}
+
+/**
+ * @brief This function converts UTF-16 or UTF-32 input to UTF-8.
+ *
+ * @tparam width This number specifies the size of a code unit in bytes.
+ *
+ * @param data This variable stores the start of the input.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param bigEndian This variable specifies if the input stores the most
+ *                  significant byte first.
+ * @param source This text describes the origin of `data`.
+ *
+ * @throws parse_error if `data` is not valid UTF-16 or UTF-32
+ *
+ * @return The UTF-8 version of `data`
+ */
+template <size_t width>
+string transcode(char const *data, size_t size, bool bigEndian,
+                 string const &source) {
+  auto begin = reinterpret_cast<unsigned char const *>(data);
+  string const encoding = "UTF-" + to_string(8 * width);
+  if (size % width != 0) {
+    throw parse_error("Input ends with an incomplete " + encoding +
+                          " code unit",
+                      locate<width>(begin, begin + size - size % width,
+                                    bigEndian, source));
+  }
+
+  // A UTF-16 code unit needs at most 3 bytes in UTF-8, surrogate pairs
+  // need 4 bytes for 2 code units. Every UTF-32 code unit needs at most 4
+  // bytes.
+  size_t units = size / width;
+  string result(units * (width == 2 ? 3 : 4), '\0');
+  char *output = &result[0];
+
+  for (size_t current = 0; current < units;) {
+    size_t ascii = copyAscii<width>(begin + current * width, units - current,
+                                    bigEndian, output);
+    current += ascii;
+    output += ascii;
+    if (current >= units) {
+      break;
+    }
+
+    size_t start = current++;
+    char32_t code = unit<width>(begin + start * width, bigEndian);
+    if (width == 2 && code >= 0xD800 && code <= 0xDBFF && current < units) {
+      char32_t low = unit<width>(begin + current * width, bigEndian);
+      if (low >= 0xDC00 && low <= 0xDFFF) {
+        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        current++;
+      }
+    }
+    if (code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+      throw parse_error("Invalid " + encoding + " character",
+                        locate<width>(begin, begin + start * width,
+                                      bigEndian, source));
+    }
+    output = encode(output, code);
+  }
+
+  result.resize(static_cast<size_t>(output - result.data()));
+  return result;
+}
+
+} // namespace
+
+namespace yaypeg {
+
+/**
+ * @brief This function detects the character encoding of YAML input.
+ *
+ * The function uses the byte order mark or, if there is none, the pattern of
+ * null bytes in the first character, as described in section 5.2 of the
+ * YAML specification.
+ *
+ * @param data This variable stores the start of the input.
+ * @param size This number specifies the length of `data` in bytes.
+ *
+ * @return The encoding of `data`
+ */
+Encoding detectEncoding(char const *data, size_t size) noexcept {
+  auto bytes = reinterpret_cast<unsigned char const *>(data);
+  if (size >= 4) {
+    if (bytes[0] == 0 && bytes[1] == 0 &&
+        ((bytes[2] == 0xFE && bytes[3] == 0xFF) || bytes[2] == 0)) {
+      return Encoding::UTF_32BE;
+    }
+    if ((bytes[0] == 0xFF && bytes[1] == 0xFE && bytes[2] == 0 &&
+         bytes[3] == 0) ||
+        (bytes[1] == 0 && bytes[2] == 0 && bytes[3] == 0)) {
+      return Encoding::UTF_32LE;
+    }
+  }
+  if (size >= 2) {
+    if ((bytes[0] == 0xFE && bytes[1] == 0xFF) || bytes[0] == 0) {
+      return Encoding::UTF_16BE;
+    }
+    if ((bytes[0] == 0xFF && bytes[1] == 0xFE) || bytes[1] == 0) {
+      return Encoding::UTF_16LE;
+    }
+  }
+  return Encoding::UTF_8;
+}
+
+/**
+ * @brief This function converts UTF-16 or UTF-32 input to UTF-8.
+ *
+ * The function copies runs of ASCII characters with SIMD instructions and
+ * only encodes other characters one at a time. It keeps byte order marks, so
+ * the grammar still sees them (as UTF-8 byte order marks).
+ *
+ * @param data This variable stores the start of the input.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param encoding This value specifies the encoding of `data`.
+ * @param source This text describes the origin of `data`. The function uses
+ *               it in error messages.
+ *
+ * @throws parse_error if `data` contains an incomplete code unit, an unpaired
+ *         surrogate or a value that is not a Unicode code point
+ *
+ * @return The UTF-8 version of `data`
+ */
+string toUtf8(char const *data, size_t size, Encoding encoding,
+              string const &source) {
+  switch (encoding) {
+  case Encoding::UTF_16LE:
+  case Encoding::UTF_16BE:
+    return transcode<2>(data, size, encoding == Encoding::UTF_16BE, source);
+  case Encoding::UTF_32LE:
+  case Encoding::UTF_32BE:
+    return transcode<4>(data, size, encoding == Encoding::UTF_32BE, source);
+  default:
+    return string{data, size};
+  }
+}
+
+} // namespace yaypeg
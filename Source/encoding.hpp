@@ -0,0 +1,63 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions that detect the encoding of YAML input
+ *        and convert UTF-16 and UTF-32 input to UTF-8.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_ENCODING_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_ENCODING_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// -- Types & Functions --------------------------------------------------------
+
+namespace yaypeg {
+
+/** @brief This enumeration specifies the character encodings of YAML. */
+enum class Encoding : uint8_t { UTF_8, UTF_16LE, UTF_16BE, UTF_32LE, UTF_32BE };
+
+/**
+ * @brief This function detects the character encoding of YAML input.
+ *
+ * The function uses the byte order mark or, if there is none, the pattern of
+ * null bytes in the first character, as described in section 5.2 of the
+ * YAML specification.
+ *
+ * @param data This variable stores the start of the input.
+ * @param size This number specifies the length of `data` in bytes.
+ *
+ * @return The encoding of `data`
+ */
+Encoding detectEncoding(char const *data, size_t size) noexcept;
+
+/**
+ * @brief This function converts UTF-16 or UTF-32 input to UTF-8.
+ *
+ * The function copies runs of ASCII characters with SIMD instructions and
+ * only encodes other characters one at a time. It keeps byte order marks, so
+ * the grammar still sees them (as UTF-8 byte order marks).
+ *
+ * @param data This variable stores the start of the input.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param encoding This value specifies the encoding of `data`.
+ * @param source This text describes the origin of `data`. The function uses
+ *               it in error messages.
+ *
+ * @throws parse_error if `data` contains an incomplete code unit, an unpaired
+ *         surrogate or a value that is not a Unicode code point
+ *
+ * @return The UTF-8 version of `data`
+ */
+std::string toUtf8(char const *data, size_t size, Encoding encoding,
+                   std::string const &source);
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_ENCODING_HPP
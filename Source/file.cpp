@@ -0,0 +1,233 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions to access files.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include "file.hpp"
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using std::string;
+using std::system_category;
+using std::system_error;
+
+/**
+ * @brief This function throws an exception describing the last failed system
+ *        call.
+ *
+ * @param message This text describes the failed operation.
+ * @param filename This parameter stores the path of the file the failed
+ *                 operation accessed.
+ */
+[[noreturn]] void fail(string const &message, string const &filename) {
+  throw system_error(errno, system_category(),
+                     message + " “" + filename + "”");
+}
+
+} // namespace
+
+namespace yaypeg {
+
+using std::string;
+
+/**
+ * @brief This method compares two file states.
+ *
+ * @param other This argument specifies the status this method compares with
+ *              the current status.
+ *
+ * @retval true If size and modification time of both states are equal
+ * @retval false Otherwise
+ */
+bool FileStatus::operator==(FileStatus const &other) const noexcept {
+  return size == other.size && seconds == other.seconds &&
+         nanoseconds == other.nanoseconds;
+}
+
+/**
+ * @brief This method compares two file states.
+ *
+ * @param other This argument specifies the status this method compares with
+ *              the current status.
+ *
+ * @retval true If size or modification time of the states differ
+ * @retval false Otherwise
+ */
+bool FileStatus::operator!=(FileStatus const &other) const noexcept {
+  return !(*this == other);
+}
+
+/**
+ * @brief This function determines the status of the given file.
+ *
+ * @param filename This parameter stores the path of the file.
+ *
+ * @throws std::system_error if the function is unable to determine the status
+ *         of `filename`
+ *
+ * @return Size and modification time of `filename`
+ */
+FileStatus fileStatus(string const &filename) {
+  struct stat information;
+  if (stat(filename.c_str(), &information) != 0) {
+    fail("Unable to determine status of file", filename);
+  }
+
+  FileStatus status;
+  status.size = static_cast<uint64_t>(information.st_size);
+#if defined(__APPLE__)
+  status.seconds = information.st_mtimespec.tv_sec;
+  status.nanoseconds = information.st_mtimespec.tv_nsec;
+#else
+  status.seconds = information.st_mtim.tv_sec;
+  status.nanoseconds = information.st_mtim.tv_nsec;
+#endif
+  return status;
+}
+
+/**
+ * @brief This function reads the content of the given file.
+ *
+ * @param filename This parameter stores the path of the file.
+ *
+ * @throws std::system_error if the function is unable to read `filename`
+ *
+ * @return The content of `filename`
+ */
+string readFile(string const &filename) {
+  int descriptor = open(filename.c_str(), O_RDONLY);
+  if (descriptor < 0) {
+    fail("Unable to open file", filename);
+  }
+
+  // We read the file directly into the result. If the file is larger than
+  // expected, then we append the remaining data using a small buffer.
+  struct stat information;
+  string content;
+  if (fstat(descriptor, &information) == 0 && information.st_size > 0) {
+    content.resize(static_cast<size_t>(information.st_size));
+  }
+
+  char overflow[1 << 12];
+  size_t length = 0;
+  for (;;) {
+    bool full = length == content.size();
+    ssize_t bytes = full ? read(descriptor, overflow, sizeof(overflow))
+                         : read(descriptor, &content[length],
+                                content.size() - length);
+    if (bytes == 0) {
+      break;
+    }
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes < 0) {
+      int error = errno;
+      close(descriptor);
+      errno = error;
+      fail("Unable to read file", filename);
+    }
+    if (full) {
+      content.append(overflow, static_cast<size_t>(bytes));
+    }
+    length += static_cast<size_t>(bytes);
+  }
+
+  close(descriptor);
+  content.resize(length);
+  return content;
+}
+
+// ==============
+// = MappedFile =
+// ==============
+
+/**
+ * @brief This constructor maps the given file into memory.
+ *
+ * @param filename This parameter stores the path of the file.
+ *
+ * @throws std::system_error if the constructor is unable to map `filename`
+ */
+MappedFile::MappedFile(string const &filename) : memory{""}, bytes{0} {
+  int descriptor = open(filename.c_str(), O_RDONLY);
+  if (descriptor < 0) {
+    fail("Unable to open file", filename);
+  }
+
+  struct stat information;
+  if (fstat(descriptor, &information) != 0) {
+    int error = errno;
+    close(descriptor);
+    errno = error;
+    fail("Unable to determine status of file", filename);
+  }
+
+  // We can not map empty files
+  if (information.st_size > 0) {
+    void *mapping = mmap(nullptr, static_cast<size_t>(information.st_size),
+                         PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (mapping == MAP_FAILED) {
+      int error = errno;
+      close(descriptor);
+      errno = error;
+      fail("Unable to map file", filename);
+    }
+    memory = static_cast<char const *>(mapping);
+    bytes = static_cast<size_t>(information.st_size);
+  }
+
+  close(descriptor);
+}
+
+/**
+ * @brief This constructor takes over the mapping of another object.
+ *
+ * @param other This argument stores the object this constructor takes the
+ *              mapping from.
+ */
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : memory{other.memory}, bytes{other.bytes} {
+  other.memory = "";
+  other.bytes = 0;
+}
+
+/**
+ * @brief This destructor removes the mapping of the file.
+ */
+MappedFile::~MappedFile() {
+  if (bytes > 0) {
+    munmap(const_cast<char *>(memory), bytes);
+  }
+}
+
+/**
+ * @brief This method returns the start of the file content.
+ *
+ * @return A pointer to the first byte of the mapped file
+ */
+char const *MappedFile::data() const noexcept { return memory; }
+
+/**
+ * @brief This method returns the size of the file content.
+ *
+ * @return The number of mapped bytes
+ */
+size_t MappedFile::size() const noexcept { return bytes; }
+
+} // namespace yaypeg
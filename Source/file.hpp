@@ -0,0 +1,135 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions to access files.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_FILE_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_FILE_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// -- Types & Functions --------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This struct stores metadata of a file.
+ */
+struct FileStatus {
+  /** @brief This number stores the size of the file in bytes. */
+  uint64_t size = 0;
+  /** @brief This number stores the seconds part of the modification time. */
+  int64_t seconds = 0;
+  /** @brief This number stores the nanoseconds part of the modification
+   *         time. */
+  int64_t nanoseconds = 0;
+
+  /**
+   * @brief This method compares two file states.
+   *
+   * @param other This argument specifies the status this method compares with
+   *              the current status.
+   *
+   * @retval true If size and modification time of both states are equal
+   * @retval false Otherwise
+   */
+  bool operator==(FileStatus const &other) const noexcept;
+
+  /**
+   * @brief This method compares two file states.
+   *
+   * @param other This argument specifies the status this method compares with
+   *              the current status.
+   *
+   * @retval true If size or modification time of the states differ
+   * @retval false Otherwise
+   */
+  bool operator!=(FileStatus const &other) const noexcept;
+};
+
+/**
+ * @brief This function determines the status of the given file.
+ *
+ * @param filename This parameter stores the path of the file.
+ *
+ * @throws std::system_error if the function is unable to determine the status
+ *         of `filename`
+ *
+ * @return Size and modification time of `filename`
+ */
+FileStatus fileStatus(std::string const &filename);
+
+/**
+ * @brief This function reads the content of the given file.
+ *
+ * @param filename This parameter stores the path of the file.
+ *
+ * @throws std::system_error if the function is unable to read `filename`
+ *
+ * @return The content of `filename`
+ */
+std::string readFile(std::string const &filename);
+
+/**
+ * @brief This class maps the content of a file into memory (read only).
+ */
+class MappedFile {
+
+  /** @brief This variable stores the start of the mapped file content. */
+  char const *memory;
+
+  /** @brief This number stores the size of the mapped file content. */
+  size_t bytes;
+
+public:
+  /**
+   * @brief This constructor maps the given file into memory.
+   *
+   * @param filename This parameter stores the path of the file.
+   *
+   * @throws std::system_error if the constructor is unable to map `filename`
+   */
+  explicit MappedFile(std::string const &filename);
+
+  /**
+   * @brief This constructor takes over the mapping of another object.
+   *
+   * @param other This argument stores the object this constructor takes the
+   *              mapping from.
+   */
+  MappedFile(MappedFile &&other) noexcept;
+
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile &&) = delete;
+
+  /**
+   * @brief This destructor removes the mapping of the file.
+   */
+  ~MappedFile();
+
+  /**
+   * @brief This method returns the start of the file content.
+   *
+   * @return A pointer to the first byte of the mapped file
+   */
+  char const *data() const noexcept;
+
+  /**
+   * @brief This method returns the size of the file content.
+   *
+   * @return The number of mapped bytes
+   */
+  size_t size() const noexcept;
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_FILE_HPP
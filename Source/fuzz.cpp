@@ -0,0 +1,75 @@
+/**
+ * @file
+ *
+ * @brief This file contains a fuzz target for the YAML parser.
+ *
+ * The target works with libFuzzer (`-fsanitize=fuzzer`) and with AFL++
+ * (`afl-clang-fast++ -fsanitize=fuzzer`). It feeds arbitrary bytes through
+ * the grammar and the tree walker and only reports crashes and sanitizer
+ * findings. The fuzzer option `-timeout` reports slow inputs. The tool
+ * `yaypeg-complexity` checks if such inputs grow faster than linear.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+
+#define TAO_PEGTL_NAMESPACE yaypeg
+
+#include <tao/pegtl.hpp>
+
+#include <kdb.hpp>
+
+#include "convert.hpp"
+#include "limits.hpp"
+#include "options.hpp"
+
+using tao::TAO_PEGTL_NAMESPACE::parse_error;
+
+using kdb::Key;
+
+using yaypeg::convertBuffer;
+using yaypeg::limit_error;
+using yaypeg::Options;
+
+// -- Constants ----------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief This constant specifies the maximum nesting depth of the input. Deep
+ *        input would otherwise only find the (expected) stack overflow of the
+ *        recursive descent parser.
+ */
+constexpr size_t maximumDepth = 100;
+
+} // namespace
+
+// -- Functions ----------------------------------------------------------------
+
+/**
+ * @brief This function converts the given data to keys.
+ *
+ * @param data This variable stores the start of the fuzzer input.
+ * @param size This number specifies the length of `data` in bytes.
+ *
+ * @return `0` in any case, as required by libFuzzer
+ */
+extern "C" int LLVMFuzzerTestOneInput(uint8_t const *data, size_t size) {
+  Options options;
+  options.limits.maximumDepth = maximumDepth;
+
+  Key parent{"user", KEY_END};
+  try {
+    convertBuffer(parent, reinterpret_cast<char const *>(data), size, "fuzz",
+                  options);
+  } catch (parse_error const &) {
+    // Most random inputs are not valid YAML.
+  } catch (limit_error const &) {
+    // The parser stopped at the maximum nesting depth.
+  }
+  return 0;
+}
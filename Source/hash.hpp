@@ -0,0 +1,41 @@
+/**
+ * @file
+ *
+ * @brief This file contains a function to compute the hash of a byte
+ *        sequence.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_HASH_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_HASH_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+
+// -- Function -----------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This function computes the 64 bit FNV-1a hash of the given data.
+ *
+ * @param data This variable stores the start of the data the function hashes.
+ * @param size This number specifies the length of `data` in bytes.
+ *
+ * @return The hash value of the given data
+ */
+inline uint64_t hash(char const *data, size_t size) noexcept {
+  uint64_t value = 0xcbf29ce484222325;
+  for (auto byte = data; byte < data + size; byte++) {
+    value ^= static_cast<unsigned char>(*byte);
+    value *= 0x100000001b3;
+  }
+  return value;
+}
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_HASH_HPP
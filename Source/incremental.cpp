@@ -0,0 +1,472 @@
+/**
+ * @file
+ *
+ * @brief This file contains the implementation of a parser that updates the
+ *        key set of a YAML document incrementally.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+#include "control.hpp"
+#include "encoding.hpp"
+#include "incremental.hpp"
+#include "lines.hpp"
+#include "listener.hpp"
+#include "parser.hpp"
+#include "state.hpp"
+#include "structure.hpp"
+#include "walk.hpp"
+
+#define TAO_PEGTL_NAMESPACE yaypeg
+
+#include <tao/pegtl/contrib/parse_tree.hpp>
+
+using kdb::Key;
+using kdb::KeySet;
+using std::string;
+using std::vector;
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using yaypeg::LineIndex;
+using yaypeg::Listener;
+using yaypeg::Options;
+using yaypeg::State;
+using yaypeg::StructuralIndex;
+
+/**
+ * @brief This struct stores the result of parsing (a part of) a document.
+ */
+struct Parsed {
+  /** @brief This key set contains the converted data. */
+  KeySet keys;
+  /** @brief This variable specifies if the data is a (possibly empty) block
+   *         mapping. */
+  bool mapping = true;
+  /** @brief This vector stores the offset of the line and the indentation of
+   *         each top level entry. */
+  vector<std::pair<size_t, size_t>> starts;
+  /** @brief This vector stores the keys of each top level entry. */
+  vector<KeySet> entries;
+};
+
+/**
+ * @brief This function checks if a given string ends with another string
+ *
+ * @param text This parameter stores the string that should be checked for the
+ *             ending stored in `ending`.
+ * @param ending This variable stores the text that will be compared with the
+ *               end of `text`.
+ *
+ * @retval true If `text` ends with `ending`
+ * @retval false Otherwise
+ */
+bool ends_with(string const &text, string const &ending) {
+  return ending.size() > text.size()
+             ? false
+             : std::equal(ending.rbegin(), ending.rend(), text.rbegin());
+}
+
+/**
+ * @brief This function checks if a syntax tree contains anchors or aliases.
+ *
+ * @param node This argument stores the root of the syntax tree.
+ *
+ * @retval true If the tree contains an anchor or an alias
+ * @retval false Otherwise
+ */
+bool containsAnchors(tao::TAO_PEGTL_NAMESPACE::parse_tree::node const &node) {
+  if (ends_with(node.name(), "c_ns_anchor_property") ||
+      ends_with(node.name(), "c_ns_alias_node")) {
+    return true;
+  }
+  return std::any_of(node.children.begin(), node.children.end(),
+                     [](auto const &child) { return containsAnchors(*child); });
+}
+
+/**
+ * @brief This function converts YAML data and records the location of the top
+ *        level entries of a block mapping.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param options This argument specifies options for the conversion.
+ * @param data This variable stores the start of the YAML data.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param offset This number stores the offset of `data` inside the whole
+ *               document.
+ *
+ * @throws parse_error if the data does not contain (supported) YAML data
+ * @throws limit_error if the conversion exceeds one of the limits stored in
+ *         `options`
+ *
+ * @return The converted data
+ */
+Parsed parse(Key const &parent, Options const &options, char const *data,
+             size_t size, size_t offset) {
+  using tao::TAO_PEGTL_NAMESPACE::memory_input;
+  using tao::TAO_PEGTL_NAMESPACE::tracking_mode;
+  using yaypeg::action;
+  using yaypeg::limited;
+  using yaypeg::selector;
+  using yaypeg::walk;
+  using yaypeg::yaml;
+
+  memory_input<tracking_mode::LAZY> input{data, size, "incremental update"};
+  State state;
+  state.limits = options.limits;
+  state.logger = options.logger.get();
+  std::unique_ptr<StructuralIndex> structure;
+  if (options.structuralIndex) {
+    structure = std::make_unique<StructuralIndex>(data, size);
+    state.structure = structure.get();
+  }
+  auto root = tao::TAO_PEGTL_NAMESPACE::parse_tree::parse<yaml, selector,
+                                                           action, limited>(
+      input, state);
+
+  LineIndex lines{data, input.source()};
+  Parsed result;
+  // An alias may refer to an anchor in another top level entry. We therefore
+  // convert documents with anchors as a whole.
+  result.mapping =
+      !containsAnchors(*root) &&
+      std::all_of(root->children.begin(), root->children.end(),
+                  [](auto const &child) {
+                    return ends_with(child->name(),
+                                     "ns_l_block_map_implicit_entry");
+                  });
+
+  if (!result.mapping) {
+    Listener listener{parent, options};
+    listener.setBlockIndentation(state.blockIndentation);
+    walk(listener, *root, lines);
+    result.keys = listener.getKeySet();
+    return result;
+  }
+
+  for (auto &child : root->children) {
+    // Every entry has to start on its own line
+    char const *start = child->m_begin.data;
+    char const *line = start;
+    while (line > data && *(line - 1) == ' ') {
+      line--;
+    }
+    if (line > data && *(line - 1) != '\n') {
+      result.mapping = false;
+    }
+
+    Listener listener{parent, options};
+    listener.setBlockIndentation(state.blockIndentation);
+    walk(listener, *child, lines);
+    KeySet keys = listener.getKeySet();
+    result.keys.append(keys);
+    result.entries.push_back(keys);
+    result.starts.emplace_back(offset + static_cast<size_t>(line - data),
+                               static_cast<size_t>(start - line));
+  }
+
+  return result;
+}
+
+/**
+ * @brief This function compares value and metadata of two keys.
+ *
+ * @param first This argument stores the first key this function compares.
+ * @param second This argument stores the second key this function compares.
+ *
+ * @retval true If both keys store the same value and metadata
+ * @retval false Otherwise
+ */
+bool equal(Key first, Key second) {
+  if (first.getString() != second.getString()) {
+    return false;
+  }
+
+  size_t metaKeys = 0;
+  first.rewindMeta();
+  while (Key meta = first.nextMeta()) {
+    if (!second.hasMeta(meta.getName()) ||
+        second.getMeta<string>(meta.getName()) != meta.getString()) {
+      return false;
+    }
+    metaKeys++;
+  }
+
+  second.rewindMeta();
+  while (second.nextMeta()) {
+    if (metaKeys-- == 0) {
+      return false;
+    }
+  }
+  return metaKeys == 0;
+}
+
+/**
+ * @brief This function determines the difference between two key sets.
+ *
+ * @param before This key set stores the old data.
+ * @param after This key set stores the new data.
+ *
+ * @return The keys that were added, removed or changed in `after`
+ */
+yaypeg::IncrementalParser::Changes difference(KeySet const &before,
+                                              KeySet const &after) {
+  yaypeg::IncrementalParser::Changes changes;
+
+  for (auto key : after) {
+    Key old = before.lookup(key);
+    if (!old) {
+      changes.added.append(key);
+    } else if (!equal(old, key)) {
+      changes.changed.append(key);
+    }
+  }
+
+  for (auto key : before) {
+    if (!after.lookup(key)) {
+      changes.removed.append(key);
+    }
+  }
+
+  return changes;
+}
+
+} // namespace
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+using std::move;
+
+/**
+ * @brief This method converts the whole document again.
+ *
+ * @param document This argument stores the new text of the document.
+ *
+ * @return The difference between the old and the new key set
+ */
+IncrementalParser::Changes IncrementalParser::reload(string document) {
+  Parsed parsed = parse(parent, options, document.data(), document.size(), 0);
+
+  Changes changes = difference(keys, parsed.keys);
+
+  entries.clear();
+  if (parsed.mapping && !parsed.starts.empty()) {
+    indentation = parsed.starts.front().second;
+    for (size_t entry = 0; entry < parsed.starts.size(); entry++) {
+      entries.push_back(
+          Entry{parsed.starts[entry].first, parsed.entries[entry]});
+    }
+  }
+  keys = parsed.keys;
+  text = move(document);
+
+  return changes;
+}
+
+/**
+ * @brief This constructor creates a parser for an empty document.
+ *
+ * @param parentKey This key specifies the parent of all keys the parser
+ *                  creates.
+ * @param settings This argument specifies options for the conversions. The
+ *                 limits apply to each update.
+ */
+IncrementalParser::IncrementalParser(Key const &parentKey,
+                                     Options const &settings)
+    : parent{parentKey}, options{settings} {}
+
+/**
+ * @brief This method replaces the current document with the given text.
+ *
+ * The method converts UTF-16 and UTF-32 documents to UTF-8 first.
+ *
+ * @param document This argument stores the new text of the document.
+ *
+ * @throws parse_error if `document` does not contain (supported) YAML data.
+ *         In this case the state of the parser does not change.
+ * @throws limit_error if the conversion exceeds one of the limits stored in
+ *         the options of the parser. In this case the state of the parser
+ *         does not change.
+ *
+ * @return The difference between the old and the new key set
+ */
+IncrementalParser::Changes IncrementalParser::update(string document) {
+  // The grammar only matches UTF-8. We compare and store the UTF-8 version of
+  // UTF-16 and UTF-32 documents.
+  Encoding encoding = detectEncoding(document.data(), document.size());
+  if (encoding != Encoding::UTF_8) {
+    document = toUtf8(document.data(), document.size(), encoding,
+                      "incremental update");
+  }
+
+  size_t shorter = std::min(text.size(), document.size());
+
+  size_t prefix =
+      static_cast<size_t>(std::mismatch(text.begin(), text.begin() + shorter,
+                                        document.begin())
+                              .first -
+                          text.begin());
+  size_t suffix =
+      static_cast<size_t>(std::mismatch(text.rbegin(),
+                                        text.rbegin() + (shorter - prefix),
+                                        document.rbegin())
+                              .first -
+                          text.rbegin());
+
+  if (prefix == text.size() && prefix == document.size()) {
+    return Changes{};
+  }
+
+  return update(move(document), prefix, text.size() - prefix - suffix);
+}
+
+/**
+ * @brief This method replaces the current document with the given text.
+ *
+ * Use this method if you already know which part of the document changed.
+ * Since the offsets refer to bytes of the document, the method only accepts
+ * UTF-8 documents.
+ *
+ * @param document This argument stores the new text of the document.
+ * @param offset This number specifies the start of the edit in the old
+ *               document.
+ * @param length This number specifies how many bytes of the old document,
+ *               starting at `offset`, the edit replaced.
+ *
+ * @throws std::invalid_argument if `document` is not encoded in UTF-8
+ * @throws parse_error if `document` does not contain (supported) YAML data.
+ *         In this case the state of the parser does not change.
+ * @throws limit_error if the conversion exceeds one of the limits stored in
+ *         the options of the parser. In this case the state of the parser
+ *         does not change.
+ *
+ * @return The difference between the old and the new key set
+ */
+IncrementalParser::Changes
+IncrementalParser::update(string document, size_t offset, size_t length) {
+  using std::invalid_argument;
+  using std::out_of_range;
+
+  if (offset > text.size() || length > text.size() - offset ||
+      document.size() + length < text.size()) {
+    throw out_of_range("Edit range is outside of document");
+  }
+  // Transcoding would move the edit range
+  if (detectEncoding(document.data(), document.size()) != Encoding::UTF_8) {
+    throw invalid_argument("Edits with a range require UTF-8 documents");
+  }
+
+  // Edits in front of the first top level entry might change the type of
+  // the whole document.
+  if (entries.empty() || offset < entries.front().begin) {
+    return reload(move(document));
+  }
+
+  // We reparse all entries that overlap with the edit. If the edit starts
+  // exactly at the beginning of an entry, then it might also extend the
+  // previous entry.
+  auto after = [](size_t position, Entry const &entry) {
+    return position < entry.begin;
+  };
+  size_t first = static_cast<size_t>(
+      std::upper_bound(entries.begin(), entries.end(), offset, after) -
+      entries.begin() - 1);
+  if (first > 0 && entries[first].begin == offset) {
+    first--;
+  }
+  size_t last = static_cast<size_t>(
+      std::upper_bound(entries.begin(), entries.end(), offset + length,
+                       after) -
+      entries.begin() - 1);
+
+  size_t begin = entries[first].begin;
+  size_t end = last + 1 < entries.size() ? entries[last + 1].begin
+                                         : text.size();
+  size_t updatedEnd = end + document.size() - text.size();
+
+  Parsed parsed;
+  try {
+    parsed = parse(parent, options, document.data() + begin,
+                   updatedEnd - begin, begin);
+  } catch (std::exception const &) {
+    // The changed entries might only be valid as part of the whole document
+    return reload(move(document));
+  }
+
+  bool aligned = std::all_of(parsed.starts.begin(), parsed.starts.end(),
+                             [this](std::pair<size_t, size_t> const &start) {
+                               return start.second == indentation;
+                             });
+  if (!parsed.mapping || !aligned) {
+    return reload(move(document));
+  }
+
+  // If the updated text does not start with an entry, then the remaining
+  // lines (e.g. empty lines) might belong to the value of the previous entry.
+  bool detached =
+      parsed.starts.empty() || parsed.starts.front().first != begin;
+  if (first > 0 && detached) {
+    return reload(move(document));
+  }
+
+  KeySet before;
+  for (size_t entry = first; entry <= last; entry++) {
+    before.append(entries[entry].keys);
+  }
+  Changes changes = difference(before, parsed.keys);
+
+  // The parser only counted the keys of the changed entries
+  size_t total = static_cast<size_t>(keys.size() - changes.removed.size() +
+                                     changes.added.size());
+  if (total > options.limits.maximumKeys) {
+    throw yaypeg::limit_error("Number of keys exceeds maximum of " +
+                              std::to_string(options.limits.maximumKeys));
+  }
+
+  for (auto key : changes.removed) {
+    keys.lookup(key, KDB_O_POP);
+  }
+  for (auto key : changes.changed) {
+    keys.lookup(key, KDB_O_POP);
+  }
+  keys.append(changes.added);
+  keys.append(changes.changed);
+
+  vector<Entry> updated;
+  updated.reserve(entries.size() - (last - first + 1) + parsed.starts.size());
+  for (size_t entry = 0; entry < first; entry++) {
+    updated.push_back(move(entries[entry]));
+  }
+  for (size_t entry = 0; entry < parsed.starts.size(); entry++) {
+    updated.push_back(Entry{parsed.starts[entry].first, parsed.entries[entry]});
+  }
+  for (size_t entry = last + 1; entry < entries.size(); entry++) {
+    entries[entry].begin += document.size();
+    entries[entry].begin -= text.size();
+    updated.push_back(move(entries[entry]));
+  }
+  entries = move(updated);
+  text = move(document);
+
+  return changes;
+}
+
+/**
+ * @brief This method returns the key set of the current document.
+ *
+ * @return A key set containing the converted data of the current document
+ */
+KeySet IncrementalParser::getKeySet() const { return keys; }
+
+} // namespace yaypeg
@@ -0,0 +1,155 @@
+/**
+ * @file
+ *
+ * @brief This file contains the declaration of a parser that updates the key
+ *        set of a YAML document incrementally.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_INCREMENTAL_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_INCREMENTAL_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+
+#include <kdb.hpp>
+
+#include "options.hpp"
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This class converts a YAML document and updates the result after
+ *        the document changed.
+ *
+ * If the document is a block mapping, then the parser remembers where each
+ * top level entry of the mapping starts. After an edit the parser only parses
+ * the top level entries that overlap with the changed text. For all other
+ * documents, and if the changed entries do not parse on their own, the
+ * parser converts the whole document again.
+ */
+class IncrementalParser {
+public:
+  /**
+   * @brief This struct stores the difference between two key sets.
+   */
+  struct Changes {
+    /** @brief This key set contains keys that did not exist before. */
+    kdb::KeySet added;
+    /** @brief This key set contains keys that do not exist anymore. */
+    kdb::KeySet removed;
+    /** @brief This key set contains the new version of keys whose value or
+     *         metadata changed. */
+    kdb::KeySet changed;
+  };
+
+private:
+  /**
+   * @brief This struct stores information about a top level entry of a block
+   *        mapping.
+   */
+  struct Entry {
+    /** @brief This number stores the offset of the line that contains the
+     *         start of the entry. */
+    size_t begin;
+    /** @brief This key set contains the keys created for this entry. */
+    kdb::KeySet keys;
+  };
+
+  /** @brief This key specifies the parent of all converted keys. */
+  kdb::Key parent;
+
+  /** @brief This variable stores the options of all conversions. */
+  Options options;
+
+  /** @brief This variable stores the text of the current document. */
+  std::string text;
+
+  /** @brief This key set stores the converted data of `text`. */
+  kdb::KeySet keys;
+
+  /** @brief This vector stores the top level entries of the document. It is
+   *         empty if the document is not a block mapping. */
+  std::vector<Entry> entries;
+
+  /** @brief This number stores the indentation of the top level entries. */
+  size_t indentation = 0;
+
+  /**
+   * @brief This method converts the whole document again.
+   *
+   * @param document This argument stores the new text of the document.
+   *
+   * @return The difference between the old and the new key set
+   */
+  Changes reload(std::string document);
+
+public:
+  /**
+   * @brief This constructor creates a parser for an empty document.
+   *
+   * @param parentKey This key specifies the parent of all keys the parser
+   *                  creates.
+   * @param settings This argument specifies options for the conversions.
+   *                 The limits apply to each update.
+   */
+  IncrementalParser(kdb::Key const &parentKey,
+                    Options const &settings = Options{});
+
+  /**
+   * @brief This method replaces the current document with the given text.
+   *
+   * The method converts UTF-16 and UTF-32 documents to UTF-8 first.
+   *
+   * @param document This argument stores the new text of the document.
+   *
+   * @throws parse_error if `document` does not contain (supported) YAML data.
+   *         In this case the state of the parser does not change.
+   * @throws limit_error if the conversion exceeds one of the limits stored
+   *         in the options of the parser. In this case the state of the
+   *         parser does not change.
+   *
+   * @return The difference between the old and the new key set
+   */
+  Changes update(std::string document);
+
+  /**
+   * @brief This method replaces the current document with the given text.
+   *
+   * Use this method if you already know which part of the document changed.
+   * Since the offsets refer to bytes of the document, the method only
+   * accepts UTF-8 documents.
+   *
+   * @param document This argument stores the new text of the document.
+   * @param offset This number specifies the start of the edit in the old
+   *               document.
+   * @param length This number specifies how many bytes of the old document,
+   *               starting at `offset`, the edit replaced.
+   *
+   * @throws std::invalid_argument if `document` is not encoded in UTF-8
+   * @throws parse_error if `document` does not contain (supported) YAML data.
+   *         In this case the state of the parser does not change.
+   * @throws limit_error if the conversion exceeds one of the limits stored
+   *         in the options of the parser. In this case the state of the
+   *         parser does not change.
+   *
+   * @return The difference between the old and the new key set
+   */
+  Changes update(std::string document, size_t offset, size_t length);
+
+  /**
+   * @brief This method returns the key set of the current document.
+   *
+   * @return A key set containing the converted data of the current document
+   */
+  kdb::KeySet getKeySet() const;
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_INCREMENTAL_HPP
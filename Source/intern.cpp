@@ -0,0 +1,99 @@
+/**
+ * @file
+ *
+ * @brief This file contains a table that deduplicates converted scalars.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <utility>
+
+#include "intern.hpp"
+#include "scalar.hpp"
+
+using std::string;
+using std::string_view;
+
+// -- Constants ----------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief This constant estimates the memory the table needs for an entry in
+ *        addition to its texts: two strings in the storage and a node of the
+ *        hash map.
+ */
+constexpr size_t entryOverhead =
+    2 * sizeof(string) + 2 * sizeof(string_view) + 2 * sizeof(void *);
+
+} // namespace
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This constructor creates an empty table.
+ *
+ * @param maximumBytes This number specifies how many bytes (see
+ *                     `Statistics::bytesStored`) the table stores at most.
+ */
+InternTable::InternTable(size_t maximumBytes) noexcept
+    : capacity{maximumBytes} {}
+
+/**
+ * @brief This method returns the converted value of the given scalar.
+ *
+ * @param text This argument stores the text of the scalar as it appears in
+ *             the YAML input.
+ * @param buffer The method stores the value in this variable, if the table is
+ *               full and does not contain `text`.
+ *
+ * @return A view of the null terminated value of `text`. The view stays valid
+ *         until the table is cleared or destroyed, or until the caller
+ *         changes `buffer`.
+ */
+string_view InternTable::intern(string_view text, string &buffer) {
+  usage.lookups++;
+  auto entry = table.find(text);
+  if (entry != table.end()) {
+    usage.hits++;
+    usage.bytesAvoided += entry->second.size() + 1;
+    return entry->second;
+  }
+
+  buffer = scalarToText(text);
+  size_t bytes = text.size() + buffer.size() + 2 + entryOverhead;
+  if (usage.bytesStored + bytes > capacity) {
+    usage.rejected++;
+    return buffer;
+  }
+  string const &original = storage.emplace_back(text);
+  string const &value = storage.emplace_back(std::move(buffer));
+  usage.entries++;
+  usage.bytesStored += bytes;
+  table.emplace(original, value);
+  return value;
+}
+
+/**
+ * @brief This method returns usage information about the table.
+ *
+ * @return Information about lookups and memory usage of the table
+ */
+InternTable::Statistics InternTable::statistics() const noexcept {
+  return usage;
+}
+
+/**
+ * @brief This method removes all entries from the table.
+ */
+void InternTable::clear() {
+  table.clear();
+  storage.clear();
+  usage = Statistics{};
+}
+
+} // namespace yaypeg
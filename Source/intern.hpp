@@ -0,0 +1,136 @@
+/**
+ * @file
+ *
+ * @brief This file contains a table that deduplicates converted scalars.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_INTERN_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_INTERN_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This class maps the text of small scalars to their converted value.
+ *
+ * Documents such as lists of records repeat the same key names and values
+ * (`name`, `port`, `true`, …) many times. The table converts each distinct
+ * text only once and hands out views of the stored result afterwards. A
+ * single table can be used for many conversions, e.g. to share the entries
+ * across all files of a batch. Once the stored entries reach the capacity of
+ * the table, it converts new scalars without storing them.
+ */
+class InternTable {
+public:
+  /**
+   * @brief This struct stores usage information of an intern table.
+   */
+  struct Statistics {
+    /** @brief This number stores how often the parser requested a scalar. */
+    size_t lookups = 0;
+    /** @brief This number stores how many requests the table answered with
+     *         an existing entry. */
+    size_t hits = 0;
+    /** @brief This number stores how many distinct scalars the table
+     *         stores. */
+    size_t entries = 0;
+    /** @brief This number stores how many scalars the table converted
+     *         without storing them, since it was full. */
+    size_t rejected = 0;
+    /** @brief This number stores the size of all stored texts and the
+     *         (estimated) overhead of their entries in bytes. */
+    size_t bytesStored = 0;
+    /** @brief This number stores the size of all temporary values the
+     *         listener did not need to create, since the table already
+     *         contained them, in bytes. */
+    size_t bytesAvoided = 0;
+  };
+
+  /**
+   * @brief This constant specifies the maximum length of scalars the table
+   *        stores. Longer scalars rarely repeat.
+   */
+  static constexpr size_t maximumLength = 64;
+
+  /**
+   * @brief This constant specifies the default capacity of a table in bytes.
+   */
+  static constexpr size_t defaultCapacity = 4 * 1024 * 1024;
+
+private:
+  /** @brief This number specifies how many bytes the table stores at
+   *         most. */
+  size_t capacity;
+
+  /** @brief This container stores the original and converted texts. Unlike
+   *         a vector it never moves existing elements. */
+  std::deque<std::string> storage;
+
+  /** @brief This map assigns the converted value to the text of a scalar. */
+  std::unordered_map<std::string_view, std::string_view> table;
+
+  /** @brief This variable stores usage information about the table. */
+  Statistics usage;
+
+public:
+  /**
+   * @brief This constructor creates an empty table.
+   *
+   * @param maximumBytes This number specifies how many bytes (see
+   *                     `Statistics::bytesStored`) the table stores at most.
+   */
+  explicit InternTable(size_t maximumBytes = defaultCapacity) noexcept;
+
+  /**
+   * @brief This method returns the converted value of the given scalar.
+   *
+   * @param text This argument stores the text of the scalar as it appears in
+   *             the YAML input.
+   * @param buffer The method stores the value in this variable, if the table
+   *               is full and does not contain `text`.
+   *
+   * @return A view of the null terminated value of `text`. The view stays
+   *         valid until the table is cleared or destroyed, or until the
+   *         caller changes `buffer`.
+   */
+  std::string_view intern(std::string_view text, std::string &buffer);
+
+  /**
+   * @brief This method checks if the table would store the given scalar.
+   *
+   * @param text This argument stores the text of the scalar.
+   *
+   * @retval true If `intern` deduplicates `text`
+   * @retval false Otherwise
+   */
+  static bool accepts(std::string_view text) noexcept {
+    return text.size() <= maximumLength;
+  }
+
+  /**
+   * @brief This method returns usage information about the table.
+   *
+   * @return Information about lookups and memory usage of the table
+   */
+  Statistics statistics() const noexcept;
+
+  /**
+   * @brief This method removes all entries from the table.
+   */
+  void clear();
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_INTERN_HPP
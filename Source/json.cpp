@@ -0,0 +1,381 @@
+/**
+ * @file
+ *
+ * @brief This file contains a fast parser for JSON compatible YAML data.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <string_view>
+
+#include "json.hpp"
+
+// -- Class --------------------------------------------------------------------
+
+namespace {
+
+using std::string_view;
+
+using yaypeg::Listener;
+
+/**
+ * @brief This class parses JSON data using recursive descent.
+ *
+ * Scalars are passed to the listener with their original text (including the
+ * quotes of strings). This way the listener handles them exactly like the
+ * corresponding YAML flow scalars.
+ */
+class JsonParser {
+  /** @brief This variable stores the current position in the input. */
+  char const *position;
+
+  /** @brief This variable stores the end of the input. */
+  char const *end;
+
+  /** @brief The parser calls methods of this listener. */
+  Listener &listener;
+
+  /** @brief This number stores the nesting depth of the current value. */
+  size_t depth = 0;
+
+  /** @brief This constant specifies the maximum nesting depth. */
+  static constexpr size_t maximumDepth = 1000;
+
+  /**
+   * @brief This method skips whitespace characters.
+   */
+  void whitespace() noexcept {
+    while (position < end && (*position == ' ' || *position == '\n' ||
+                              *position == '\r' || *position == '\t')) {
+      position++;
+    }
+  }
+
+  /**
+   * @brief This method consumes the given character if it is the next
+   *        character of the input.
+   *
+   * @param character This argument specifies the expected character.
+   *
+   * @retval true If the method consumed `character`
+   * @retval false Otherwise
+   */
+  bool consume(char character) noexcept {
+    if (position < end && *position == character) {
+      position++;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief This method checks if the given character is a decimal digit.
+   *
+   * @param character This argument stores the character the method checks.
+   *
+   * @retval true If `character` is a digit
+   * @retval false Otherwise
+   */
+  static bool isDigit(char character) noexcept {
+    return character >= '0' && character <= '9';
+  }
+
+  /**
+   * @brief This method checks if the given character is a hexadecimal digit.
+   *
+   * @param character This argument stores the character the method checks.
+   *
+   * @retval true If `character` is a hexadecimal digit
+   * @retval false Otherwise
+   */
+  static bool isHexDigit(char character) noexcept {
+    return isDigit(character) || (character >= 'a' && character <= 'f') ||
+           (character >= 'A' && character <= 'F');
+  }
+
+  /**
+   * @brief This method parses a JSON string.
+   *
+   * @param text The method stores a view of the string including the quotes
+   *             in this variable.
+   *
+   * @retval true If the input contains a valid string at the current position
+   * @retval false Otherwise
+   */
+  bool quoted(string_view &text) {
+    char const *start = position;
+    if (!consume('"')) {
+      return false;
+    }
+    while (position < end) {
+      auto character = static_cast<unsigned char>(*position);
+      if (character == '"') {
+        position++;
+        text = string_view{start, static_cast<size_t>(position - start)};
+        return true;
+      }
+      if (character < 0x20) {
+        return false;
+      }
+      if (character != '\\') {
+        position++;
+        continue;
+      }
+
+      if (++position >= end) {
+        return false;
+      }
+      switch (*position++) {
+      case '"':
+      case '\\':
+      case '/':
+      case 'b':
+      case 'f':
+      case 'n':
+      case 'r':
+      case 't':
+        break;
+      case 'u':
+        for (int digit = 0; digit < 4; digit++, position++) {
+          if (position >= end || !isHexDigit(*position)) {
+            return false;
+          }
+        }
+        break;
+      default:
+        return false;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief This method parses a JSON number.
+   *
+   * @retval true If the input contains a valid number at the current position
+   * @retval false Otherwise
+   */
+  bool number() noexcept {
+    consume('-');
+    if (consume('0')) {
+    } else if (position < end && isDigit(*position)) {
+      while (position < end && isDigit(*position)) {
+        position++;
+      }
+    } else {
+      return false;
+    }
+
+    if (consume('.')) {
+      if (position >= end || !isDigit(*position)) {
+        return false;
+      }
+      while (position < end && isDigit(*position)) {
+        position++;
+      }
+    }
+
+    if (consume('e') || consume('E')) {
+      if (!consume('+')) {
+        consume('-');
+      }
+      if (position >= end || !isDigit(*position)) {
+        return false;
+      }
+      while (position < end && isDigit(*position)) {
+        position++;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief This method consumes the given literal (`true`, `false` or
+   *        `null`).
+   *
+   * @param literal This argument stores the expected literal.
+   *
+   * @retval true If the input contains `literal` at the current position
+   * @retval false Otherwise
+   */
+  bool keyword(string_view literal) noexcept {
+    if (static_cast<size_t>(end - position) < literal.size() ||
+        literal.compare(0, literal.size(), position, literal.size()) != 0) {
+      return false;
+    }
+    position += literal.size();
+    return true;
+  }
+
+  /**
+   * @brief This method parses a JSON object.
+   *
+   * @retval true If the input contains a valid object at the current position
+   * @retval false Otherwise
+   */
+  bool object() {
+    position++; // Skip `{`
+    whitespace();
+    if (consume('}')) {
+      return true;
+    }
+
+    string_view key;
+    do {
+      whitespace();
+      if (!quoted(key)) {
+        return false;
+      }
+      whitespace();
+      if (!consume(':')) {
+        return false;
+      }
+      listener.exitKey(key);
+      if (!value()) {
+        return false;
+      }
+      listener.exitPair();
+    } while (consume(','));
+
+    return consume('}');
+  }
+
+  /**
+   * @brief This method parses a JSON array.
+   *
+   * @retval true If the input contains a valid array at the current position
+   * @retval false Otherwise
+   */
+  bool array() {
+    position++; // Skip `[`
+    listener.enterSequence();
+    whitespace();
+    if (!consume(']')) {
+      do {
+        listener.enterElement();
+        if (!value()) {
+          return false;
+        }
+        listener.exitElement();
+      } while (consume(','));
+
+      if (!consume(']')) {
+        return false;
+      }
+    }
+    listener.exitSequence();
+    return true;
+  }
+
+  /**
+   * @brief This method parses a JSON value and the surrounding whitespace.
+   *
+   * @retval true If the input contains a valid value at the current position
+   * @retval false Otherwise
+   */
+  bool value() {
+    whitespace();
+    if (position >= end) {
+      return false;
+    }
+
+    bool valid;
+    char const *start = position;
+    switch (*position) {
+    case '{':
+    case '[':
+      if (++depth > maximumDepth) {
+        return false;
+      }
+      valid = *position == '{' ? object() : array();
+      depth--;
+      break;
+    case '"': {
+      string_view text;
+      valid = quoted(text);
+      if (valid) {
+        listener.exitValue(text);
+      }
+      break;
+    }
+    default:
+      valid = keyword("true") || keyword("false") || keyword("null") ||
+              number();
+      if (valid) {
+        listener.exitValue(
+            string_view{start, static_cast<size_t>(position - start)});
+      }
+    }
+
+    whitespace();
+    return valid;
+  }
+
+public:
+  /**
+   * @brief This constructor creates a parser for the given data.
+   *
+   * @param data This variable stores the start of the JSON data.
+   * @param size This number specifies the length of `data` in bytes.
+   * @param handler The parser calls the methods of this listener.
+   */
+  JsonParser(char const *data, size_t size, Listener &handler)
+      : position{data}, end{data + size}, listener{handler} {}
+
+  /**
+   * @brief This method parses a complete JSON document.
+   *
+   * @retval true If the input contains a single valid JSON value
+   * @retval false Otherwise
+   */
+  bool document() { return value() && position == end; }
+};
+
+} // namespace
+
+// -- Functions ----------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This function checks if the given data might be a JSON document.
+ *
+ * The check only looks at the first character after leading whitespace. It is
+ * therefore cheap, but does not guarantee that `parseJson` succeeds.
+ *
+ * @param data This variable stores the start of the data.
+ * @param size This number specifies the length of `data` in bytes.
+ *
+ * @retval true If the data starts with a JSON object or array
+ * @retval false Otherwise
+ */
+bool looksLikeJson(char const *data, size_t size) noexcept {
+  for (char const *end = data + size; data < end; data++) {
+    if (*data != ' ' && *data != '\n' && *data != '\r' && *data != '\t') {
+      return *data == '{' || *data == '[';
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief This function parses a JSON document and calls the methods of the
+ *        given listener in the same order as the tree walker would for the
+ *        equivalent YAML data.
+ *
+ * @param data This variable stores the start of the JSON data.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param listener The function calls the methods of this listener.
+ *
+ * @retval true If `data` contains a valid JSON document
+ * @retval false If `data` is not valid JSON. In this case the state of
+ *               `listener` is unspecified and the caller should parse the data
+ *               with the YAML grammar instead.
+ */
+bool parseJson(char const *data, size_t size, Listener &listener) {
+  return JsonParser{data, size, listener}.document();
+}
+
+} // namespace yaypeg
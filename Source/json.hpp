@@ -0,0 +1,54 @@
+/**
+ * @file
+ *
+ * @brief This file contains a fast parser for JSON compatible YAML data.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_JSON_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_JSON_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstddef>
+
+#include "listener.hpp"
+
+// -- Functions ----------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This function checks if the given data might be a JSON document.
+ *
+ * The check only looks at the first character after leading whitespace. It is
+ * therefore cheap, but does not guarantee that `parseJson` succeeds.
+ *
+ * @param data This variable stores the start of the data.
+ * @param size This number specifies the length of `data` in bytes.
+ *
+ * @retval true If the data starts with a JSON object or array
+ * @retval false Otherwise
+ */
+bool looksLikeJson(char const *data, size_t size) noexcept;
+
+/**
+ * @brief This function parses a JSON document and calls the methods of the
+ *        given listener in the same order as the tree walker would for the
+ *        equivalent YAML data.
+ *
+ * @param data This variable stores the start of the JSON data.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param listener The function calls the methods of this listener.
+ *
+ * @retval true If `data` contains a valid JSON document
+ * @retval false If `data` is not valid JSON. In this case the state of
+ *               `listener` is unspecified and the caller should parse the
+ *               data with the YAML grammar instead.
+ */
+bool parseJson(char const *data, size_t size, Listener &listener);
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_JSON_HPP
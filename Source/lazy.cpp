@@ -0,0 +1,276 @@
+/**
+ * @file
+ *
+ * @brief This file contains a key set that converts scalars on first access.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include "convert.hpp"
+#include "encoding.hpp"
+#include "lazy.hpp"
+#include "listener.hpp"
+#include "scalar.hpp"
+
+using kdb::Key;
+using kdb::KeySet;
+using std::string;
+using std::string_view;
+using std::unordered_map;
+
+// -- Class --------------------------------------------------------------------
+
+namespace {
+
+using yaypeg::LazyKeySet;
+using yaypeg::Listener;
+using yaypeg::Options;
+using yaypeg::ScalarStyle;
+using yaypeg::styleOf;
+
+/**
+ * @brief This listener records the location of scalars instead of copying
+ *        them into key values.
+ */
+class LazyListener : public Listener {
+  /** @brief This variable stores the start of the YAML input. */
+  char const *base;
+
+  /** @brief The listener stores the location of every value in this map. */
+  unordered_map<ckdb::Key *, LazyKeySet::Scalar> &pending;
+
+public:
+  /**
+   * @brief This constructor creates a listener for the given input.
+   *
+   * @param parent This argument specifies the parent key of the key set this
+   *               listener produces.
+   * @param input This variable stores the start of the YAML input.
+   * @param scalars The listener stores the location of values in this map.
+   * @param settings This argument specifies options for the conversion.
+   */
+  LazyListener(Key const &parent, char const *input,
+               unordered_map<ckdb::Key *, LazyKeySet::Scalar> &scalars,
+               Options const &settings)
+      : Listener{parent, settings}, base{input}, pending{scalars} {}
+
+  /**
+   * @brief This function will be called after the walker exits a value node.
+   *
+   * @param text This variable contains the text of the value as it appears
+   *             in the input.
+   */
+  void exitValue(string_view text) override {
+    // Converting a block scalar requires the indentation the parser
+    // detected. We therefore convert block scalars right away.
+    ScalarStyle style = styleOf(text);
+    if (style == ScalarStyle::LITERAL || style == ScalarStyle::FOLDED) {
+      Listener::exitValue(text);
+      return;
+    }
+
+    checkScalar(text);
+    Key key = parents.top();
+    addKey(key);
+    // Typed scalars have short canonical values. We store them right away.
+    if (!setTypedValue(key, text)) {
+      pending[key.getKey()] = LazyKeySet::Scalar{
+          static_cast<size_t>(text.data() - base), text.size()};
+    }
+  }
+
+  /**
+   * @brief This method adds a key to the key set of the listener.
+   *
+   * A key with the same name as an existing key (e.g. a duplicate key in a
+   * mapping) replaces and releases the existing key. We therefore forget the
+   * scalar of the replaced key first.
+   *
+   * @param key This argument stores the key this method adds.
+   *
+   * @throws limit_error if the key set already contains the maximum number
+   *         of keys
+   */
+  void addKey(Key const &key) override {
+    ckdb::Key *replaced =
+        ckdb::ksLookup(keys.getKeySet(), key.getKey(), KDB_O_NONE);
+    if (replaced && replaced != key.getKey()) {
+      pending.erase(replaced);
+    }
+    Listener::addKey(key);
+  }
+
+  /**
+   * @brief This method copies a key of an anchored node for an alias.
+   *
+   * @param source This argument stores the key of the anchored node.
+   * @param name This text specifies the name of the copy.
+   *
+   * @return A copy of `source` called `name` that refers to the same scalar
+   */
+  Key copyKey(Key const &source, string const &name) override {
+    Key copy = Listener::copyKey(source, name);
+    auto scalar = pending.find(source.getKey());
+    if (scalar != pending.end()) {
+      LazyKeySet::Scalar location = scalar->second;
+      pending[copy.getKey()] = location;
+    }
+    return copy;
+  }
+
+  /**
+   * @brief This method removes all keys the listener created so far.
+   */
+  void reset() override {
+    Listener::reset();
+    pending.clear();
+  }
+};
+
+} // namespace
+
+namespace yaypeg {
+
+/**
+ * @brief This method converts the YAML input to keys without values.
+ *
+ * @param parent This key specifies the parent of all keys the method
+ *               creates.
+ * @param size This number specifies the length of the input.
+ * @param source This text describes the origin of the input.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @throws parse_error if the input does not contain (supported) YAML data
+ */
+void LazyKeySet::load(Key const &parent, size_t size, string const &source,
+                      Options const &options) {
+  // The listener stores offsets into the input, so the key set keeps the
+  // converted version of UTF-16 and UTF-32 input.
+  Encoding encoding = detectEncoding(data, size);
+  if (encoding != Encoding::UTF_8) {
+    transcoded = std::make_unique<string>(toUtf8(data, size, encoding, source));
+    data = transcoded->data();
+    size = transcoded->size();
+  }
+
+  LazyListener listener{parent, data, pending, options};
+  convertBuffer(listener, data, size, source);
+  keys = listener.getKeySet();
+}
+
+/**
+ * @brief This method returns the text of the given scalar.
+ *
+ * @param scalar This argument specifies the location of the scalar.
+ *
+ * @return The text of `scalar` as it appears in the input
+ */
+string_view LazyKeySet::text(Scalar const &scalar) const noexcept {
+  return string_view{data + scalar.offset, scalar.length};
+}
+
+/**
+ * @brief This constructor maps the given YAML file into memory and converts
+ *        its structure.
+ *
+ * @param parent This key specifies the parent of all keys the constructor
+ *               creates.
+ * @param filename This parameter stores the path of the YAML file.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @throws std::system_error if the constructor is unable to read `filename`
+ * @throws parse_error if the file does not contain (supported) YAML data
+ */
+LazyKeySet::LazyKeySet(Key const &parent, string const &filename,
+                       Options const &options)
+    : file{new MappedFile{filename}}, data{file->data()} {
+  load(parent, file->size(), filename, options);
+}
+
+/**
+ * @brief This constructor converts the structure of the given YAML data.
+ *
+ * @pre The caller has to keep `input` alive as long as this object exists.
+ *
+ * @param parent This key specifies the parent of all keys the constructor
+ *               creates.
+ * @param input This variable stores the start of the YAML data.
+ * @param size This number specifies the length of `input` in bytes.
+ * @param source This text describes the origin of `input`. The constructor
+ *               uses it in error messages.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @throws parse_error if the buffer does not contain (supported) YAML data
+ */
+LazyKeySet::LazyKeySet(Key const &parent, char const *input, size_t size,
+                       string const &source, Options const &options)
+    : data{input} {
+  load(parent, size, source, options);
+}
+
+/**
+ * @brief This method returns the value of the key with the given name.
+ *
+ * Values that do not contain escape sequences or line breaks point directly
+ * into the input. The method converts all other values and stores the result
+ * in the corresponding key.
+ *
+ * @param name This parameter specifies the name of the key.
+ *
+ * @return The value of the key or an empty view with data `nullptr` if the
+ *         key set does not contain a key called `name`. The view stays valid
+ *         until the value of the key changes.
+ */
+string_view LazyKeySet::get(string const &name) {
+  ckdb::Key *key =
+      ckdb::ksLookupByName(keys.getKeySet(), name.c_str(), KDB_O_NONE);
+  if (!key) {
+    return string_view{};
+  }
+
+  auto scalar = pending.find(key);
+  if (scalar != pending.end()) {
+    string_view raw = text(scalar->second);
+    if (isVerbatim(raw)) {
+      return scalarContent(raw);
+    }
+    ckdb::keySetString(key, scalarToText(raw).c_str());
+    pending.erase(scalar);
+  }
+
+  ssize_t size = ckdb::keyGetValueSize(key);
+  return string_view{ckdb::keyString(key),
+                     size > 0 ? static_cast<size_t>(size - 1) : 0};
+}
+
+/**
+ * @brief This method returns the number of keys in the key set.
+ *
+ * @return The number of keys in the key set
+ */
+size_t LazyKeySet::size() const { return static_cast<size_t>(keys.size()); }
+
+/**
+ * @brief This method returns the number of keys without value.
+ *
+ * @return The number of scalars the key set did not convert yet
+ */
+size_t LazyKeySet::unconverted() const noexcept { return pending.size(); }
+
+/**
+ * @brief This method converts all remaining scalars and returns the complete
+ *        key set.
+ *
+ * @return A key set containing the data of the YAML document
+ */
+KeySet LazyKeySet::getKeySet() {
+  for (auto const &scalar : pending) {
+    ckdb::keySetString(scalar.first, scalarToText(text(scalar.second)).c_str());
+  }
+  pending.clear();
+  return keys;
+}
+
+} // namespace yaypeg
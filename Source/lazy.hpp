@@ -0,0 +1,164 @@
+/**
+ * @file
+ *
+ * @brief This file contains a key set that converts scalars on first access.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_LAZY_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_LAZY_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <kdb.hpp>
+
+#include "file.hpp"
+#include "options.hpp"
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This class stores the keys of a YAML document, but only converts
+ *        the text of a scalar to a key value when a consumer reads it.
+ *
+ * Until then the key set only stores the location of the scalar in the input.
+ * The input therefore has to stay in memory: The class either maps the YAML
+ * file itself, or relies on the caller to keep the input buffer alive.
+ */
+class LazyKeySet {
+public:
+  /**
+   * @brief This struct stores the location of a scalar in the input.
+   */
+  struct Scalar {
+    /** @brief This number stores the start of the scalar text. */
+    size_t offset;
+    /** @brief This number stores the length of the scalar text (including
+     *         quotes). */
+    size_t length;
+  };
+
+private:
+  /** @brief This variable stores the mapped YAML file, if the key set reads
+   *         its input from a file. */
+  std::unique_ptr<MappedFile> file;
+
+  /** @brief This variable stores the UTF-8 version of UTF-16 or UTF-32
+   *         input. */
+  std::unique_ptr<std::string> transcoded;
+
+  /** @brief This variable stores the start of the YAML input. */
+  char const *data;
+
+  /** @brief This key set stores all keys of the document. */
+  kdb::KeySet keys;
+
+  /** @brief This map stores the scalars of all keys without value. */
+  std::unordered_map<ckdb::Key *, Scalar> pending;
+
+  /**
+   * @brief This method converts the YAML input to keys without values.
+   *
+   * @param parent This key specifies the parent of all keys the method
+   *               creates.
+   * @param size This number specifies the length of the input.
+   * @param source This text describes the origin of the input.
+   * @param options This argument specifies options for the conversion.
+   *
+   * @throws parse_error if the input does not contain (supported) YAML data
+   */
+  void load(kdb::Key const &parent, size_t size, std::string const &source,
+            Options const &options);
+
+  /**
+   * @brief This method returns the text of the given scalar.
+   *
+   * @param scalar This argument specifies the location of the scalar.
+   *
+   * @return The text of `scalar` as it appears in the input
+   */
+  std::string_view text(Scalar const &scalar) const noexcept;
+
+public:
+  /**
+   * @brief This constructor maps the given YAML file into memory and converts
+   *        its structure.
+   *
+   * @param parent This key specifies the parent of all keys the constructor
+   *               creates.
+   * @param filename This parameter stores the path of the YAML file.
+   * @param options This argument specifies options for the conversion.
+   *
+   * @throws std::system_error if the constructor is unable to read `filename`
+   * @throws parse_error if the file does not contain (supported) YAML data
+   */
+  LazyKeySet(kdb::Key const &parent, std::string const &filename,
+             Options const &options = Options{});
+
+  /**
+   * @brief This constructor converts the structure of the given YAML data.
+   *
+   * @pre The caller has to keep `input` alive as long as this object exists.
+   *
+   * @param parent This key specifies the parent of all keys the constructor
+   *               creates.
+   * @param input This variable stores the start of the YAML data.
+   * @param size This number specifies the length of `input` in bytes.
+   * @param source This text describes the origin of `input`. The
+   *               constructor uses it in error messages.
+   * @param options This argument specifies options for the conversion.
+   *
+   * @throws parse_error if the buffer does not contain (supported) YAML data
+   */
+  LazyKeySet(kdb::Key const &parent, char const *input, size_t size,
+             std::string const &source, Options const &options = Options{});
+
+  /**
+   * @brief This method returns the value of the key with the given name.
+   *
+   * Values that do not contain escape sequences or line breaks point
+   * directly into the input. The method converts all other values and
+   * stores the result in the corresponding key.
+   *
+   * @param name This parameter specifies the name of the key.
+   *
+   * @return The value of the key or an empty view with data `nullptr` if
+   *         the key set does not contain a key called `name`. The view stays
+   *         valid until the value of the key changes.
+   */
+  std::string_view get(std::string const &name);
+
+  /**
+   * @brief This method returns the number of keys in the key set.
+   *
+   * @return The number of keys in the key set
+   */
+  size_t size() const;
+
+  /**
+   * @brief This method returns the number of keys without value.
+   *
+   * @return The number of scalars the key set did not convert yet
+   */
+  size_t unconverted() const noexcept;
+
+  /**
+   * @brief This method converts all remaining scalars and returns the
+   *        complete key set.
+   *
+   * @return A key set containing the data of the YAML document
+   */
+  kdb::KeySet getKeySet();
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_LAZY_HPP
@@ -0,0 +1,428 @@
+/**
+ * @file
+ *
+ * @brief This file contains the implementation of the C interface of the
+ *        YAy PEG library.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdio>
+#include <system_error>
+
+#include "convert.hpp"
+#include "emitter.hpp"
+#include "libyaypeg.h"
+#include "memory.hpp"
+#include "snapshot.hpp"
+
+#define TAO_PEGTL_NAMESPACE yaypeg
+
+#include <tao/pegtl.hpp>
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using ckdb::YaypegError;
+using ckdb::YaypegErrorCode;
+using ckdb::YaypegMemoryUsage;
+using ckdb::YaypegOptions;
+
+/**
+ * @brief This function stores information about the result of a conversion in
+ *        `error`.
+ *
+ * @param error This parameter stores the error struct the function updates.
+ *              If `error` is `nullptr`, then the function does nothing.
+ * @param code This argument specifies the kind of the error.
+ * @param message This text describes the error.
+ * @param line This number stores the line of a parse error.
+ * @param column This number stores the column of a parse error.
+ */
+void setError(YaypegError *error, YaypegErrorCode code, char const *message,
+              size_t line = 0, size_t column = 0) {
+  if (!error) {
+    return;
+  }
+  error->code = code;
+  error->line = line;
+  error->column = column;
+  snprintf(error->message, sizeof(error->message), "%s", message);
+}
+
+/**
+ * @brief This function executes a conversion function and translates its
+ *        exceptions to error codes.
+ *
+ * @param keySet The function adds the keys returned by `conversion` to this
+ *               key set.
+ * @param parent This key specifies the parent of all keys `conversion`
+ *               creates.
+ * @param error The function stores information about problems in this
+ *              struct.
+ * @param conversion This function converts YAML data to a key set.
+ *
+ * @retval -1 if there was an error converting the YAML data
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+template <typename Conversion>
+int convert(ckdb::KeySet *keySet, ckdb::Key *parent, YaypegError *error,
+            Conversion conversion) {
+  using ckdb::YAYPEG_ERROR_INPUT;
+  using ckdb::YAYPEG_ERROR_INTERNAL;
+  using ckdb::YAYPEG_ERROR_LIMIT;
+  using ckdb::YAYPEG_ERROR_PARSE;
+  using ckdb::YAYPEG_OK;
+  using std::exception;
+  using std::system_error;
+  using tao::TAO_PEGTL_NAMESPACE::input_error;
+  using yaypeg::limit_error;
+  using tao::TAO_PEGTL_NAMESPACE::parse_error;
+
+  if (!keySet || !parent) {
+    setError(error, YAYPEG_ERROR_INTERNAL, "Missing key set or parent key");
+    return -1;
+  }
+
+  kdb::KeySet keys{keySet};
+  kdb::Key parentKey{parent};
+  int status = -1;
+
+  try {
+    kdb::KeySet converted = conversion(parentKey);
+    status = (converted.size() <= 0) ? 0 : 1;
+    keys.append(converted);
+    setError(error, YAYPEG_OK, "");
+  } catch (input_error const &problem) {
+    setError(error, YAYPEG_ERROR_INPUT, problem.what());
+  } catch (parse_error const &problem) {
+    if (problem.positions.empty()) {
+      setError(error, YAYPEG_ERROR_PARSE, problem.what());
+    } else {
+      auto const &position = problem.positions.front();
+      setError(error, YAYPEG_ERROR_PARSE, problem.what(), position.line,
+               position.byte_in_line + 1);
+    }
+  } catch (system_error const &problem) {
+    setError(error, YAYPEG_ERROR_INPUT, problem.what());
+  } catch (limit_error const &problem) {
+    setError(error, YAYPEG_ERROR_LIMIT, problem.what());
+  } catch (exception const &problem) {
+    setError(error, YAYPEG_ERROR_INTERNAL, problem.what());
+  }
+
+  parentKey.release();
+  keys.release();
+  return status;
+}
+
+/**
+ * @brief This function converts the limits of the C interface to conversion
+ *        options.
+ *
+ * @param limits This struct stores the limits of the C interface. The value
+ *               `nullptr` disables all limits.
+ *
+ * @return Options that contain the given limits
+ */
+yaypeg::Options toOptions(YaypegOptions const *limits) {
+  using std::chrono::milliseconds;
+  using std::chrono::steady_clock;
+
+  yaypeg::Options options;
+  if (!limits) {
+    return options;
+  }
+
+  if (limits->maximumDepth > 0) {
+    options.limits.maximumDepth = limits->maximumDepth;
+  }
+  if (limits->maximumKeys > 0) {
+    options.limits.maximumKeys = limits->maximumKeys;
+  }
+  if (limits->maximumScalarBytes > 0) {
+    options.limits.maximumScalarBytes = limits->maximumScalarBytes;
+  }
+  if (limits->maximumRuleInvocations > 0) {
+    options.limits.maximumRuleInvocations = limits->maximumRuleInvocations;
+  }
+  if (limits->maximumAliasExpansion > 0) {
+    options.limits.maximumAliasExpansion = limits->maximumAliasExpansion;
+  }
+  if (limits->timeoutMilliseconds > 0) {
+    options.limits.deadline =
+        steady_clock::now() + milliseconds{limits->timeoutMilliseconds};
+  }
+  if (limits->cancelled) {
+    auto cancelled = limits->cancelled;
+    auto data = limits->cancelData;
+    options.limits.cancelled = [cancelled, data]() {
+      return cancelled(data) != 0;
+    };
+  }
+  return options;
+}
+
+} // namespace
+
+// -- C Interface --------------------------------------------------------------
+
+namespace ckdb {
+
+using std::string;
+
+/**
+ * @brief This function converts the given YAML file to keys and adds the
+ *        result to `keySet`.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param path This parameter stores the location of the YAML file.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML file
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseFile(KeySet *keySet, Key *parent, char const *path,
+                    YaypegError *error) {
+  return yaypegParseFileWithOptions(keySet, parent, path, nullptr, error);
+}
+
+/**
+ * @brief This function converts the YAML data stored in `buffer` to keys and
+ *        adds the result to `keySet`.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param buffer This variable stores the YAML data. The data does not need to
+ *               be terminated by a null character.
+ * @param size This number specifies the length of `buffer` in bytes.
+ * @param source This text describes the origin of `buffer`. The function uses
+ *               it in error messages. The value `NULL` is allowed.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML data
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseBuffer(KeySet *keySet, Key *parent, char const *buffer,
+                      size_t size, char const *source, YaypegError *error) {
+  return yaypegParseBufferWithOptions(keySet, parent, buffer, size, source,
+                                      nullptr, error);
+}
+
+/**
+ * @brief This function converts the given YAML file to keys and adds the
+ *        result to `keySet` using the given resource limits.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param path This parameter stores the location of the YAML file.
+ * @param options This struct specifies the resource limits of the conversion.
+ *                The value `NULL` disables all limits.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML file
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseFileWithOptions(KeySet *keySet, Key *parent, char const *path,
+                               YaypegOptions const *options,
+                               YaypegError *error) {
+  if (!path) {
+    setError(error, YAYPEG_ERROR_INPUT, "Missing path of input file");
+    return -1;
+  }
+
+  yaypeg::Options settings = toOptions(options);
+  return convert(keySet, parent, error,
+                 [path, &settings](kdb::Key const &parentKey) {
+                   return yaypeg::convertFile(parentKey, path, settings);
+                 });
+}
+
+/**
+ * @brief This function converts the YAML data stored in `buffer` to keys and
+ *        adds the result to `keySet` using the given resource limits.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param buffer This variable stores the YAML data. The data does not need to
+ *               be terminated by a null character.
+ * @param size This number specifies the length of `buffer` in bytes.
+ * @param source This text describes the origin of `buffer`. The function uses
+ *               it in error messages. The value `NULL` is allowed.
+ * @param options This struct specifies the resource limits of the conversion.
+ *                The value `NULL` disables all limits.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML data
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseBufferWithOptions(KeySet *keySet, Key *parent,
+                                 char const *buffer, size_t size,
+                                 char const *source,
+                                 YaypegOptions const *options,
+                                 YaypegError *error) {
+  if (!buffer && size > 0) {
+    setError(error, YAYPEG_ERROR_INPUT, "Missing input buffer");
+    return -1;
+  }
+
+  string origin = source ? source : "buffer";
+  yaypeg::Options settings = toOptions(options);
+  return convert(keySet, parent, error,
+                 [buffer, size, &origin, &settings](kdb::Key const &parentKey) {
+                   return yaypeg::convertBuffer(parentKey, buffer, size,
+                                                origin, settings);
+                 });
+}
+
+/**
+ * @brief This function converts the given YAML file to keys and adds the
+ *        result to `keySet` using the given resource limits. It stores the
+ *        memory usage of the conversion in `usage`.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param path This parameter stores the location of the YAML file.
+ * @param options This struct specifies the resource limits of the conversion.
+ *                The value `NULL` disables all limits.
+ * @param usage The function stores the memory usage of the conversion in this
+ *              struct. The value `NULL` is allowed.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML file
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseFileWithMemoryUsage(KeySet *keySet, Key *parent,
+                                   char const *path,
+                                   YaypegOptions const *options,
+                                   YaypegMemoryUsage *usage,
+                                   YaypegError *error) {
+  if (!path) {
+    setError(error, YAYPEG_ERROR_INPUT, "Missing path of input file");
+    return -1;
+  }
+
+  yaypeg::MemoryUsage memory;
+  yaypeg::Options settings = toOptions(options);
+  settings.memory = &memory;
+  int status = convert(keySet, parent, error,
+                       [path, &settings](kdb::Key const &parentKey) {
+                         return yaypeg::convertFile(parentKey, path, settings);
+                       });
+  if (usage) {
+    *usage = YaypegMemoryUsage{memory.inputBytes,
+                               memory.parserPeakBytes,
+                               memory.treeBytes,
+                               memory.listenerPeakBytes,
+                               memory.keySetBytes,
+                               memory.peakBytes(),
+                               memory.retainedBytes(),
+                               memory.bytesPerInputByte()};
+  }
+  return status;
+}
+
+/**
+ * @brief This function converts the given YAML file to keys and adds the
+ *        result to `keySet`. It reuses the data of a binary snapshot if the
+ *        snapshot matches the content of the YAML file and updates the
+ *        snapshot otherwise.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param path This parameter stores the location of the YAML file.
+ * @param snapshot This parameter stores the location of the snapshot file.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML file
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseFileWithSnapshot(KeySet *keySet, Key *parent, char const *path,
+                                char const *snapshot, YaypegError *error) {
+  if (!path || !snapshot) {
+    setError(error, YAYPEG_ERROR_INPUT, "Missing path of input or snapshot");
+    return -1;
+  }
+
+  return convert(keySet, parent, error,
+                 [path, snapshot](kdb::Key const &parentKey) {
+                   return yaypeg::convertWithSnapshot(parentKey, path,
+                                                      snapshot);
+                 });
+}
+
+/**
+ * @brief This function stores the keys of `keySet` below `parent` in a YAML
+ *        file.
+ *
+ * @param keySet This key set contains the keys the function saves.
+ * @param parent This key specifies the root of the YAML document.
+ * @param path This parameter stores the location of the YAML file.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error writing the YAML file
+ * @retval  0 if the function wrote the YAML file successfully
+ */
+int yaypegWriteFile(KeySet *keySet, Key *parent, char const *path,
+                    YaypegError *error) {
+  using std::exception;
+  using std::system_error;
+
+  if (!keySet || !parent || !path) {
+    setError(error, YAYPEG_ERROR_INTERNAL,
+             "Missing key set, parent key or path of output file");
+    return -1;
+  }
+
+  kdb::KeySet keys{keySet};
+  kdb::Key parentKey{parent};
+  int status = -1;
+
+  try {
+    yaypeg::emitFile(keys, parentKey, path);
+    status = 0;
+    setError(error, YAYPEG_OK, "");
+  } catch (system_error const &problem) {
+    setError(error, YAYPEG_ERROR_INPUT, problem.what());
+  } catch (exception const &problem) {
+    setError(error, YAYPEG_ERROR_INTERNAL, problem.what());
+  }
+
+  parentKey.release();
+  keys.release();
+  return status;
+}
+
+} // namespace ckdb
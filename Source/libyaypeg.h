@@ -0,0 +1,277 @@
+/**
+ * @file
+ *
+ * @brief This file contains the C interface of the YAy PEG library.
+ *
+ * The functions below convert YAML data into keys of a key set supplied by
+ * the caller. They do not throw exceptions. Instead they store information
+ * about problems in an error struct.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_LIBYAYPEG_H
+#define ELEKTRA_PLUGIN_YAYPEG_LIBYAYPEG_H
+
+// -- Imports ------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <kdb.h>
+
+// -- Types --------------------------------------------------------------------
+
+#ifdef __cplusplus
+namespace ckdb {
+extern "C" {
+#endif
+
+/**
+ * @brief This enum specifies the possible results of a conversion.
+ */
+typedef enum {
+  YAYPEG_OK = 0,         ///< The conversion was successful.
+  YAYPEG_ERROR_INPUT,    ///< The library was unable to access a file.
+  YAYPEG_ERROR_PARSE,    ///< The input does not contain (supported) YAML data.
+  YAYPEG_ERROR_INTERNAL, ///< The conversion failed for some other reason.
+  YAYPEG_ERROR_LIMIT     ///< The conversion exceeded a resource limit or was
+                         ///< cancelled.
+} YaypegErrorCode;
+
+/**
+ * @brief This struct stores information about a failed conversion.
+ */
+typedef struct {
+  /** @brief This variable specifies the kind of the error. */
+  YaypegErrorCode code;
+  /** @brief This number stores the line (starting at 1) of a parse error. The
+   *         value is 0 if the location of the error is unknown. */
+  size_t line;
+  /** @brief This number stores the column (starting at 1) of a parse error.
+   *         The value is 0 if the location of the error is unknown. */
+  size_t column;
+  /** @brief This text describes the error. */
+  char message[512];
+} YaypegError;
+
+/**
+ * @brief This struct specifies resource limits for the conversion of
+ *        untrusted input. The value 0 disables a limit.
+ */
+typedef struct {
+  /** @brief This number specifies the maximum nesting depth of
+   *         collections. */
+  size_t maximumDepth;
+  /** @brief This number specifies the maximum number of keys. */
+  size_t maximumKeys;
+  /** @brief This number specifies the maximum size of a single key name part
+   *         or value in bytes. */
+  size_t maximumScalarBytes;
+  /** @brief This number specifies how often the parser may invoke grammar
+   *         rules. */
+  uint64_t maximumRuleInvocations;
+  /** @brief This number specifies the time budget of the conversion in
+   *         milliseconds. */
+  uint64_t timeoutMilliseconds;
+  /** @brief The parser calls this function regularly with the argument
+   *         `cancelData` and stops if it returns a value other than 0. The
+   *         value `NULL` disables cancellation. */
+  int (*cancelled)(void *cancelData);
+  /** @brief This variable stores the argument of `cancelled`. */
+  void *cancelData;
+  /** @brief This number specifies how many keys aliases may create for each
+   *         key of the input. Unlike for the other limits the value 0 keeps
+   *         the default budget (16). */
+  size_t maximumAliasExpansion;
+} YaypegOptions;
+
+/**
+ * @brief This struct stores the memory usage of a conversion in bytes.
+ */
+typedef struct {
+  /** @brief This number stores the size of the input. */
+  size_t inputBytes;
+  /** @brief This number stores the maximum size of the parser state. */
+  size_t parserPeakBytes;
+  /** @brief This number stores the size of the parse tree. */
+  size_t treeBytes;
+  /** @brief This number stores the maximum size of the stacks of the code
+   *         that converts the parse tree to keys. */
+  size_t listenerPeakBytes;
+  /** @brief This number stores the size of the names, values and metadata of
+   *         the converted keys. */
+  size_t keySetBytes;
+  /** @brief This number stores the maximum memory usage of the conversion. */
+  size_t peakBytes;
+  /** @brief This number stores the memory the converted keys retain. */
+  size_t retainedBytes;
+  /** @brief This number stores the maximum memory usage per input byte. */
+  double bytesPerInputByte;
+} YaypegMemoryUsage;
+
+// -- Functions ----------------------------------------------------------------
+
+/**
+ * @brief This function converts the given YAML file to keys and adds the
+ *        result to `keySet`.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param path This parameter stores the location of the YAML file.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML file
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseFile(KeySet *keySet, Key *parent, char const *path,
+                    YaypegError *error);
+
+/**
+ * @brief This function converts the YAML data stored in `buffer` to keys and
+ *        adds the result to `keySet`.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param buffer This variable stores the YAML data. The data does not need to
+ *               be terminated by a null character.
+ * @param size This number specifies the length of `buffer` in bytes.
+ * @param source This text describes the origin of `buffer`. The function uses
+ *               it in error messages. The value `NULL` is allowed.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML data
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseBuffer(KeySet *keySet, Key *parent, char const *buffer,
+                      size_t size, char const *source, YaypegError *error);
+
+/**
+ * @brief This function converts the given YAML file to keys and adds the
+ *        result to `keySet` using the given resource limits.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param path This parameter stores the location of the YAML file.
+ * @param options This struct specifies the resource limits of the conversion.
+ *                The value `NULL` disables all limits.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML file
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseFileWithOptions(KeySet *keySet, Key *parent, char const *path,
+                               YaypegOptions const *options,
+                               YaypegError *error);
+
+/**
+ * @brief This function converts the YAML data stored in `buffer` to keys and
+ *        adds the result to `keySet` using the given resource limits.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param buffer This variable stores the YAML data. The data does not need to
+ *               be terminated by a null character.
+ * @param size This number specifies the length of `buffer` in bytes.
+ * @param source This text describes the origin of `buffer`. The function uses
+ *               it in error messages. The value `NULL` is allowed.
+ * @param options This struct specifies the resource limits of the conversion.
+ *                The value `NULL` disables all limits.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML data
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseBufferWithOptions(KeySet *keySet, Key *parent,
+                                 char const *buffer, size_t size,
+                                 char const *source,
+                                 YaypegOptions const *options,
+                                 YaypegError *error);
+
+/**
+ * @brief This function converts the given YAML file to keys and adds the
+ *        result to `keySet` using the given resource limits. It stores the
+ *        memory usage of the conversion in `usage`.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param path This parameter stores the location of the YAML file.
+ * @param options This struct specifies the resource limits of the conversion.
+ *                The value `NULL` disables all limits.
+ * @param usage The function stores the memory usage of the conversion in this
+ *              struct. The value `NULL` is allowed.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML file
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseFileWithMemoryUsage(KeySet *keySet, Key *parent,
+                                   char const *path,
+                                   YaypegOptions const *options,
+                                   YaypegMemoryUsage *usage,
+                                   YaypegError *error);
+
+/**
+ * @brief This function converts the given YAML file to keys and adds the
+ *        result to `keySet`. It reuses the data of a binary snapshot if the
+ *        snapshot matches the content of the YAML file and updates the
+ *        snapshot otherwise.
+ *
+ * @param keySet The function adds the converted keys to this key set.
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param path This parameter stores the location of the YAML file.
+ * @param snapshot This parameter stores the location of the snapshot file.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error converting the YAML file
+ * @retval  0 if parsing was successful and the function did not change the
+ *            given keyset
+ * @retval  1 if parsing was successful and the function did change `keySet`
+ */
+int yaypegParseFileWithSnapshot(KeySet *keySet, Key *parent, char const *path,
+                                char const *snapshot, YaypegError *error);
+
+/**
+ * @brief This function stores the keys of `keySet` below `parent` in a YAML
+ *        file.
+ *
+ * @param keySet This key set contains the keys the function saves.
+ * @param parent This key specifies the root of the YAML document.
+ * @param path This parameter stores the location of the YAML file.
+ * @param error The function stores information about problems in this
+ *              struct. The value `NULL` is allowed.
+ *
+ * @retval -1 if there was an error writing the YAML file
+ * @retval  0 if the function wrote the YAML file successfully
+ */
+int yaypegWriteFile(KeySet *keySet, Key *parent, char const *path,
+                    YaypegError *error);
+
+#ifdef __cplusplus
+}
+}
+#endif
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_LIBYAYPEG_H
@@ -0,0 +1,72 @@
+/**
+ * @file
+ *
+ * @brief This file contains resource limits for the conversion of untrusted
+ *        input.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_LIMITS_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_LIMITS_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+
+// -- Types --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This struct specifies upper bounds for the resources a single
+ *        conversion may use. By default all limits except for the alias
+ *        expansion budget are disabled.
+ */
+struct Limits {
+  /** @brief This number specifies the maximum nesting depth of collections. */
+  size_t maximumDepth = SIZE_MAX;
+
+  /** @brief This number specifies the maximum number of keys the conversion
+   *         creates. */
+  size_t maximumKeys = SIZE_MAX;
+
+  /** @brief This number specifies the maximum length of a single key name
+   *         part or value in bytes. */
+  size_t maximumScalarBytes = SIZE_MAX;
+
+  /** @brief This number specifies how often the parser may invoke grammar
+   *         rules. It bounds the cost of backtracking. */
+  uint64_t maximumRuleInvocations = UINT64_MAX;
+
+  /** @brief This number specifies how many keys aliases may create for each
+   *         key the parser read from the input. Documents such as “billion
+   *         laughs” nest aliases to create exponentially many keys. */
+  size_t maximumAliasExpansion = 16;
+
+  /** @brief This variable specifies the point in time when the parser stops
+   *         the conversion. */
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::time_point::max();
+
+  /** @brief The parser calls this function regularly and stops the
+   *         conversion if it returns `true`. An empty function disables
+   *         cancellation. */
+  std::function<bool()> cancelled;
+};
+
+/**
+ * @brief This exception specifies that a conversion exceeded one of its
+ *        limits or was cancelled.
+ */
+struct limit_error : std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_LIMITS_HPP
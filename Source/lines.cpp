@@ -0,0 +1,95 @@
+/**
+ * @file
+ *
+ * @brief This file contains a class that converts byte offsets into line and
+ *        column numbers.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "lines.hpp"
+
+using std::string;
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+using tao::TAO_PEGTL_NAMESPACE::position;
+
+/**
+ * @brief This constructor creates an index for the given input.
+ *
+ * The constructor does not read the input.
+ *
+ * @param data This variable stores the start of the input.
+ * @param origin This text describes the origin of the input.
+ */
+LineIndex::LineIndex(char const *data, string origin)
+    : begin{data}, source{std::move(origin)}, scanned{data} {}
+
+/**
+ * @brief This method records the start of all lines up to the given location.
+ *
+ * @param until This variable stores the end of the part of the input the
+ *              method scans.
+ */
+void LineIndex::scan(char const *until) const {
+  char const *current = scanned;
+
+#if defined(__SSE2__)
+  // Compare 16 characters at once and only look at the positions of line
+  // breaks in the resulting bit mask.
+  __m128i const newline = _mm_set1_epi8('\n');
+  for (; until - current >= 16; current += 16) {
+    __m128i block =
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(current));
+    auto mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+    while (mask != 0) {
+      starts.push_back(static_cast<size_t>(current - begin) +
+                       static_cast<size_t>(__builtin_ctz(mask)) + 1);
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  for (; current < until; current++) {
+    if (*current == '\n') {
+      starts.push_back(static_cast<size_t>(current - begin) + 1);
+    }
+  }
+  scanned = current;
+}
+
+/**
+ * @brief This method returns the position of a location in the input.
+ *
+ * @param location This variable points to a character of the input.
+ *
+ * @return The position (offset, line and column) of `location`, as PEGTL
+ *         calculates it with immediate tracking
+ */
+position LineIndex::locate(char const *location) const {
+  if (location > scanned) {
+    scan(location);
+  }
+
+  auto offset = static_cast<size_t>(location - begin);
+  auto line = std::upper_bound(starts.begin(), starts.end(), offset) - 1;
+  return position{tao::TAO_PEGTL_NAMESPACE::internal::iterator{
+                      location, offset,
+                      static_cast<size_t>(line - starts.begin()) + 1,
+                      offset - *line},
+                  source};
+}
+
+} // namespace yaypeg
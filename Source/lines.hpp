@@ -0,0 +1,85 @@
+/**
+ * @file
+ *
+ * @brief This file contains a class that converts byte offsets into line and
+ *        column numbers.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_LINES_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_LINES_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#define TAO_PEGTL_NAMESPACE yaypeg
+
+#include <tao/pegtl/position.hpp>
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This class stores the start of lines in an input.
+ *
+ * The parser uses lazy position tracking: It only stores pointers into the
+ * input and does not count lines and columns while it consumes characters.
+ * The index calculates the position of a pointer only when an error message
+ * requires it. It scans the input for line breaks on the first request and
+ * only up to the requested location. The same index is not safe to use from
+ * multiple threads.
+ */
+class LineIndex {
+  /** @brief This variable stores the start of the input. */
+  char const *begin;
+
+  /** @brief This text describes the origin of the input. */
+  std::string source;
+
+  /** @brief This vector stores the offsets of all line starts the index
+   *         found so far. */
+  mutable std::vector<size_t> starts{0};
+
+  /** @brief This variable stores the end of the part of the input the index
+   *         already scanned. */
+  mutable char const *scanned;
+
+  /**
+   * @brief This method records the start of all lines up to the given
+   *        location.
+   *
+   * @param until This variable stores the end of the part of the input the
+   *              method scans.
+   */
+  void scan(char const *until) const;
+
+public:
+  /**
+   * @brief This constructor creates an index for the given input.
+   *
+   * The constructor does not read the input.
+   *
+   * @param data This variable stores the start of the input.
+   * @param origin This text describes the origin of the input.
+   */
+  LineIndex(char const *data, std::string origin);
+
+  /**
+   * @brief This method returns the position of a location in the input.
+   *
+   * @param location This variable points to a character of the input.
+   *
+   * @return The position (offset, line and column) of `location`, as PEGTL
+   *         calculates it with immediate tracking
+   */
+  tao::TAO_PEGTL_NAMESPACE::position locate(char const *location) const;
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_LINES_HPP
@@ -8,9 +8,13 @@
 
 // -- Imports ------------------------------------------------------------------
 
+#include "intern.hpp"
 #include "listener.hpp"
+#include "scalar.hpp"
+#include "schema.hpp"
 
 using std::string;
+using std::string_view;
 
 using kdb::Key;
 
@@ -37,62 +41,195 @@ string indexToArrayBaseName(uintmax_t const index) {
   return "#" + string(digits - 1, '_') + to_string(index);
 }
 
+} // namespace
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+using std::overflow_error;
+using std::to_string;
+
+/**
+ * @brief This constructor creates a Listener using the given parent key.
+ *
+ * @param parent This argument specifies the parent key of the key set this
+ *               listener produces.
+ * @param settings This argument specifies options for the conversion.
+ */
+Listener::Listener(Key const &parent, Options const &settings)
+    : options{settings} {
+  parents.push(parent);
+}
+
 /**
- * @brief This function converts a YAML scalar to a string.
+ * @brief This method converts the text of a scalar to its value.
  *
- * @param text This string contains a YAML scalar (including quote
- *             characters).
+ * @param text This variable contains the text of the scalar as it appears in
+ *             the input.
+ * @param buffer The method stores values that it does not intern in this
+ *               variable.
  *
- * @return A string without leading and trailing quote characters
+ * @return A view of the null terminated value of `text`
  */
-string scalarToText(string const &text) {
-  if (text.length() == 0) {
-    return text;
+string_view Listener::toValue(string_view text, string &buffer) const {
+  ScalarStyle style = styleOf(text);
+  if (style == ScalarStyle::LITERAL || style == ScalarStyle::FOLDED) {
+    auto indentation = blockIndentation.find(text.data());
+    buffer = scalarToText(text, indentation == blockIndentation.end()
+                                    ? detectIndentation
+                                    : indentation->second);
+    return buffer;
   }
-  if (*(text.begin()) == '"' || *(text.begin()) == '\'') {
-    return text.substr(1, text.length() - 2);
+  if (options.intern && InternTable::accepts(text)) {
+    return options.intern->intern(text, buffer);
   }
-  return text;
+  buffer = scalarToText(text);
+  return buffer;
 }
 
-} // namespace
+/**
+ * @brief This method stores the value of a plain scalar together with its
+ *        type, if the options enable type resolution.
+ *
+ * @param key This argument stores the key of the scalar.
+ * @param text This variable contains the text of the scalar as it appears in
+ *             the input.
+ *
+ * @retval true If the method stored the value of `text` in `key`
+ * @retval false If `text` is a string or type resolution is disabled
+ */
+bool Listener::setTypedValue(Key &key, string_view text) const {
+  if (!options.resolveTypes || styleOf(text) != ScalarStyle::PLAIN) {
+    return false;
+  }
+  ValueBuffer buffer;
+  ResolvedScalar scalar = resolveScalar(text, buffer);
+  if (scalar.type == ScalarType::STRING) {
+    return false;
+  }
 
-// -- Class --------------------------------------------------------------------
+  // Only the canonical values of floats may be views of the input, which
+  // are not null terminated.
+  string copy;
+  string_view value = scalar.value.data() == text.data()
+                          ? toValue(text, copy)
+                          : scalar.value;
+  ckdb::keySetString(key.getKey(), value.data());
+  if (char const *name = typeName(scalar.type)) {
+    key.setMeta("type", name);
+  }
+  return true;
+}
 
-namespace yaypeg {
+/**
+ * @brief This method checks if the given scalar exceeds the size limit.
+ *
+ * @param text This variable contains the text of the scalar as it appears in
+ *             the input.
+ *
+ * @throws limit_error if `text` is larger than the maximum scalar size
+ */
+void Listener::checkScalar(string_view text) const {
+  if (text.size() > options.limits.maximumScalarBytes) {
+    throw limit_error("Scalar of size " + to_string(text.size()) +
+                      " exceeds maximum size of " +
+                      to_string(options.limits.maximumScalarBytes) +
+                      " bytes");
+  }
+}
 
-using std::overflow_error;
+/**
+ * @brief This method checks if the current key exceeds the depth limit.
+ *
+ * @throws limit_error if the current key is nested too deeply
+ */
+void Listener::checkDepth() const {
+  if (parents.size() - 1 > options.limits.maximumDepth) {
+    throw limit_error("Key “" + parents.top().getName() +
+                      "” exceeds maximum nesting depth of " +
+                      to_string(options.limits.maximumDepth));
+  }
+}
 
 /**
- * @brief This constructor creates a Listener using the given parent key.
+ * @brief This method adds a key to the key set of the listener.
  *
- * @param parent This argument specifies the parent key of the key set this
- *               listener produces.
+ * @param key This argument stores the key this method adds.
+ *
+ * @throws limit_error if the key set already contains the maximum number of
+ *         keys
  */
-Listener::Listener(Key const &parent) { parents.push(parent); }
+void Listener::addKey(Key const &key) {
+  keys.append(key);
+  if (static_cast<size_t>(keys.size()) > options.limits.maximumKeys) {
+    throw limit_error("Number of keys exceeds maximum of " +
+                      to_string(options.limits.maximumKeys));
+  }
+  // Only anchored nodes need to remember their keys
+  if (!open.empty()) {
+    created.push_back(key);
+  }
+}
+
+/**
+ * @brief This method marks all anchored nodes at the current key as complete.
+ *
+ * The listener calls this method before it removes a key from `parents`.
+ */
+void Listener::closeAnchors() {
+  while (!open.empty() && open.back().second.depth == parents.size()) {
+    open.back().second.end = created.size();
+    anchors[open.back().first] = open.back().second;
+    open.pop_back();
+  }
+}
+
+/**
+ * @brief This method copies a key of an anchored node for an alias.
+ *
+ * @param source This argument stores the key of the anchored node.
+ * @param name This text specifies the name of the copy.
+ *
+ * @return A copy of `source` called `name`
+ */
+Key Listener::copyKey(Key const &source, string const &name) {
+  Key copy{source.dup()};
+  copy.setName(name);
+  return copy;
+}
 
 /**
  * @brief This function will be called after the walker exits a value node.
  *
- * @param text This variable contains the text stored in the value.
+ * @param text This variable contains the text of the value as it appears in
+ *             the input.
  */
-void Listener::exitValue(string const &text) {
+void Listener::exitValue(string_view text) {
+  checkScalar(text);
   Key key = parents.top();
-  key.setString(scalarToText(text));
-  keys.append(key);
+  if (!setTypedValue(key, text)) {
+    string buffer;
+    ckdb::keySetString(key.getKey(), toValue(text, buffer).data());
+  }
+  addKey(key);
 }
 
 /**
  * @brief This function will be called after the walker exits a key node.
  *
- * @param text This variable contains the text of the key.
+ * @param text This variable contains the text of the key as it appears in
+ *             the input.
  */
-void Listener::exitKey(string const &text) {
+void Listener::exitKey(string_view text) {
   // Entering a mapping such as `part: …` means that we need to add `part` to
   // the key name
+  checkScalar(text);
   Key child{parents.top().getName(), KEY_END};
-  child.addBaseName(scalarToText(text));
+  string buffer;
+  ckdb::keyAddBaseName(child.getKey(), toValue(text, buffer).data());
   parents.push(child);
+  checkDepth();
 }
 
 /**
@@ -102,9 +239,75 @@ void Listener::exitKey(string const &text) {
 void Listener::exitPair() {
   // Returning from a mapping such as `part: …` means that we need need to
   // remove the key for `part` from the stack.
+  closeAnchors();
   parents.pop();
 }
 
+/**
+ * @brief This function will be called after the walker exits the anchor of
+ *        the node stored at the current key.
+ *
+ * @param name This variable stores the name of the anchor.
+ */
+void Listener::exitAnchor(string_view name) {
+  // The anchor only becomes visible to aliases after the walker left the
+  // node. This way an alias can not refer to one of its ancestors.
+  open.emplace_back(string{name}, Anchor{parents.top(), parents.size(),
+                                         created.size(), created.size()});
+}
+
+/**
+ * @brief This function will be called after the walker exits an alias node
+ *        that stores the value of the current key.
+ *
+ * @param name This variable stores the name of the anchor the alias refers
+ *             to.
+ *
+ * @retval true If the method converted the alias
+ * @retval false If there is no complete node with the anchor `name`
+ *
+ * @throws limit_error if the keys of the alias exceed the expansion budget
+ */
+bool Listener::exitAlias(string_view name) {
+  auto anchor = anchors.find(string{name});
+  if (anchor == anchors.end()) {
+    return false;
+  }
+  Anchor const &source = anchor->second;
+
+  if (options.aliasReferences) {
+    Key key = parents.top();
+    key.setString(source.key.getName());
+    key.setMeta("check/reference", "single");
+    addKey(key);
+    return true;
+  }
+
+  // Nested aliases (“billion laughs”) double the number of keys with every
+  // level. We therefore only allow a linear number of copies.
+  size_t count = source.end - source.begin;
+  size_t total = static_cast<size_t>(keys.size());
+  size_t direct = total > expanded ? total - expanded : 1;
+  if ((expanded + count + direct - 1) / direct >
+      options.limits.maximumAliasExpansion) {
+    throw limit_error("Alias “*" + string{name} +
+                      "” exceeds expansion budget of " +
+                      to_string(options.limits.maximumAliasExpansion) +
+                      " keys per key of the input");
+  }
+
+  string const prefix = source.key.getName();
+  string const target = parents.top().getName();
+  for (size_t index = source.begin; index < source.end; index++) {
+    // Adding a key may move the elements of `created`
+    Key original = created[index];
+    addKey(copyKey(original, target + original.getName().substr(
+                                          prefix.size())));
+  }
+  expanded += count;
+  return true;
+}
+
 /**
  * @brief This function will be called before the walker enters a sequence
  *        node.
@@ -119,7 +322,7 @@ void Listener::enterSequence() {
  */
 void Listener::exitSequence() {
   // We add the parent key of all array elements after we leave the sequence
-  keys.append(parents.top());
+  addKey(parents.top());
   indices.pop();
 }
 
@@ -142,15 +345,67 @@ void Listener::enterElement() {
 
   parents.top().setMeta("array", key.getBaseName());
   parents.push(key);
+  checkDepth();
 }
 
 /**
  * @brief This function will be called after the walker exits a sequence node.
  */
 void Listener::exitElement() {
+  closeAnchors();
   parents.pop(); // Remove the key for the current array entry
 }
 
+/**
+ * @brief This method sets the content indentation of block scalars the parser
+ *        determined.
+ *
+ * @param indentation This map stores the content indentation of block scalars
+ *                    by the position of their header.
+ */
+void Listener::setBlockIndentation(
+    std::unordered_map<char const *, size_t> indentation) {
+  blockIndentation = std::move(indentation);
+}
+
+/**
+ * @brief This method returns the options of the listener.
+ *
+ * @return The options of the conversion
+ */
+Options const &Listener::getOptions() const noexcept { return options; }
+
+/**
+ * @brief This method returns the memory usage of the stacks of the listener.
+ *
+ * @return A counter that stores the current and maximum size of the stacks
+ */
+MemoryCounter const &Listener::getMemory() const noexcept { return memory; }
+
+/**
+ * @brief This method removes all keys the listener created so far.
+ *
+ * The method also restarts the measurement of the peak memory usage.
+ */
+void Listener::reset() {
+  while (parents.size() > 1) {
+    parents.pop();
+  }
+  while (!indices.empty()) {
+    indices.pop();
+  }
+  keys.clear();
+  anchors.clear();
+  open.clear();
+  created.clear();
+  created.shrink_to_fit();
+  expanded = 0;
+  blockIndentation.clear();
+  // The stacks and `created` still own some memory, which the counter has
+  // to release later. We therefore only restart the measurement of the peak.
+  memory.peak = memory.current;
+}
+
 /**
  * @brief This method returns the key set of the listener.
  *
@@ -12,9 +12,17 @@
 // -- Imports ------------------------------------------------------------------
 
 #include <stack>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <kdb.hpp>
 
+#include "memory.hpp"
+#include "options.hpp"
+
 // -- Class --------------------------------------------------------------------
 
 namespace yaypeg {
@@ -26,20 +34,132 @@ namespace yaypeg {
  * a key set from the syntax tree created by the parser (`convert`).
  */
 class Listener {
-
+protected:
   /** @brief This variable stores the key set that this listener creates. */
   kdb::KeySet keys;
 
+  /** @brief This counter records the memory usage of the stacks of the
+   *         listener. */
+  MemoryCounter memory;
+
   /**
    * @brief This stack stores a key for each level of the current key name below
    *        parent.
    */
-  std::stack<kdb::Key> parents;
+  CountedStack<kdb::Key> parents{CountingAllocator<kdb::Key>{&memory}};
 
   /**
    * @brief This stack stores indices for the next array elements.
    */
-  std::stack<uintmax_t> indices;
+  CountedStack<uintmax_t> indices{CountingAllocator<uintmax_t>{&memory}};
+
+  /** @brief This variable stores the options of the conversion. */
+  Options options;
+
+  /**
+   * @brief This struct stores the location of an anchored node.
+   */
+  struct Anchor {
+    /** @brief This key stores the name of the anchored node. */
+    kdb::Key key;
+    /** @brief This number stores the size of `parents` for the node. */
+    size_t depth;
+    /** @brief This number stores the index of the first key of the node in
+     *         `created`. */
+    size_t begin;
+    /** @brief This number stores the index after the last key of the node in
+     *         `created`. */
+    size_t end;
+  };
+
+  /** @brief This map stores all complete anchored nodes by name. */
+  std::unordered_map<std::string, Anchor> anchors;
+
+  /** @brief This stack stores the names and locations of anchored nodes the
+   *         walker did not leave yet. */
+  std::vector<std::pair<std::string, Anchor>> open;
+
+  /** @brief This vector stores the keys the listener added while it was
+   *         inside an anchored node in the order of creation. */
+  CountedVector<kdb::Key> created{CountingAllocator<kdb::Key>{&memory}};
+
+  /** @brief This number stores how many keys the listener created for
+   *         aliases. */
+  size_t expanded = 0;
+
+  /** @brief This map stores the content indentation of block scalars with
+   *         an indentation indicator by the position of their header. */
+  std::unordered_map<char const *, size_t> blockIndentation;
+
+  /**
+   * @brief This method converts the text of a scalar to its value.
+   *
+   * @param text This variable contains the text of the scalar as it appears
+   *             in the input.
+   * @param buffer The method stores values that it does not intern in this
+   *               variable.
+   *
+   * @return A view of the null terminated value of `text`
+   */
+  std::string_view toValue(std::string_view text, std::string &buffer) const;
+
+  /**
+   * @brief This method stores the value of a plain scalar together with its
+   *        type, if the options enable type resolution.
+   *
+   * @param key This argument stores the key of the scalar.
+   * @param text This variable contains the text of the scalar as it appears
+   *             in the input.
+   *
+   * @retval true If the method stored the value of `text` in `key`
+   * @retval false If `text` is a string or type resolution is disabled
+   */
+  bool setTypedValue(kdb::Key &key, std::string_view text) const;
+
+  /**
+   * @brief This method checks if the given scalar exceeds the size limit.
+   *
+   * @param text This variable contains the text of the scalar as it appears
+   *             in the input.
+   *
+   * @throws limit_error if `text` is larger than the maximum scalar size
+   */
+  void checkScalar(std::string_view text) const;
+
+  /**
+   * @brief This method checks if the current key exceeds the depth limit.
+   *
+   * @throws limit_error if the current key is nested too deeply
+   */
+  void checkDepth() const;
+
+  /**
+   * @brief This method adds a key to the key set of the listener.
+   *
+   * @param key This argument stores the key this method adds.
+   *
+   * @throws limit_error if the key set already contains the maximum number
+   *         of keys
+   */
+  virtual void addKey(kdb::Key const &key);
+
+  /**
+   * @brief This method marks all anchored nodes at the current key as
+   *        complete.
+   *
+   * The listener calls this method before it removes a key from `parents`.
+   */
+  void closeAnchors();
+
+  /**
+   * @brief This method copies a key of an anchored node for an alias.
+   *
+   * @param source This argument stores the key of the anchored node.
+   * @param name This text specifies the name of the copy.
+   *
+   * @return A copy of `source` called `name`
+   */
+  virtual kdb::Key copyKey(kdb::Key const &source, std::string const &name);
 
 public:
   /**
@@ -47,50 +167,117 @@ public:
    *
    * @param parent This argument specifies the parent key of the key set this
    *               listener produces.
+   * @param settings This argument specifies options for the conversion.
    */
-  Listener(kdb::Key const &parent);
+  Listener(kdb::Key const &parent, Options const &settings = Options{});
+
+  virtual ~Listener() = default;
 
   /**
    * @brief This function will be called after the walker exits a value node.
    *
-   * @param text This variable contains the text stored in the value.
+   * @param text This variable contains the text of the value as it appears in
+   *             the input.
    */
-  void exitValue(std::string const &text);
+  virtual void exitValue(std::string_view text);
 
   /**
    * @brief This function will be called after the walker exits a key node.
    *
-   * @param text This variable contains the text of the key.
+   * @param text This variable contains the text of the key as it appears in
+   *             the input.
    */
-  void exitKey(std::string const &text);
+  virtual void exitKey(std::string_view text);
 
   /**
    * @brief This function will be called after the walker exits the node for a
    *        key-value pair.
    */
-  void exitPair();
+  virtual void exitPair();
+
+  /**
+   * @brief This function will be called after the walker exits the anchor of
+   *        the node stored at the current key.
+   *
+   * @param name This variable stores the name of the anchor.
+   */
+  virtual void exitAnchor(std::string_view name);
+
+  /**
+   * @brief This function will be called after the walker exits an alias node
+   *        that stores the value of the current key.
+   *
+   * Depending on the options of the conversion the method either copies the
+   * keys of the anchored node, or stores a reference to the anchored node.
+   * Either way the method reuses the keys the listener already created.
+   *
+   * @param name This variable stores the name of the anchor the alias refers
+   *             to.
+   *
+   * @retval true If the method converted the alias
+   * @retval false If there is no complete node with the anchor `name`
+   *
+   * @throws limit_error if the keys of the alias exceed the expansion budget
+   */
+  virtual bool exitAlias(std::string_view name);
 
   /**
    * @brief This function will be called before the walker enters a sequence
    *        node.
    */
-  void enterSequence();
+  virtual void enterSequence();
 
   /**
    * @brief This function will be called after the walker exits a sequence node.
    */
-  void exitSequence();
+  virtual void exitSequence();
 
   /**
    * @brief This function will be called before the walker enters an element
    *        node.
    */
-  void enterElement();
+  virtual void enterElement();
 
   /**
    * @brief This function will be called after the walker exits a sequence node.
    */
-  void exitElement();
+  virtual void exitElement();
+
+  /**
+   * @brief This method sets the content indentation of block scalars the
+   *        parser determined.
+   *
+   * The parser calls this method before the walker visits the tree.
+   *
+   * @param indentation This map stores the content indentation of block
+   *                    scalars by the position of their header.
+   */
+  void setBlockIndentation(
+      std::unordered_map<char const *, size_t> indentation);
+
+  /**
+   * @brief This method returns the options of the listener.
+   *
+   * @return The options of the conversion
+   */
+  Options const &getOptions() const noexcept;
+
+  /**
+   * @brief This method returns the memory usage of the stacks of the
+   *        listener.
+   *
+   * @return A counter that stores the current and maximum size of the stacks
+   */
+  MemoryCounter const &getMemory() const noexcept;
+
+  /**
+   * @brief This method removes all keys the listener created so far.
+   *
+   * The parser calls this method before it converts the same input again
+   * with a different engine. The method also restarts the measurement of
+   * the peak memory usage, so that the usage only covers the last engine.
+   */
+  virtual void reset();
 
   /**
    * @brief This method returns the key set of the listener.
@@ -0,0 +1,49 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions to measure the memory usage of a
+ *        conversion.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include "memory.hpp"
+
+// -- Functions ----------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This function returns the size of the names, values and metadata of
+ *        all keys of a key set.
+ *
+ * @param keys This argument stores the key set the function measures.
+ *
+ * @return The number of bytes the keys of `keys` store, including the array
+ *         of the key set
+ */
+size_t keySetBytes(kdb::KeySet const &keys) {
+  ckdb::KeySet *handle = keys.getKeySet();
+  ssize_t size = ckdb::ksGetSize(handle);
+  auto bytes = static_cast<size_t>(size) * sizeof(ckdb::Key *);
+
+  for (ssize_t cursor = 0; cursor < size; cursor++) {
+    ckdb::Key *key = ckdb::ksAtCursor(handle, cursor);
+    // Elektra stores the escaped and the unescaped name of every key
+    bytes += static_cast<size_t>(ckdb::keyGetNameSize(key)) +
+             static_cast<size_t>(ckdb::keyGetUnescapedNameSize(key));
+    ssize_t value = ckdb::keyGetValueSize(key);
+    bytes += value > 0 ? static_cast<size_t>(value) : 0;
+
+    ckdb::keyRewindMeta(key);
+    while (ckdb::Key const *meta = ckdb::keyNextMeta(key)) {
+      bytes += static_cast<size_t>(ckdb::keyGetNameSize(meta)) +
+               static_cast<size_t>(ckdb::keyGetValueSize(meta));
+    }
+  }
+  return bytes;
+}
+
+} // namespace yaypeg
@@ -0,0 +1,212 @@
+/**
+ * @file
+ *
+ * @brief This file contains types to measure the memory usage of a
+ *        conversion.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_MEMORY_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_MEMORY_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <stack>
+#include <vector>
+
+#include <kdb.hpp>
+
+// -- Types --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This struct stores the number of bytes a group of containers
+ *        currently uses and the maximum they used so far.
+ */
+struct MemoryCounter {
+  /** @brief This number stores the currently allocated bytes. */
+  size_t current = 0;
+  /** @brief This number stores the maximum of `current`. */
+  size_t peak = 0;
+
+  /**
+   * @brief This method records an allocation.
+   *
+   * @param bytes This number specifies the size of the allocation.
+   */
+  void allocate(size_t bytes) noexcept {
+    current += bytes;
+    if (current > peak) {
+      peak = current;
+    }
+  }
+
+  /**
+   * @brief This method records a deallocation.
+   *
+   * @param bytes This number specifies the size of the deallocation.
+   */
+  void release(size_t bytes) noexcept { current -= bytes; }
+};
+
+/**
+ * @brief This allocator records the size of all allocations of a container in
+ *        a memory counter.
+ *
+ * The allocator gets its memory from `std::allocator`. Without a counter
+ * (default) it behaves exactly like `std::allocator`.
+ */
+template <typename T> struct CountingAllocator {
+  using value_type = T;
+
+  /** @brief The allocator records allocations in this counter, if it is not
+   *         `nullptr`. */
+  MemoryCounter *counter = nullptr;
+
+  CountingAllocator() noexcept = default;
+
+  /**
+   * @brief This constructor creates an allocator that uses the given
+   *        counter.
+   *
+   * @param memory This argument specifies the counter of the allocator.
+   */
+  explicit CountingAllocator(MemoryCounter *memory) noexcept
+      : counter{memory} {}
+
+  template <typename U>
+  CountingAllocator(CountingAllocator<U> const &other) noexcept
+      : counter{other.counter} {}
+
+  T *allocate(size_t count) {
+    T *memory = std::allocator<T>{}.allocate(count);
+    if (counter) {
+      counter->allocate(count * sizeof(T));
+    }
+    return memory;
+  }
+
+  void deallocate(T *memory, size_t count) noexcept {
+    if (counter) {
+      counter->release(count * sizeof(T));
+    }
+    std::allocator<T>{}.deallocate(memory, count);
+  }
+
+  template <typename U>
+  bool operator==(CountingAllocator<U> const &other) const noexcept {
+    return counter == other.counter;
+  }
+
+  template <typename U>
+  bool operator!=(CountingAllocator<U> const &other) const noexcept {
+    return counter != other.counter;
+  }
+};
+
+/** @brief This type specifies a stack that records its memory usage. */
+template <typename T>
+using CountedStack = std::stack<T, std::deque<T, CountingAllocator<T>>>;
+
+/** @brief This type specifies a deque that records its memory usage. */
+template <typename T>
+using CountedDeque = std::deque<T, CountingAllocator<T>>;
+
+/** @brief This type specifies a vector that records its memory usage. */
+template <typename T>
+using CountedVector = std::vector<T, CountingAllocator<T>>;
+
+/**
+ * @brief This struct stores the memory usage of a conversion.
+ *
+ * The numbers only include the data of the conversion itself and not the
+ * bookkeeping of the system allocator.
+ */
+struct MemoryUsage {
+  /** @brief This number stores the size of the input in bytes. */
+  size_t inputBytes = 0;
+  /** @brief This number stores the maximum size of the parser state
+   *         (context and indentation stacks). */
+  size_t parserPeakBytes = 0;
+  /** @brief This number stores the size of the structural index of the
+   *         input. */
+  size_t indexBytes = 0;
+  /** @brief This number stores the size of the parse tree (nodes, child
+   *         lists and source strings). The JSON parser does not create a
+   *         tree. */
+  size_t treeBytes = 0;
+  /** @brief This number stores the maximum size of the stacks of the
+   *         listener (key names, array indices and anchored keys). */
+  size_t listenerPeakBytes = 0;
+  /** @brief This number stores the size of the names, values and metadata of
+   *         the resulting keys. */
+  size_t keySetBytes = 0;
+
+  /**
+   * @brief This method returns the maximum memory usage of the parse phase.
+   *
+   * @return The size of the input, the structural index, the parse tree and
+   *         the largest parser state
+   */
+  size_t parsePeakBytes() const noexcept {
+    return inputBytes + indexBytes + treeBytes + parserPeakBytes;
+  }
+
+  /**
+   * @brief This method returns the maximum memory usage of the tree walk.
+   *
+   * @return The size of the input, the parse tree, the largest listener
+   *         state and the key set
+   */
+  size_t walkPeakBytes() const noexcept {
+    return inputBytes + treeBytes + listenerPeakBytes + keySetBytes;
+  }
+
+  /**
+   * @brief This method returns the maximum memory usage of the conversion.
+   *
+   * @return The maximum of the parse and walk phase
+   */
+  size_t peakBytes() const noexcept {
+    return parsePeakBytes() > walkPeakBytes() ? parsePeakBytes()
+                                              : walkPeakBytes();
+  }
+
+  /**
+   * @brief This method returns the memory the conversion retains after it
+   *        returns.
+   *
+   * @return The size of the key set
+   */
+  size_t retainedBytes() const noexcept { return keySetBytes; }
+
+  /**
+   * @brief This method returns the peak memory usage per byte of input.
+   *
+   * @return The peak memory usage divided by the size of the input
+   */
+  double bytesPerInputByte() const noexcept {
+    return static_cast<double>(peakBytes()) /
+           static_cast<double>(inputBytes > 0 ? inputBytes : 1);
+  }
+};
+
+/**
+ * @brief This function returns the size of the names, values and metadata of
+ *        all keys of a key set.
+ *
+ * @param keys This argument stores the key set the function measures.
+ *
+ * @return The number of bytes the keys of `keys` store, including the array
+ *         of the key set
+ */
+size_t keySetBytes(kdb::KeySet const &keys);
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_MEMORY_HPP
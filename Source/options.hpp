@@ -0,0 +1,94 @@
+/**
+ * @file
+ *
+ * @brief This file contains the options of a conversion.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_OPTIONS_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_OPTIONS_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstdint>
+#include <memory>
+
+#include "limits.hpp"
+
+// -- Types --------------------------------------------------------------------
+
+namespace spdlog {
+class logger;
+} // namespace spdlog
+
+namespace yaypeg {
+
+class InternTable;
+struct MemoryUsage;
+
+/**
+ * @brief This struct stores settings that change how the library converts
+ *        YAML data to keys.
+ */
+struct Options {
+  /**
+   * @brief This variable specifies a table the listener uses to deduplicate
+   *        key names and small values. The table has to outlive the
+   *        conversion. The value `nullptr` disables interning. A table is not
+   *        thread-safe: Conversions that run at the same time need separate
+   *        tables.
+   */
+  InternTable *intern = nullptr;
+
+  /** @brief This variable specifies the resource limits of the conversion. */
+  Limits limits;
+
+  /**
+   * @brief If this variable is not `nullptr`, then the parser stores the
+   *        number of grammar rules it invoked in the location it points to.
+   *        The JSON fast path does not invoke any grammar rules.
+   */
+  uint64_t *invocations = nullptr;
+
+  /**
+   * @brief If this variable is not `nullptr`, then the conversion stores its
+   *        memory usage in the location it points to.
+   */
+  MemoryUsage *memory = nullptr;
+
+  /**
+   * @brief This variable specifies if the listener stores aliases as
+   *        references (metakey `check/reference`) to the anchored key instead
+   *        of copying the keys of the anchored node.
+   */
+  bool aliasReferences = false;
+
+  /**
+   * @brief This variable specifies if the listener resolves the type of
+   *        plain scalars according to the YAML core schema. The listener
+   *        then stores the canonical value of booleans (`1`, `0`), integers
+   *        (decimal) and special floats (`inf`, `-inf`, `nan`) and the type
+   *        in the metakey `type`. Null values become empty values.
+   */
+  bool resolveTypes = false;
+
+  /**
+   * @brief This variable specifies if the parser creates a structural index
+   *        of the input (stage 1) before it matches the grammar. Grammar
+   *        rules then read indentation, line breaks and comments from the
+   *        index instead of the input.
+   */
+  bool structuralIndex = true;
+
+  /**
+   * @brief This variable specifies the logger for the trace messages of the
+   *        parser (only in debug builds created with Clang). The value
+   *        `nullptr` disables these messages.
+   */
+  std::shared_ptr<spdlog::logger> logger;
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_OPTIONS_HPP
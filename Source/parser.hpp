@@ -25,20 +25,21 @@
 #define SPDLOG_TRACE_ON
 
 #if defined(__clang__)
-#define LOGF(fmt, ...)                                                         \
-  console->trace("{}:{}: " fmt, __FILE__, __LINE__, __VA_ARGS__)
+#define LOGF(state, fmt, ...)                                                  \
+  do {                                                                         \
+    if ((state).logger) {                                                      \
+      (state).logger->trace("{}:{}: " fmt, __FILE__, __LINE__, __VA_ARGS__);   \
+    }                                                                          \
+  } while (false)
 #else
-#define LOGF(fmt, ...)
+#define LOGF(state, fmt, ...)
 #endif
 
-#if defined(__clang__)
-#define LOG(text) console->trace("{}:{}: {}", __FILE__, __LINE__, text)
-#else
-#define LOG(text)
-#endif
+#define LOG(state, text) LOGF(state, "{}", text)
 
 // -- Imports ------------------------------------------------------------------
 
+#include <cstring>
 #include <functional>
 #include <iostream>
 
@@ -49,19 +50,18 @@
 #include <kdb.hpp>
 
 #include "state.hpp"
+#include "structure.hpp"
 
 #if defined(__clang__)
 #include <spdlog/spdlog.h>
-using spdlog::logger;
-using std::shared_ptr;
-
-extern shared_ptr<spdlog::logger> console;
 #endif
 
 // -- Functions ----------------------------------------------------------------
 
 namespace {
 
+using yaypeg::State;
+
 /**
  * @brief This function returns the last matched character as UTF-32 code point.
  *
@@ -72,46 +72,125 @@ namespace {
  *       `'\0'` or if the input did not contain a valid UTF-8 sequence.
  *
  * @param input This variable stores the current state of the parser input.
+ * @param state This variable stores the logger of the parser.
  *
  * @return The last matched character as UTF-32 code point
  */
-template <typename Input> std::uint32_t lastMatchedUtf32(Input &input) {
+template <typename Input>
+std::uint32_t lastMatchedUtf32(Input &input,
+                               State &state __attribute__((unused))) {
   // We assume UTF-8 as encoding!
   auto last = input.current() - 1;
   std::uint32_t character = 0;
 
   // One byte: 0xxxxxxx
   if (static_cast<std::uint8_t>(*last) <= 0b01111111) {
-    LOG("One Byte");
+    LOG(state, "One Byte");
     character = *last;
   }
   // Two bytes: 110xxxxx  10xxxxxx
   else if (last - 1 != input.begin() &&
            static_cast<std::uint8_t>(*(last - 1)) >> 5 == 0b00000110) {
-    LOG("Two Bytes");
+    LOG(state, "Two Bytes");
     character = *last & 0b00111111;
     character |= (*(last - 1) & 0b00011111) << 6;
   } // Three bytes: 1110xxxx  10xxxxxx  10xxxxxx
   else if (last - 2 != input.begin() &&
            static_cast<std::uint8_t>(*(last - 2)) >> 4 == 0b00001110) {
-    LOG("Three Bytes");
+    LOG(state, "Three Bytes");
     character = *last & 0b00111111;
     character |= (*(last - 1) & 0b00111111) << 6;
     character |= (*(last - 2) & 0b00001111) << 12;
   } // Four bytes: 11110xxx  10xxxxxx  10xxxxxx  10xxxxxx
   else if (last - 3 != input.begin() &&
            static_cast<std::uint8_t>(*(last - 3)) >> 3 == 0b00011110) {
-    LOG("Four Bytes");
+    LOG(state, "Four Bytes");
     character = *last & 0b00111111;
     character |= (*(last - 1) & 0b00111111) << 6;
     character |= (*(last - 2) & 0b00111111) << 12;
     character |= (*(last - 3) & 0b00000111) << 18;
   }
 
-  LOGF("Last: “{}”", static_cast<unsigned long>(character));
+  LOGF(state, "Last: “{}”", static_cast<unsigned long>(character));
   return character;
 }
 
+/**
+ * @brief This function returns the start of the next line.
+ *
+ * @param position This variable stores a location inside the current line.
+ * @param end This variable stores the end of the input.
+ *
+ * @return The first character after the next line feed or `end`, if the
+ *         input does not contain another line feed
+ */
+inline char const *nextLine(char const *position, char const *end) noexcept {
+  auto lineFeed = static_cast<char const *>(
+      memchr(position, '\n', static_cast<size_t>(end - position)));
+  return lineFeed ? lineFeed + 1 : end;
+}
+
+/**
+ * @brief This function checks if a line starts with a document marker.
+ *
+ * @param line This variable stores the start of the line.
+ * @param end This variable stores the end of the line.
+ *
+ * @retval true If the line starts with `---` or `...` (`c_forbidden`)
+ * @retval false Otherwise
+ */
+inline bool isDocumentMarker(char const *line, char const *end) noexcept {
+  if (end - line < 3 || (line[0] != '-' && line[0] != '.') ||
+      line[1] != line[0] || line[2] != line[0]) {
+    return false;
+  }
+  return end - line == 3 || line[3] == ' ' || line[3] == '\t' ||
+         line[3] == '\r' || line[3] == '\n';
+}
+
+/**
+ * @brief This function returns the start of the next line.
+ *
+ * @param position This variable stores a location inside the current line.
+ * @param end This variable stores the end of the input.
+ * @param state This variable stores the structural index of the input.
+ *
+ * @return The first character after the next line feed or `end`, if the
+ *         input does not contain another line feed
+ */
+inline char const *nextLine(char const *position, char const *end,
+                            State const &state) noexcept {
+  return state.structure ? state.structure->nextLine(position)
+                         : nextLine(position, end);
+}
+
+/**
+ * @brief This function returns the number of spaces at a location.
+ *
+ * @param position This variable stores the location of the first space.
+ * @param end This variable stores the end of the input.
+ * @param maximum This number specifies how many spaces the function counts
+ *                at most.
+ * @param state This variable stores the structural index of the input.
+ *
+ * @return The number of consecutive spaces starting at `position`, but not
+ *         more than `maximum`
+ */
+inline long long leadingSpaces(char const *position, char const *end,
+                               long long maximum,
+                               State const &state) noexcept {
+  if (state.structure) {
+    auto spaces = static_cast<long long>(state.structure->spaces(position));
+    return spaces < maximum ? spaces : maximum;
+  }
+  long long spaces = 0;
+  while (spaces < maximum && position + spaces != end &&
+         position[spaces] == ' ') {
+    spaces++;
+  }
+  return spaces;
+}
+
 } // namespace
 
 // -- Rules & Actions ----------------------------------------------------------
@@ -178,11 +257,9 @@ struct push_indent {
             tao::TAO_PEGTL_NAMESPACE::rewind_mode, template <typename...> class,
             template <typename...> class, typename Input>
   static bool match(Input &input, State &state) {
-    long long indent = 0;
-    while (input.peek_char(indent) == ' ') {
-      ++indent;
-    }
-    state.indentation.push_back(indent);
+    state.indentation.push_back(
+        leadingSpaces(input.current(), input.end(),
+                      static_cast<long long>(input.size()), state));
     return true;
   }
 };
@@ -480,12 +557,12 @@ struct s_indent {
             tao::TAO_PEGTL_NAMESPACE::rewind_mode, template <typename...> class,
             template <typename...> class, typename Input>
   static bool match(Input &input, State &state) {
-    auto indent = state.indentation.back();
-    decltype(indent) spaces = 0;
-    while (input.peek_char(spaces) == ' ' && spaces < indent) {
-      spaces++;
+    // Content lines end at the next document marker
+    if (input.current() == state.documentEnd) {
+      return false;
     }
-    if (spaces < indent) {
+    auto indent = state.indentation.back();
+    if (leadingSpaces(input.current(), input.end(), indent, state) < indent) {
       return false;
     }
     input.bump(state.indentation.back());
@@ -559,8 +636,43 @@ struct s_separate_lines
 // = 6.6. Comments =
 // =================
 
+/**
+ * @brief This rule matches a run of printable ASCII characters and tabs.
+ *
+ * The rule matches the same text as `plus<nb_char>` would, as long as the
+ * text only contains ASCII characters. It reads the length of the run from
+ * the structural index, which allows the parser to skip comments with a
+ * single rule invocation.
+ */
+struct nb_ascii_text {
+  using analyze_t = tao::TAO_PEGTL_NAMESPACE::analysis::generic<
+      tao::TAO_PEGTL_NAMESPACE::analysis::rule_type::ANY>;
+
+  template <tao::TAO_PEGTL_NAMESPACE::apply_mode,
+            tao::TAO_PEGTL_NAMESPACE::rewind_mode, template <typename...> class,
+            template <typename...> class, typename Input>
+  static bool match(Input &input, State &state) {
+    char const *const begin = input.current();
+    char const *end = begin;
+    if (state.structure) {
+      end = state.structure->textEnd(begin);
+    } else {
+      while (end != input.end() &&
+             ((*end > 0x1F && *end < 0x7F) || *end == '\t')) {
+        end++;
+      }
+    }
+    if (end == begin) {
+      return false;
+    }
+    input.bump_in_this_line(static_cast<size_t>(end - begin));
+    return true;
+  }
+};
+
 // [75]
-struct c_nb_comment_text : seq<one<'#'>, star<nb_char>> {};
+struct c_nb_comment_text : seq<one<'#'>, star<sor<nb_ascii_text, nb_char>>> {
+};
 // [76]
 struct b_comment : sor<b_non_content, eof> {};
 // [77]
@@ -572,6 +684,27 @@ struct l_comment : seq<s_separate_in_line, opt<c_nb_comment_text>,
 // [79]
 struct s_l_comments : seq<sor<s_b_comment, bol>, star<l_comment>> {};
 
+// ========================
+// = 6.9. Node Properties =
+// ========================
+
+// [101]
+struct ns_anchor_name;
+struct c_ns_anchor_property : seq<one<'&'>, ns_anchor_name> {};
+// [102]
+struct ns_anchor_char : seq<not_at<c_flow_indicator>, ns_char> {};
+// [103]
+struct ns_anchor_name : plus<ns_anchor_char> {};
+// [96] (Incomplete)
+struct c_ns_properties : c_ns_anchor_property {};
+
+// ====================
+// = 7.1. Alias Nodes =
+// ====================
+
+// [104]
+struct c_ns_alias_node : seq<one<'*'>, ns_anchor_name> {};
+
 // ====================
 // = 7.2. Empty Nodes =
 // ====================
@@ -681,12 +814,12 @@ struct ns_char_preceding {
   template <tao::TAO_PEGTL_NAMESPACE::apply_mode,
             tao::TAO_PEGTL_NAMESPACE::rewind_mode, template <typename...> class,
             template <typename...> class, typename Input>
-  static bool match(Input &input, State &) {
+  static bool match(Input &input, State &state) {
     if (input.current() == input.begin()) {
       return true;
     }
 
-    auto last = lastMatchedUtf32(input);
+    auto last = lastMatchedUtf32(input, state);
 
     if (last == '\n' || last == 0xFEFF || last == ' ' || last == '\t') {
       return false;
@@ -702,6 +835,42 @@ struct ns_plain_char
           seq<ns_char_preceding, one<'#'>>, seq<one<':'>, at<ns_plain_safe>>> {
 };
 
+/**
+ * @brief This rule matches a run of printable ASCII characters that continue
+ *        a plain scalar in every context.
+ *
+ * The rule matches the same text as `plus<ns_plain_char>` would, as long as
+ * the text contains neither spaces, tabs, the indicators `:#,[]{}` nor
+ * non-ASCII characters. It reads the length of the run from the structural
+ * index, which allows the parser to match most words of a plain scalar with
+ * a single rule invocation.
+ */
+struct ns_plain_ascii_text {
+  using analyze_t = tao::TAO_PEGTL_NAMESPACE::analysis::generic<
+      tao::TAO_PEGTL_NAMESPACE::analysis::rule_type::ANY>;
+
+  template <tao::TAO_PEGTL_NAMESPACE::apply_mode,
+            tao::TAO_PEGTL_NAMESPACE::rewind_mode, template <typename...> class,
+            template <typename...> class, typename Input>
+  static bool match(Input &input, State &state) {
+    char const *const begin = input.current();
+    char const *end = begin;
+    if (state.structure) {
+      end = state.structure->plainEnd(begin);
+    } else {
+      while (end != input.end() && *end > ' ' && *end < 0x7F &&
+             std::strchr(":#,[]{}", *end) == nullptr) {
+        end++;
+      }
+    }
+    if (end == begin) {
+      return false;
+    }
+    input.bump_in_this_line(static_cast<size_t>(end - begin));
+    return true;
+  }
+};
+
 // [131]
 struct ns_plain_multi_line;
 struct ns_plain_one_line;
@@ -709,7 +878,8 @@ struct ns_plain
     : if_context_else<State::Context::FLOW_OUT, State::Context::FLOW_IN,
                       ns_plain_multi_line, ns_plain_one_line> {};
 // [132]
-struct nb_ns_plain_in_line : star<seq<star<s_white>>, ns_plain_char> {};
+struct nb_ns_plain_in_line
+    : star<sor<ns_plain_ascii_text, seq<star<s_white>, ns_plain_char>>> {};
 // [133]
 struct ns_plain_one_line : seq<ns_plain_first, nb_ns_plain_in_line> {};
 // [134]
@@ -752,12 +922,110 @@ struct ns_flow_yaml_content : ns_plain {};
 struct c_flow_json_content : sor<c_single_quoted, c_double_quoted> {};
 // [158]
 struct ns_flow_content : sor<ns_flow_yaml_content, c_flow_json_content> {};
-// [159] (Incomplete)
-struct ns_flow_yaml_node : ns_flow_yaml_content {};
-// [160] (Incomplete)
-struct c_flow_json_node : c_flow_json_content {};
-// [161] (Incomplete)
-struct ns_flow_node : ns_flow_content {};
+// [159]
+struct ns_flow_yaml_node
+    : sor<c_ns_alias_node, ns_flow_yaml_content,
+          seq<c_ns_properties,
+              sor<seq<s_separate, ns_flow_yaml_content>, e_scalar>>> {};
+// [160]
+struct c_flow_json_node
+    : seq<opt<c_ns_properties, s_separate>, c_flow_json_content> {};
+// [161]
+struct ns_flow_node
+    : sor<c_ns_alias_node, ns_flow_content,
+          seq<c_ns_properties,
+              sor<seq<s_separate, ns_flow_content>, e_scalar>>> {};
+
+// ============================
+// = 8.1. Block Scalar Styles =
+// ============================
+
+/**
+ * @brief This rule matches a literal ([170]) or folded ([174]) block scalar
+ *        including the block header ([162]).
+ *
+ * Block scalars store large values such as scripts or certificates. Instead
+ * of matching their content character by character, the rule scans the
+ * input line by line. It detects the indentation of the content once and
+ * stops at the first line that is not indented enough. The listener applies
+ * chomping and folding when it converts the text of the scalar.
+ */
+struct c_l_block_scalar {
+  using analyze_t = tao::TAO_PEGTL_NAMESPACE::analysis::generic<
+      tao::TAO_PEGTL_NAMESPACE::analysis::rule_type::ANY>;
+
+  template <tao::TAO_PEGTL_NAMESPACE::apply_mode,
+            tao::TAO_PEGTL_NAMESPACE::rewind_mode, template <typename...> class,
+            template <typename...> class, typename Input>
+  static bool match(Input &input, State &state) {
+    char const *const begin = input.current();
+    char const *const end = input.end();
+    if (begin == end || (*begin != '|' && *begin != '>')) {
+      return false;
+    }
+
+    // [163] – [165]: Indentation and chomping indicator in any order
+    char const *position = begin + 1;
+    long long indicator = 0;
+    bool chomping = false;
+    for (int part = 0; part < 2 && position != end; part++) {
+      if (indicator == 0 && *position >= '1' && *position <= '9') {
+        indicator = *position++ - '0';
+      } else if (!chomping && (*position == '+' || *position == '-')) {
+        chomping = true;
+        position++;
+      }
+    }
+
+    // [77]: The header ends with an optional comment and a line break
+    char const *separator = position;
+    while (position != end && (*position == ' ' || *position == '\t')) {
+      position++;
+    }
+    if (position != end && *position != '\r' && *position != '\n' &&
+        (*position != '#' || position == separator)) {
+      return false;
+    }
+    position = nextLine(position, end, state);
+
+    long long parent = state.indentation.back();
+    long long indentation = -1;
+    if (indicator > 0) {
+      indentation = parent + indicator < 0 ? 0 : parent + indicator;
+      state.blockIndentation[begin] = static_cast<size_t>(indentation);
+    }
+
+    // [171] & [175]: Content lines and empty lines
+    while (position != end) {
+      char const *next = nextLine(position, end, state);
+      long long spaces = leadingSpaces(position, next, next - position, state);
+      char const *character = position + spaces;
+      while (character != next &&
+             (*character == ' ' || *character == '\t' ||
+              *character == '\r' || *character == '\n')) {
+        character++;
+      }
+      if (character != next) {
+        if (indentation < 0) {
+          // [182]: Auto-detected indentation (at least one space more than
+          // the parent node)
+          if (spaces <= parent) {
+            break;
+          }
+          indentation = spaces;
+        }
+        if (spaces < indentation ||
+            (indentation == 0 && isDocumentMarker(position, next))) {
+          break;
+        }
+      }
+      position = next;
+    }
+
+    input.bump(static_cast<size_t>(position - begin));
+    return true;
+  }
+};
 
 // ================================
 // = 8.2. Block Collection Styles =
@@ -837,13 +1105,23 @@ struct s_l_plus_flow_in_block
               State::Context::FLOW_OUT, seq<s_separate, ns_flow_node>>>,
           s_l_comments> {};
 
-// [198] (Incomplete)
+// [198]
+struct s_l_plus_block_scalar;
 struct s_l_plus_block_collection;
-struct s_l_plus_block_in_block : sor<s_l_plus_block_collection> {};
+struct s_l_plus_block_in_block
+    : sor<s_l_plus_block_scalar, s_l_plus_block_collection> {};
+// [199] (Modified)
+struct c_l_block_scalar_node
+    : seq<opt<with_updated_indent_plus_one<c_ns_properties, s_separate>>,
+          c_l_block_scalar> {};
+struct s_l_plus_block_scalar
+    : seq<with_updated_indent_plus_one<s_separate>, c_l_block_scalar_node,
+          star<l_comment>> {};
 // [200] (Incomplete)
 template <typename... Rules> struct seq_spaces;
 struct s_l_plus_block_collection
-    : seq<s_l_comments,
+    : seq<opt<with_updated_indent_plus_one<s_separate, c_ns_properties>>,
+          s_l_comments,
           sor<seq_spaces<l_plus_block_sequence>, l_plus_block_mapping>> {};
 
 // [201]
@@ -885,14 +1163,42 @@ struct l_document_suffix : seq<c_document_end, s_l_comments> {};
 struct c_forbidden : seq<bol, sor<c_directives_end, c_document_end>,
                          sor<b_char, s_white, eof>> {};
 
+/**
+ * @brief This rule stores the end of the current document.
+ *
+ * The content of a bare document must not contain a line that starts with
+ * a document marker (`c_forbidden`). Instead of checking the remaining input
+ * for such a line at every location, the rule looks for the first marker
+ * line once and stores its location in the state. The rule `s_indent`, which
+ * every line of block and flow content has to match, then stops at this
+ * boundary. The rule fails if the document would start with a marker.
+ */
+struct document_boundary {
+  using analyze_t = tao::TAO_PEGTL_NAMESPACE::analysis::generic<
+      tao::TAO_PEGTL_NAMESPACE::analysis::rule_type::OPT>;
+
+  template <tao::TAO_PEGTL_NAMESPACE::apply_mode,
+            tao::TAO_PEGTL_NAMESPACE::rewind_mode, template <typename...> class,
+            template <typename...> class, typename Input>
+  static bool match(Input &input, State &state) {
+    char const *const end = input.end();
+    char const *line = input.current();
+    while (line != end && !isDocumentMarker(line, end)) {
+      line = nextLine(line, end, state);
+    }
+    state.documentEnd = line != end ? line : nullptr;
+    return state.documentEnd != input.current();
+  }
+};
+
 // =========================
 // = 9.1.3. Bare Documents =
 // =========================
 
 // [207]
-struct l_bare_document : with_updated_context<State::Context::BLOCK_IN,
-                                              not_at<until<c_forbidden, any>>,
-                                              s_l_plus_block_node> {};
+struct l_bare_document
+    : with_updated_context<State::Context::BLOCK_IN, document_boundary,
+                           s_l_plus_block_node> {};
 
 // ================
 // = 9.2. Streams =
@@ -910,15 +1216,17 @@ struct yaml : if_must<l_yaml_stream, eof> {};
 
 template <> struct action<c_flow_json_node> {
   template <typename Input>
-  static void apply(const Input &input __attribute__((unused)), State &) {
-    LOGF("`c_flow_json_node`: “{}”", input.string());
+  static void apply(const Input &input __attribute__((unused)),
+                    State &state __attribute__((unused))) {
+    LOGF(state, "`c_flow_json_node`: “{}”", input.string());
   }
 };
 
 template <> struct action<ns_flow_node> {
   template <typename Input>
-  static void apply(const Input &input __attribute__((unused)), State &) {
-    LOGF("`ns_flow_node`: “{}”", input.string());
+  static void apply(const Input &input __attribute__((unused)),
+                    State &state __attribute__((unused))) {
+    LOGF(state, "`ns_flow_node`: “{}”", input.string());
   }
 };
 
@@ -932,7 +1240,8 @@ template <typename Rule>
 using selector = tao::TAO_PEGTL_NAMESPACE::parse_tree::selector<
     Rule,
     tao::TAO_PEGTL_NAMESPACE::parse_tree::apply_store_content::to<
-        c_flow_json_node, ns_flow_yaml_node, ns_flow_node, e_node>,
+        c_flow_json_node, ns_flow_yaml_node, ns_flow_node, e_node,
+        c_l_block_scalar_node, c_ns_anchor_property, c_ns_alias_node>,
     tao::TAO_PEGTL_NAMESPACE::parse_tree::apply_remove_content::to<
         ns_l_block_map_implicit_entry, ns_s_block_map_implicit_key,
         c_l_block_map_implicit_value, l_plus_block_sequence,
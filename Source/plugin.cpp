@@ -0,0 +1,195 @@
+/**
+ * @file
+ *
+ * @brief This file contains the Elektra storage plugin interface.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <exception>
+#include <new>
+
+#include <kdb.hpp>
+#include <kdberrors.h>
+
+#include "cache.hpp"
+#include "emitter.hpp"
+#include "plugin.hpp"
+
+using ckdb::keyNew;
+using std::exception;
+
+using CppKey = kdb::Key;
+using CppKeySet = kdb::KeySet;
+
+using yaypeg::Cache;
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief This function returns a key set containing the contract of this
+ *        plugin.
+ *
+ * @return A contract describing the functionality of this plugin
+ */
+CppKeySet getContract() {
+  return CppKeySet{
+      30,
+      keyNew("system/elektra/modules/yaypeg", KEY_VALUE,
+             "Storage plugin for YAML files based on a PEG parser", KEY_END),
+      keyNew("system/elektra/modules/yaypeg/exports", KEY_END),
+      keyNew("system/elektra/modules/yaypeg/exports/open", KEY_FUNC,
+             elektraYaypegOpen, KEY_END),
+      keyNew("system/elektra/modules/yaypeg/exports/close", KEY_FUNC,
+             elektraYaypegClose, KEY_END),
+      keyNew("system/elektra/modules/yaypeg/exports/get", KEY_FUNC,
+             elektraYaypegGet, KEY_END),
+      keyNew("system/elektra/modules/yaypeg/exports/set", KEY_FUNC,
+             elektraYaypegSet, KEY_END),
+      keyNew("system/elektra/modules/yaypeg/infos/provides", KEY_VALUE,
+             "storage/yaml", KEY_END),
+      keyNew("system/elektra/modules/yaypeg/infos/placements", KEY_VALUE,
+             "getstorage setstorage", KEY_END),
+      keyNew("system/elektra/modules/yaypeg/infos/description", KEY_VALUE,
+             "Converts YAML files to keys and keys back to YAML. The plugin "
+             "keeps the keys of every file it read and only parses a file "
+             "again if its size, modification time or content changed.",
+             KEY_END),
+      KS_END};
+}
+
+} // end namespace
+
+// -- Plugin -------------------------------------------------------------------
+
+extern "C" {
+
+/**
+ * @brief This function initializes the plugin data (a cache of converted
+ *        files).
+ *
+ * @param handle This argument stores the handle of this plugin.
+ * @param errorKey The function stores errors in this key.
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS if initialization was successful
+ * @retval ELEKTRA_PLUGIN_STATUS_ERROR if initialization failed
+ */
+int elektraYaypegOpen(Plugin *handle, Key *errorKey ELEKTRA_UNUSED) {
+  auto cache = new (std::nothrow) Cache{};
+  if (!cache) {
+    return ELEKTRA_PLUGIN_STATUS_ERROR;
+  }
+  elektraPluginSetData(handle, cache);
+  return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief This function releases the plugin data.
+ *
+ * @param handle This argument stores the handle of this plugin.
+ * @param errorKey The function stores errors in this key.
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS
+ */
+int elektraYaypegClose(Plugin *handle, Key *errorKey ELEKTRA_UNUSED) {
+  delete static_cast<Cache *>(elektraPluginGetData(handle));
+  elektraPluginSetData(handle, nullptr);
+  return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+}
+
+/**
+ * @brief This function converts the YAML file stored in the value of
+ *        `parentKey` to keys and adds them to `returned`.
+ *
+ * Every call of this function first checks if the file changed since the
+ * last call. If that is not the case, then the function returns the key set
+ * of the last conversion instead of parsing the file again. A file that does
+ * not exist yet contains no keys.
+ *
+ * @param handle This argument stores the handle of this plugin.
+ * @param returned The function adds the converted keys to this key set.
+ * @param parentKey This key stores the path of the YAML file. The function
+ *                  also uses this key to emit error information.
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS if the function changed `returned`
+ * @retval ELEKTRA_PLUGIN_STATUS_NO_UPDATE if the function did not change
+ *         `returned`
+ * @retval ELEKTRA_PLUGIN_STATUS_ERROR if the conversion failed
+ */
+int elektraYaypegGet(Plugin *handle, KeySet *returned, Key *parentKey) {
+  CppKeySet keys{returned};
+  CppKey parent{parentKey};
+
+  if (parent.getName() == "system/elektra/modules/yaypeg") {
+    keys.append(getContract());
+    parent.release();
+    keys.release();
+    return ELEKTRA_PLUGIN_STATUS_SUCCESS;
+  }
+
+  int status = ELEKTRA_PLUGIN_STATUS_ERROR;
+  try {
+    auto cache = static_cast<Cache *>(elektraPluginGetData(handle));
+    CppKeySet converted = cache ? cache->get(parent, parent.getString())
+                                : Cache{}.get(parent, parent.getString());
+    status = converted.size() > 0 ? ELEKTRA_PLUGIN_STATUS_SUCCESS
+                                  : ELEKTRA_PLUGIN_STATUS_NO_UPDATE;
+    keys.append(converted);
+  } catch (exception const &error) {
+    ELEKTRA_SET_ERROR(ELEKTRA_ERROR_PARSE, parent.getKey(), error.what());
+  }
+
+  parent.release();
+  keys.release();
+  return status;
+}
+
+/**
+ * @brief This function stores the keys of `returned` in the YAML file stored
+ *        in the value of `parentKey`.
+ *
+ * @param handle This argument stores the handle of this plugin.
+ * @param returned This key set contains the keys the function saves.
+ * @param parentKey This key stores the path of the YAML file. The function
+ *                  also uses this key to emit error information.
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS if the function wrote the file
+ * @retval ELEKTRA_PLUGIN_STATUS_ERROR if writing the file failed
+ */
+int elektraYaypegSet(Plugin *handle ELEKTRA_UNUSED, KeySet *returned,
+                     Key *parentKey) {
+  CppKeySet keys{returned};
+  CppKey parent{parentKey};
+
+  int status = ELEKTRA_PLUGIN_STATUS_ERROR;
+  try {
+    yaypeg::emitFile(keys, parent, parent.getString());
+    status = ELEKTRA_PLUGIN_STATUS_SUCCESS;
+  } catch (exception const &error) {
+    ELEKTRA_SET_ERROR(ELEKTRA_ERROR_COULD_NOT_WRITE, parent.getKey(),
+                      error.what());
+  }
+
+  parent.release();
+  keys.release();
+  return status;
+}
+
+/**
+ * @brief This function exports the interface of the plugin.
+ *
+ * @return A plugin handle containing the exported functions
+ */
+Plugin *ELEKTRA_PLUGIN_EXPORT(yaypeg) {
+  return elektraPluginExport("yaypeg", ELEKTRA_PLUGIN_OPEN, &elektraYaypegOpen,
+                             ELEKTRA_PLUGIN_CLOSE, &elektraYaypegClose,
+                             ELEKTRA_PLUGIN_GET, &elektraYaypegGet,
+                             ELEKTRA_PLUGIN_SET, &elektraYaypegSet,
+                             ELEKTRA_PLUGIN_END);
+}
+
+} // end extern "C"
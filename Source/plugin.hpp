@@ -0,0 +1,86 @@
+/**
+ * @file
+ *
+ * @brief This file contains the declaration of the Elektra storage plugin
+ *        interface.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_PLUGIN_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_PLUGIN_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <kdbplugin.h>
+
+// -- Functions ----------------------------------------------------------------
+
+using ckdb::Key;
+using ckdb::KeySet;
+using ckdb::Plugin;
+
+extern "C" {
+
+/**
+ * @brief This function initializes the plugin data (a cache of converted
+ *        files).
+ *
+ * @param handle This argument stores the handle of this plugin.
+ * @param errorKey The function stores errors in this key.
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS if initialization was successful
+ * @retval ELEKTRA_PLUGIN_STATUS_ERROR if initialization failed
+ */
+int elektraYaypegOpen(Plugin *handle, Key *errorKey);
+
+/**
+ * @brief This function releases the plugin data.
+ *
+ * @param handle This argument stores the handle of this plugin.
+ * @param errorKey The function stores errors in this key.
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS
+ */
+int elektraYaypegClose(Plugin *handle, Key *errorKey);
+
+/**
+ * @brief This function converts the YAML file stored in the value of
+ *        `parentKey` to keys and adds them to `returned`.
+ *
+ * @param handle This argument stores the handle of this plugin.
+ * @param returned The function adds the converted keys to this key set.
+ * @param parentKey This key stores the path of the YAML file. The function
+ *                  also uses this key to emit error information.
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS if the function changed `returned`
+ * @retval ELEKTRA_PLUGIN_STATUS_NO_UPDATE if the function did not change
+ *         `returned`
+ * @retval ELEKTRA_PLUGIN_STATUS_ERROR if the conversion failed
+ */
+int elektraYaypegGet(Plugin *handle, KeySet *returned, Key *parentKey);
+
+/**
+ * @brief This function stores the keys of `returned` in the YAML file stored
+ *        in the value of `parentKey`.
+ *
+ * @param handle This argument stores the handle of this plugin.
+ * @param returned This key set contains the keys the function saves.
+ * @param parentKey This key stores the path of the YAML file. The function
+ *                  also uses this key to emit error information.
+ *
+ * @retval ELEKTRA_PLUGIN_STATUS_SUCCESS if the function wrote the file
+ * @retval ELEKTRA_PLUGIN_STATUS_ERROR if writing the file failed
+ */
+int elektraYaypegSet(Plugin *handle, KeySet *returned, Key *parentKey);
+
+/**
+ * @brief This function exports the interface of the plugin.
+ *
+ * @return A plugin handle containing the exported functions
+ */
+Plugin *ELEKTRA_PLUGIN_EXPORT(yaypeg);
+
+} // end extern "C"
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_PLUGIN_HPP
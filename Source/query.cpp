@@ -0,0 +1,530 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions that convert only selected keys of a
+ *        YAML document.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstring>
+
+#include "convert.hpp"
+#include "encoding.hpp"
+#include "file.hpp"
+#include "parser.hpp"
+#include "query.hpp"
+#include "structure.hpp"
+
+using kdb::Key;
+using kdb::KeySet;
+using std::string;
+using std::vector;
+
+using yaypeg::Options;
+using yaypeg::StructuralIndex;
+
+// -- Class --------------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief This function splits a key path into its parts.
+ *
+ * @param path This text stores a key path such as `server/port`. A backslash
+ *             escapes the following character.
+ *
+ * @return The unescaped parts of `path`
+ */
+vector<string> split(string const &path) {
+  vector<string> parts{""};
+  for (size_t position = 0; position < path.size(); position++) {
+    if (path[position] == '\\' && position + 1 < path.size()) {
+      parts.back() += path[++position];
+    } else if (path[position] != '/') {
+      parts.back() += path[position];
+    } else if (!parts.back().empty()) {
+      parts.emplace_back();
+    }
+  }
+  if (parts.back().empty()) {
+    parts.pop_back();
+  }
+  return parts;
+}
+
+/**
+ * @brief This function checks if a location contains a block sequence
+ *        indicator.
+ *
+ * @param position This variable stores the location the function checks.
+ * @param end This variable stores the end of the input.
+ *
+ * @retval true If `position` stores a `-` followed by white space
+ * @retval false Otherwise
+ */
+bool isEntryIndicator(char const *position, char const *end) {
+  return position != end && *position == '-' &&
+         (position + 1 == end || strchr(" \t\r\n", position[1]) != nullptr);
+}
+
+/**
+ * @brief This class converts the parts of a YAML document that contain the
+ *        requested keys.
+ */
+class Query {
+  /** @brief This struct stores a requested key. */
+  struct Request {
+    /** @brief This vector stores the parts of the path of the key below the
+     *         parent key. */
+    vector<string> parts;
+    /** @brief This key stores the name of the requested key. */
+    Key key;
+    /** @brief This variable specifies if the query already converted all
+     *         keys of the request. */
+    bool resolved;
+  };
+
+  /** @brief This struct stores the location and name of an entry of a block
+   *         collection. */
+  struct Entry {
+    /** @brief This variable stores the start of the first line of the
+     *         entry. */
+    char const *begin;
+    /** @brief This variable stores the start of the first line after the
+     *         entry. */
+    char const *end;
+    /** @brief This variable stores the location after the `:` of a mapping
+     *         entry, or `nullptr` for sequence entries. */
+    char const *value;
+    /** @brief This text stores the key or the array index of the entry. */
+    string name;
+  };
+
+  /** @brief This key specifies the parent of all converted keys. */
+  Key const &parent;
+  /** @brief This variable stores the start of the YAML data. */
+  char const *data;
+  /** @brief This number specifies the length of `data` in bytes. */
+  size_t size;
+  /** @brief This text describes the origin of `data`. */
+  string const &source;
+  /** @brief This argument specifies options for the conversion. */
+  Options const &options;
+  /** @brief This index stores the start of lines and indentation. */
+  StructuralIndex index;
+  /** @brief This vector stores the requested keys. */
+  vector<Request> requests;
+  /** @brief This number stores how many requests are not resolved. */
+  size_t unresolved;
+  /** @brief This key set stores the converted keys that match a request. */
+  KeySet result;
+
+  /**
+   * @brief This method returns the first line that contains content.
+   *
+   * @param line This variable stores the start of the first line the method
+   *             checks.
+   * @param end This variable stores the end of the region the method checks.
+   *
+   * @return The start of the first line at or after `line` that is neither
+   *         empty nor only contains a comment, or `end`
+   */
+  char const *contentLine(char const *line, char const *end) const {
+    while (line != end) {
+      char const *character = line + index.spaces(line);
+      while (character != end && (*character == ' ' || *character == '\t')) {
+        character++;
+      }
+      if (character != end && strchr("\r\n#", *character) == nullptr) {
+        return line;
+      }
+      line = index.nextLine(line);
+    }
+    return end;
+  }
+
+  /**
+   * @brief This method reads the key of a mapping entry.
+   *
+   * The method only accepts keys that do not need the grammar: single line
+   * plain scalars and quoted scalars without escape sequences.
+   *
+   * @param start This variable stores the first character of the key.
+   * @param entry The method stores the key and the start of the value in
+   *              this entry.
+   *
+   * @retval true If the line starting at `start` contains a simple key
+   * @retval false Otherwise
+   */
+  bool readKey(char const *start, Entry &entry) const {
+    char const *const end = index.nextLine(start);
+    char const *position = start;
+    char const *last;
+
+    if (*start == '"' || *start == '\'') {
+      position++;
+      while (position != end && *position != *start && *position != '\\' &&
+             *position != '\n') {
+        position++;
+      }
+      if (position == end || *position != *start ||
+          (position + 1 != end && position[1] == *start)) {
+        return false;
+      }
+      last = position++;
+      start++;
+      while (position != end && (*position == ' ' || *position == '\t')) {
+        position++;
+      }
+      if (position == end || *position != ':') {
+        return false;
+      }
+    } else {
+      if (strchr("?:&!*{}[]|>%@`,#\t\r\n", *start) != nullptr) {
+        return false;
+      }
+      for (; position != end; position++) {
+        if (*position == '\n' ||
+            (*position == '#' && strchr(" \t", position[-1]) != nullptr)) {
+          return false;
+        }
+        if (*position == ':' && (position + 1 == end ||
+                                 strchr(" \t\r\n", position[1]) != nullptr)) {
+          break;
+        }
+      }
+      if (position == end) {
+        return false;
+      }
+      last = position;
+      while (last != start && (last[-1] == ' ' || last[-1] == '\t')) {
+        last--;
+      }
+    }
+
+    entry.name.assign(start, static_cast<size_t>(last - start));
+    entry.value = position + 1;
+    return true;
+  }
+
+  /**
+   * @brief This method splits a block collection into its entries.
+   *
+   * @param begin This variable stores the start of the first line of the
+   *              collection.
+   * @param end This variable stores the end of the collection.
+   * @param entries The method stores the entries of the collection in this
+   *                vector.
+   *
+   * @retval true If the region contains a block mapping with simple keys or
+   *              a block sequence
+   * @retval false Otherwise
+   */
+  bool splitEntries(char const *begin, char const *end,
+                    vector<Entry> &entries) const {
+    char const *line = contentLine(begin, end);
+    if (line == end) {
+      return true;
+    }
+    size_t indentation = index.spaces(line);
+    bool sequence = isEntryIndicator(line + indentation, end);
+
+    for (; line != end; line = contentLine(index.nextLine(line), end)) {
+      size_t spaces = index.spaces(line);
+      char const *start = line + spaces;
+      if (spaces < indentation || isDocumentMarker(line, end)) {
+        return false;
+      }
+      // Values of a mapping entry may be sequences on the same level
+      if (spaces > indentation ||
+          (!sequence && isEntryIndicator(start, end))) {
+        continue;
+      }
+
+      if (!entries.empty()) {
+        entries.back().end = line;
+      }
+      Entry entry{line, end, nullptr, ""};
+      if (sequence) {
+        if (!isEntryIndicator(start, end)) {
+          return false;
+        }
+        entry.name = std::to_string(entries.size());
+      } else if (!readKey(start, entry)) {
+        return false;
+      }
+      entries.push_back(entry);
+    }
+    return true;
+  }
+
+  /**
+   * @brief This method checks if a part of a path specifies an array index.
+   *
+   * @param part This text stores a part of a path such as `#_10`.
+   * @param index This text stores an array index such as `10`.
+   *
+   * @retval true If `part` is the Elektra array name for `index`
+   * @retval false Otherwise
+   */
+  static bool isArrayName(string const &part, string const &index) {
+    return part.size() == 2 * index.size() && part[0] == '#' &&
+           part.compare(1, index.size() - 1, string(index.size() - 1, '_')) ==
+               0 &&
+           part.compare(index.size(), string::npos, index) == 0;
+  }
+
+  /**
+   * @brief This method adds the keys that match the given requests to the
+   *        result.
+   *
+   * @param keys This key set stores the converted keys.
+   * @param matching This vector stores the indices of the requests.
+   */
+  void collect(KeySet const &keys, vector<size_t> const &matching) {
+    for (auto key : keys) {
+      for (auto request : matching) {
+        if (key.isBelowOrSame(requests[request].key)) {
+          result.append(key);
+          break;
+        }
+      }
+    }
+    for (auto request : matching) {
+      if (!requests[request].resolved) {
+        requests[request].resolved = true;
+        unresolved--;
+      }
+    }
+  }
+
+  /**
+   * @brief This method converts a single entry of a block collection.
+   *
+   * @param entry This argument stores the entry the method converts.
+   * @param container This key stores the name of the collection.
+   * @param element This key stores the name of the entry.
+   * @param matching This vector stores the indices of the requests that
+   *                 contain the entry.
+   */
+  void convert(Entry const &entry, Key const &container, Key const &element,
+               vector<size_t> const &matching) {
+    KeySet keys = yaypeg::convertBuffer(
+        container, entry.begin, static_cast<size_t>(entry.end - entry.begin),
+        source, options);
+    if (entry.value) {
+      collect(keys, matching);
+      return;
+    }
+
+    // The parser stores a single sequence entry as first array element
+    Key first = container.dup();
+    first.addBaseName("#0");
+    string const from = first.getName();
+    KeySet renamed;
+    for (auto key : keys) {
+      string name = key.getName();
+      if (name.compare(0, from.size(), from) == 0 &&
+          (name.size() == from.size() || name[from.size()] == '/')) {
+        Key copy = key.dup();
+        copy.setName(element.getName() + name.substr(from.size()));
+        renamed.append(copy);
+      }
+    }
+    collect(renamed, matching);
+  }
+
+  /**
+   * @brief This method converts the entries of a block collection that
+   *        contain requested keys.
+   *
+   * @param begin This variable stores the start of the collection.
+   * @param end This variable stores the end of the collection.
+   * @param container This key stores the name of the collection.
+   * @param depth This number specifies how many parts of the requested
+   *              paths `container` contains.
+   * @param active This vector stores the indices of the requests that start
+   *               with the name of `container`.
+   *
+   * @retval true If the method converted all matching entries
+   * @retval false If the region does not contain a block collection the
+   *               method is able to split into entries
+   */
+  bool select(char const *begin, char const *end, Key const &container,
+              size_t depth, vector<size_t> const &active) {
+    vector<Entry> found;
+    if (!splitEntries(begin, end, found)) {
+      return false;
+    }
+
+    for (auto const &entry : found) {
+      vector<size_t> matching;
+      bool whole = false;
+      for (auto request : active) {
+        auto const &parts = requests[request].parts;
+        if (requests[request].resolved ||
+            (entry.value ? parts[depth] != entry.name
+                         : !isArrayName(parts[depth], entry.name))) {
+          continue;
+        }
+        matching.push_back(request);
+        whole = whole || parts.size() == depth + 1;
+      }
+      if (matching.empty()) {
+        continue;
+      }
+
+      // Only descend into values that start on the next line. The last entry
+      // of the data might end directly after the `:`.
+      char const *value = entry.value;
+      while (value && value < entry.end && (*value == ' ' || *value == '\t')) {
+        value++;
+      }
+      Key child = container.dup();
+      child.addBaseName(requests[matching.front()].parts[depth]);
+      if (whole || !value || value >= entry.end ||
+          strchr("#\r\n", *value) == nullptr ||
+          !select(index.nextLine(entry.begin), entry.end, child, depth + 1,
+                  matching)) {
+        convert(entry, container, child, matching);
+      }
+      // Keys are unique: No other entry contains the requested paths
+      collect(KeySet{}, matching);
+      if (unresolved == 0) {
+        break;
+      }
+    }
+    return true;
+  }
+
+public:
+  /**
+   * @brief This constructor creates a query for the given data.
+   *
+   * @param parentKey This key specifies the parent of all converted keys.
+   * @param input This variable stores the start of the YAML data.
+   * @param length This number specifies the length of `input` in bytes.
+   * @param origin This text describes the origin of `input`.
+   * @param paths This vector stores the paths of the requested keys.
+   * @param settings This argument specifies options for the conversion.
+   */
+  Query(Key const &parentKey, char const *input, size_t length,
+        string const &origin, vector<string> const &paths,
+        Options const &settings)
+      : parent{parentKey}, data{input}, size{length}, source{origin},
+        options{settings}, index{input, length}, unresolved{paths.size()} {
+    for (auto const &path : paths) {
+      requests.push_back(
+          Request{split(path), Key{parent.getName() + "/" + path, KEY_END},
+                  false});
+    }
+  }
+
+  /**
+   * @brief This method converts the requested keys.
+   *
+   * @return A key set containing the keys that are equal to or below one of
+   *         the requested paths
+   */
+  KeySet run() {
+    using tao::TAO_PEGTL_NAMESPACE::parse_error;
+
+    vector<size_t> all;
+    bool document = false;
+    for (size_t request = 0; request < requests.size(); request++) {
+      all.push_back(request);
+      document = document || requests[request].parts.empty();
+    }
+
+    try {
+      if (!document && select(data, data + size, parent, 0, all)) {
+        return result;
+      }
+    } catch (parse_error const &) {
+      // An entry might only be valid as part of the whole document (e.g. if
+      // it contains an alias for an anchor in a skipped entry).
+    } catch (yaypeg::limit_error const &) {
+      // The conversion of the whole document reports the limit, if the
+      // document also exceeds it
+    }
+
+    result.clear();
+    unresolved = requests.size();
+    for (auto &request : requests) {
+      request.resolved = false;
+    }
+    collect(yaypeg::convertBuffer(parent, data, size, source, options), all);
+    return result;
+  }
+};
+
+} // namespace
+
+// -- Functions ----------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This function converts the keys of the given YAML data that match
+ *        one of the given paths.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param data This variable stores the start of the YAML data.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param source This text describes the origin of `data`. The function uses
+ *               it in error messages.
+ * @param paths This vector stores the paths of the requested keys relative
+ *              to `parent` (e.g. `server/port` or `features/#3`). A path
+ *              also selects all keys below it.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @throws parse_error if the parts of the data the function converts do not
+ *         contain (supported) YAML data
+ *
+ * @return A key set containing the keys that are equal to or below one of
+ *         the requested paths
+ */
+KeySet queryBuffer(Key const &parent, char const *data, size_t size,
+                   string const &source, vector<string> const &paths,
+                   Options const &options) {
+  // The query splits the input at line feeds, which only works for UTF-8
+  Encoding encoding = detectEncoding(data, size);
+  if (encoding != Encoding::UTF_8) {
+    string text = toUtf8(data, size, encoding, source);
+    return Query{parent, text.data(), text.size(), source, paths, options}
+        .run();
+  }
+  return Query{parent, data, size, source, paths, options}.run();
+}
+
+/**
+ * @brief This function converts the keys of the given YAML file that match
+ *        one of the given paths.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param filename This parameter stores the path of the YAML file this
+ *                 function converts.
+ * @param paths This vector stores the paths of the requested keys relative
+ *              to `parent`. A path also selects all keys below it.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @throws std::system_error if the function is unable to read `filename`
+ * @throws parse_error if the parts of the file the function converts do not
+ *         contain (supported) YAML data
+ *
+ * @return A key set containing the keys that are equal to or below one of
+ *         the requested paths
+ */
+KeySet queryFile(Key const &parent, string const &filename,
+                 vector<string> const &paths, Options const &options) {
+  MappedFile file{filename};
+  return queryBuffer(parent, file.data(), file.size(), filename, paths,
+                     options);
+}
+
+} // namespace yaypeg
@@ -0,0 +1,87 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions that convert only selected keys of a
+ *        YAML document.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_QUERY_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_QUERY_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+
+#include <kdb.hpp>
+
+#include "options.hpp"
+
+// -- Functions ----------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This function converts the keys of the given YAML data that match
+ *        one of the given paths.
+ *
+ * The function splits block mappings and block sequences into their entries
+ * by looking at the indentation of each line. It only parses entries whose
+ * key (or array index) is part of a requested path and skips all other
+ * entries without matching them against the grammar. The function stops as
+ * soon as it found all requested paths. Documents that do not start with a
+ * block collection of simple keys are converted completely.
+ *
+ * Since the function skips parts of the input, it does not report syntax
+ * errors inside these parts.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param data This variable stores the start of the YAML data.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param source This text describes the origin of `data`. The function uses
+ *               it in error messages.
+ * @param paths This vector stores the paths of the requested keys relative
+ *              to `parent` (e.g. `server/port` or `features/#3`). A path
+ *              also selects all keys below it.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @throws parse_error if the parts of the data the function converts do not
+ *         contain (supported) YAML data
+ *
+ * @return A key set containing the keys that are equal to or below one of
+ *         the requested paths
+ */
+kdb::KeySet queryBuffer(kdb::Key const &parent, char const *data, size_t size,
+                        std::string const &source,
+                        std::vector<std::string> const &paths,
+                        Options const &options = Options{});
+
+/**
+ * @brief This function converts the keys of the given YAML file that match
+ *        one of the given paths.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param filename This parameter stores the path of the YAML file this
+ *                 function converts.
+ * @param paths This vector stores the paths of the requested keys relative
+ *              to `parent`. A path also selects all keys below it.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @throws std::system_error if the function is unable to read `filename`
+ * @throws parse_error if the parts of the file the function converts do not
+ *         contain (supported) YAML data
+ *
+ * @return A key set containing the keys that are equal to or below one of
+ *         the requested paths
+ */
+kdb::KeySet queryFile(kdb::Key const &parent, std::string const &filename,
+                      std::vector<std::string> const &paths,
+                      Options const &options = Options{});
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_QUERY_HPP
@@ -0,0 +1,173 @@
+/**
+ * @file
+ *
+ * @brief This file contains a tool that replays recorded listener traces.
+ *
+ * The tool calls the methods of a listener in the order stored in a trace
+ * file, without reading or parsing any YAML data. It either measures how
+ * fast the listener creates the keys, or prints the keys.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <unistd.h>
+
+#include <kdb.hpp>
+
+#include "file.hpp"
+#include "listener.hpp"
+#include "options.hpp"
+#include "trace.hpp"
+#include "writer.hpp"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::exception;
+using std::string;
+using std::string_view;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+using kdb::Key;
+using kdb::KeySet;
+
+using yaypeg::Listener;
+using yaypeg::MappedFile;
+using yaypeg::replayTrace;
+using yaypeg::Writer;
+
+// -- Constants ----------------------------------------------------------------
+
+namespace {
+
+/** @brief This constant specifies how often the tool replays every trace by
+ *         default. */
+constexpr size_t defaultIterations = 20;
+
+// -- Functions ----------------------------------------------------------------
+
+/**
+ * @brief This function replays a trace and prints the resulting keys.
+ *
+ * @param filename This text stores the path of the trace file.
+ * @param writer The function writes one `name: value` line per key to this
+ *               output.
+ *
+ * @throws system_error if the function is unable to read `filename`
+ * @throws runtime_error if the file does not contain a valid trace
+ */
+void print(string const &filename, Writer &writer) {
+  MappedFile file{filename};
+  Listener listener{Key{"user", KEY_END}};
+  replayTrace(file.data(), file.size(), listener);
+
+  for (auto key : listener.getKeySet()) {
+    ckdb::Key *handle = key.getKey();
+    ssize_t size = ckdb::keyGetValueSize(handle);
+    writer.write(ckdb::keyName(handle));
+    writer.put(':');
+    if (size > 1) {
+      writer.put(' ');
+      writer.write(string_view{ckdb::keyString(handle),
+                               static_cast<size_t>(size - 1)});
+    }
+    writer.put('\n');
+  }
+}
+
+/**
+ * @brief This function measures how fast a listener replays a trace.
+ *
+ * @param filename This text stores the path of the trace file.
+ * @param iterations This number specifies how often the function replays
+ *                   the trace.
+ *
+ * @throws system_error if the function is unable to read `filename`
+ * @throws runtime_error if the file does not contain a valid trace
+ */
+void benchmark(string const &filename, size_t iterations) {
+  MappedFile file{filename};
+  Key parent{"user", KEY_END};
+
+  double fastest = 0;
+  size_t calls = 0;
+  size_t keys = 0;
+  for (size_t iteration = 0; iteration < iterations; iteration++) {
+    auto start = steady_clock::now();
+    Listener listener{parent};
+    calls = replayTrace(file.data(), file.size(), listener);
+    KeySet result = listener.getKeySet();
+    duration<double> seconds = steady_clock::now() - start;
+    keys = static_cast<size_t>(result.size());
+    if (iteration == 0 || seconds.count() < fastest) {
+      fastest = seconds.count();
+    }
+  }
+
+  char line[192];
+  snprintf(line, sizeof(line),
+           "%-32s %9zu B %8zu calls %8zu keys %9.1f MB/s %8.2f M calls/s",
+           filename.c_str(), file.size(), calls, keys,
+           fastest > 0 ? static_cast<double>(file.size()) / fastest / 1e6 : 0,
+           fastest > 0 ? static_cast<double>(calls) / fastest / 1e6 : 0);
+  cout << line << endl;
+}
+
+} // namespace
+
+// -- Main ---------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+  string usage = string{"Usage: "} + argv[0] +
+                 " [--iterations count] [--print] trace…";
+
+  size_t iterations = defaultIterations;
+  bool printKeys = false;
+  int argument = 1;
+  for (; argument < argc && strncmp(argv[argument], "--", 2) == 0;
+       argument++) {
+    string option = argv[argument];
+    if (option == "--print") {
+      printKeys = true;
+      continue;
+    }
+    if (option != "--iterations" || argument + 1 >= argc ||
+        (iterations = std::strtoull(argv[++argument], nullptr, 10)) == 0) {
+      cerr << usage << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (argument >= argc) {
+    cerr << usage << endl;
+    return EXIT_FAILURE;
+  }
+
+  Writer writer{STDOUT_FILENO};
+  int status = EXIT_SUCCESS;
+  for (; argument < argc; argument++) {
+    try {
+      if (printKeys) {
+        print(argv[argument], writer);
+      } else {
+        benchmark(argv[argument], iterations);
+      }
+    } catch (exception const &error) {
+      cerr << argv[argument] << ": " << error.what() << endl;
+      status = EXIT_FAILURE;
+    }
+  }
+  return status;
+}
@@ -0,0 +1,475 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions to convert the text of YAML scalars.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstring>
+
+#include "scalar.hpp"
+
+using std::string;
+using std::string_view;
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using yaypeg::detectIndentation;
+using yaypeg::ScalarStyle;
+
+/**
+ * @brief This function checks if the given character is a space or tab.
+ *
+ * @param character This argument stores the character the function checks.
+ *
+ * @retval true If `character` is whitespace (`s_white`)
+ * @retval false Otherwise
+ */
+bool isWhite(char character) noexcept {
+  return character == ' ' || character == '\t';
+}
+
+/**
+ * @brief This function checks if the given character starts a line break.
+ *
+ * @param character This argument stores the character the function checks.
+ *
+ * @retval true If `character` is a line break character (`b_char`)
+ * @retval false Otherwise
+ */
+bool isBreak(char character) noexcept {
+  return character == '\n' || character == '\r';
+}
+
+/**
+ * @brief This function skips a single line break.
+ *
+ * @param text This argument stores the text that contains the line break.
+ * @param position This number specifies the start of the line break. The
+ *                 function moves it to the first character after the break.
+ */
+void skipBreak(string_view text, size_t &position) noexcept {
+  if (text[position] == '\r' && position + 1 < text.size() &&
+      text[position + 1] == '\n') {
+    position++;
+  }
+  position++;
+}
+
+/**
+ * @brief This function appends the UTF-8 encoding of a code point.
+ *
+ * @param result The function appends the encoded code point to this text.
+ * @param code This number specifies the code point.
+ */
+void appendUtf8(string &result, uint32_t code) {
+  if (code < 0x80) {
+    result.push_back(static_cast<char>(code));
+  } else if (code < 0x800) {
+    result.push_back(static_cast<char>(0xc0 | (code >> 6)));
+    result.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+  } else if (code < 0x10000) {
+    result.push_back(static_cast<char>(0xe0 | (code >> 12)));
+    result.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+    result.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+  } else {
+    result.push_back(static_cast<char>(0xf0 | (code >> 18)));
+    result.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+    result.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+    result.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+  }
+}
+
+/**
+ * @brief This function reads a hexadecimal number.
+ *
+ * @param text This argument stores the text that contains the number.
+ * @param position This number specifies the start of the number.
+ * @param digits This number specifies the number of hexadecimal digits.
+ * @param code The function stores the value of the number in this variable.
+ *
+ * @retval true If `text` contains `digits` hexadecimal digits at `position`
+ * @retval false Otherwise
+ */
+bool readHex(string_view text, size_t position, size_t digits,
+             uint32_t &code) noexcept {
+  if (text.size() - position < digits) {
+    return false;
+  }
+  code = 0;
+  for (size_t end = position + digits; position < end; position++) {
+    char character = text[position];
+    uint32_t value;
+    if (character >= '0' && character <= '9') {
+      value = static_cast<uint32_t>(character - '0');
+    } else if (character >= 'a' && character <= 'f') {
+      value = static_cast<uint32_t>(character - 'a' + 10);
+    } else if (character >= 'A' && character <= 'F') {
+      value = static_cast<uint32_t>(character - 'A' + 10);
+    } else {
+      return false;
+    }
+    code = code * 16 + value;
+  }
+  return true;
+}
+
+/**
+ * @brief This function replaces an escape sequence of a double quoted scalar.
+ *
+ * @param text This argument stores the content of the scalar.
+ * @param position This number specifies the position of the backslash. The
+ *                 function moves it behind the escape sequence.
+ * @param result The function appends the escaped character to this text.
+ */
+void unescape(string_view text, size_t &position, string &result) {
+  if (position + 1 >= text.size()) {
+    result.push_back(text[position++]);
+    return;
+  }
+
+  char escape = text[position + 1];
+  position += 2;
+  uint32_t code;
+  switch (escape) {
+  case '0':
+    result.push_back('\0');
+    return;
+  case 'a':
+    result.push_back('\a');
+    return;
+  case 'b':
+    result.push_back('\b');
+    return;
+  case 't':
+  case '\t':
+    result.push_back('\t');
+    return;
+  case 'n':
+    result.push_back('\n');
+    return;
+  case 'v':
+    result.push_back('\v');
+    return;
+  case 'f':
+    result.push_back('\f');
+    return;
+  case 'r':
+    result.push_back('\r');
+    return;
+  case 'e':
+    result.push_back('\x1b');
+    return;
+  case 'N':
+    appendUtf8(result, 0x85);
+    return;
+  case '_':
+    appendUtf8(result, 0xa0);
+    return;
+  case 'L':
+    appendUtf8(result, 0x2028);
+    return;
+  case 'P':
+    appendUtf8(result, 0x2029);
+    return;
+  case 'x':
+  case 'u':
+  case 'U': {
+    size_t digits = escape == 'x' ? 2 : escape == 'u' ? 4 : 8;
+    if (readHex(text, position, digits, code)) {
+      position += digits;
+      // JSON writers escape characters outside the basic multilingual plane
+      // as UTF-16 surrogate pair (e.g. `\ud83d\ude00`)
+      uint32_t low;
+      if (code >= 0xd800 && code < 0xdc00 &&
+          text.compare(position, 2, "\\u") == 0 &&
+          readHex(text, position + 2, 4, low) && low >= 0xdc00 &&
+          low < 0xe000) {
+        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+        position += 6;
+      }
+      // Unpaired surrogates and values above the last code point have no
+      // UTF-8 encoding
+      if ((code >= 0xd800 && code < 0xe000) || code > 0x10ffff) {
+        code = 0xfffd;
+      }
+      appendUtf8(result, code);
+      return;
+    }
+    break;
+  }
+  case ' ':
+  case '"':
+  case '/':
+  case '\\':
+    result.push_back(escape);
+    return;
+  }
+
+  // The grammar only accepts valid escape sequences. We keep unknown
+  // sequences unchanged anyway.
+  result.push_back('\\');
+  result.push_back(escape);
+}
+
+/**
+ * @brief This function converts the text of a block scalar to its value.
+ *
+ * The function copies the content line by line. It removes the indentation
+ * and applies folding and chomping while it copies the lines.
+ *
+ * @param text This argument stores the text of the scalar starting with the
+ *             block header.
+ * @param indentation This number specifies the indentation of the content or
+ *                    `detectIndentation`.
+ *
+ * @return The value of the scalar
+ */
+string blockToText(string_view text, size_t indentation) {
+  bool folded = text.front() == '>';
+
+  // Block header: indentation and chomping indicator in any order
+  char chomping = ' ';
+  for (size_t position = 1; position < 3 && position < text.size();
+       position++) {
+    if (text[position] == '+' || text[position] == '-') {
+      chomping = text[position];
+    }
+  }
+
+  string result;
+  result.reserve(text.size());
+  auto header = static_cast<char const *>(
+      memchr(text.data(), '\n', text.size()));
+  char const *line = header ? header + 1 : text.data() + text.size();
+  char const *const end = text.data() + text.size();
+
+  size_t breaks = 0;
+  bool content = false;
+  bool spaced = false;
+  while (line != end) {
+    auto lineFeed = static_cast<char const *>(
+        memchr(line, '\n', static_cast<size_t>(end - line)));
+    char const *next = lineFeed ? lineFeed + 1 : end;
+    string_view body{line, static_cast<size_t>((lineFeed ? lineFeed : end) -
+                                               line)};
+    if (!body.empty() && body.back() == '\r') {
+      body.remove_suffix(1);
+    }
+    line = next;
+
+    size_t spaces = 0;
+    while (spaces < body.size() && body[spaces] == ' ') {
+      spaces++;
+    }
+    bool blank = body.find_first_not_of(" \t") == string_view::npos;
+    if (!blank && indentation == detectIndentation) {
+      indentation = spaces;
+    }
+    if (!blank && spaces < indentation) {
+      break; // Trailing comment
+    }
+
+    string_view rest = spaces < indentation ? string_view{}
+                                            : body.substr(indentation);
+    if (rest.empty()) {
+      breaks += lineFeed ? 1 : 0;
+      continue;
+    }
+
+    // Folding replaces a single line break between two lines of text with a
+    // space. Line breaks next to more indented lines stay unchanged.
+    bool indented = isWhite(rest.front());
+    if (content && folded && !spaced && !indented && breaks > 0) {
+      if (breaks == 1) {
+        result.push_back(' ');
+      } else {
+        result.append(breaks - 1, '\n');
+      }
+    } else {
+      result.append(breaks, '\n');
+    }
+    result.append(rest);
+    content = true;
+    spaced = indented;
+    breaks = lineFeed ? 1 : 0;
+  }
+
+  // Chomping: strip (`-`), clip (default) or keep (`+`) the final line breaks
+  if (chomping == '+') {
+    result.append(breaks, '\n');
+  } else if (chomping == ' ' && content && breaks > 0) {
+    result.push_back('\n');
+  }
+  return result;
+}
+
+} // namespace
+
+namespace yaypeg {
+
+/**
+ * @brief This function determines the style of a scalar.
+ *
+ * @param text This argument stores the text of the scalar as it appears in
+ *             the YAML input.
+ *
+ * @return The style of the given scalar
+ */
+ScalarStyle styleOf(string_view text) noexcept {
+  if (!text.empty() && text.front() == '|') {
+    return ScalarStyle::LITERAL;
+  }
+  if (!text.empty() && text.front() == '>') {
+    return ScalarStyle::FOLDED;
+  }
+  if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+    return ScalarStyle::DOUBLE_QUOTED;
+  }
+  if (text.size() >= 2 && text.front() == '\'' && text.back() == '\'') {
+    return ScalarStyle::SINGLE_QUOTED;
+  }
+  return ScalarStyle::PLAIN;
+}
+
+/**
+ * @brief This function removes the quotes of a scalar.
+ *
+ * @param text This argument stores the text of the scalar as it appears in
+ *             the YAML input.
+ *
+ * @return The text between the quotes of `text`, or `text` for a plain or
+ *         block scalar
+ */
+string_view scalarContent(string_view text) noexcept {
+  ScalarStyle style = styleOf(text);
+  return style == ScalarStyle::SINGLE_QUOTED ||
+                 style == ScalarStyle::DOUBLE_QUOTED
+             ? text.substr(1, text.size() - 2)
+             : text;
+}
+
+/**
+ * @brief This function checks if the value of a scalar is equal to its
+ *        content without quotes.
+ *
+ * @param text This argument stores the text of the scalar as it appears in
+ *             the YAML input.
+ *
+ * @retval true If the scalar contains no line breaks, escape sequences and
+ *              quoted quotes
+ * @retval false Otherwise
+ */
+bool isVerbatim(string_view text) noexcept {
+  ScalarStyle style = styleOf(text);
+  if (style == ScalarStyle::LITERAL || style == ScalarStyle::FOLDED) {
+    return false;
+  }
+  for (char character : scalarContent(text)) {
+    if (isBreak(character) ||
+        (style == ScalarStyle::SINGLE_QUOTED && character == '\'') ||
+        (style == ScalarStyle::DOUBLE_QUOTED && character == '\\')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief This function converts the text of a scalar to its value.
+ *
+ * The function removes quotes, replaces escape sequences and folds line breaks
+ * as specified in section 7.3 of the YAML specification. For block scalars it
+ * removes the indentation and applies chomping and folding as specified in
+ * section 8.1.
+ *
+ * @param text This argument stores the text of the scalar as it appears in
+ *             the YAML input.
+ * @param indentation This number specifies the indentation of the content of
+ *                    a block scalar. The function ignores it for flow
+ *                    scalars.
+ *
+ * @return The value of the scalar
+ */
+string scalarToText(string_view text, size_t indentation) {
+  ScalarStyle style = styleOf(text);
+  if (style == ScalarStyle::LITERAL || style == ScalarStyle::FOLDED) {
+    return blockToText(text, indentation);
+  }
+  string_view content = scalarContent(text);
+  if (isVerbatim(text)) {
+    return string{content};
+  }
+
+  string result;
+  result.reserve(content.size());
+  size_t position = 0;
+  while (position < content.size()) {
+    char character = content[position];
+
+    if (isWhite(character)) {
+      // Whitespace in front of a line break does not belong to the value
+      size_t end = position;
+      while (end < content.size() && isWhite(content[end])) {
+        end++;
+      }
+      if (end >= content.size() || !isBreak(content[end])) {
+        result.append(content, position, end - position);
+      }
+      position = end;
+      continue;
+    }
+
+    if (isBreak(character)) {
+      // A single line break becomes a space, `n` empty lines become `n` line
+      // feeds. Leading whitespace of the following lines is not content.
+      skipBreak(content, position);
+      size_t emptyLines = 0;
+      for (;;) {
+        while (position < content.size() && isWhite(content[position])) {
+          position++;
+        }
+        if (position >= content.size() || !isBreak(content[position])) {
+          break;
+        }
+        skipBreak(content, position);
+        emptyLines++;
+      }
+      if (emptyLines > 0) {
+        result.append(emptyLines, '\n');
+      } else {
+        result.push_back(' ');
+      }
+      continue;
+    }
+
+    if (style == ScalarStyle::DOUBLE_QUOTED && character == '\\') {
+      if (position + 1 < content.size() && isBreak(content[position + 1])) {
+        // An escaped line break joins the lines without adding a space
+        position++;
+        skipBreak(content, position);
+        while (position < content.size() && isWhite(content[position])) {
+          position++;
+        }
+        continue;
+      }
+      unescape(content, position, result);
+      continue;
+    }
+
+    if (style == ScalarStyle::SINGLE_QUOTED && character == '\'' &&
+        position + 1 < content.size() && content[position + 1] == '\'') {
+      position++;
+    }
+    result.push_back(character);
+    position++;
+  }
+  return result;
+}
+
+} // namespace yaypeg
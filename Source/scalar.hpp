@@ -0,0 +1,93 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions to convert the text of YAML scalars.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_SCALAR_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_SCALAR_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// -- Types & Functions --------------------------------------------------------
+
+namespace yaypeg {
+
+/** @brief This enumeration specifies the styles of scalars. */
+enum class ScalarStyle : uint8_t {
+  PLAIN,
+  SINGLE_QUOTED,
+  DOUBLE_QUOTED,
+  LITERAL,
+  FOLDED
+};
+
+/**
+ * @brief This constant specifies that the conversion of a block scalar should
+ *        detect the indentation of the content itself.
+ */
+constexpr size_t detectIndentation = SIZE_MAX;
+
+/**
+ * @brief This function determines the style of a scalar.
+ *
+ * @param text This argument stores the text of the scalar as it appears in
+ *             the YAML input.
+ *
+ * @return The style of the given scalar
+ */
+ScalarStyle styleOf(std::string_view text) noexcept;
+
+/**
+ * @brief This function removes the quotes of a scalar.
+ *
+ * @param text This argument stores the text of the scalar as it appears in
+ *             the YAML input.
+ *
+ * @return The text between the quotes of `text`, or `text` for a plain or
+ *         block scalar
+ */
+std::string_view scalarContent(std::string_view text) noexcept;
+
+/**
+ * @brief This function checks if the value of a scalar is equal to its
+ *        content without quotes.
+ *
+ * @param text This argument stores the text of the scalar as it appears in
+ *             the YAML input.
+ *
+ * @retval true If the scalar contains no line breaks, escape sequences and
+ *              quoted quotes
+ * @retval false Otherwise
+ */
+bool isVerbatim(std::string_view text) noexcept;
+
+/**
+ * @brief This function converts the text of a scalar to its value.
+ *
+ * The function removes quotes, replaces escape sequences and folds line
+ * breaks as specified in section 7.3 of the YAML specification. For block
+ * scalars it removes the indentation and applies chomping and folding as
+ * specified in section 8.1.
+ *
+ * @param text This argument stores the text of the scalar as it appears in
+ *             the YAML input.
+ * @param indentation This number specifies the indentation of the content of
+ *                    a block scalar. The function ignores it for flow
+ *                    scalars.
+ *
+ * @return The value of the scalar
+ */
+std::string scalarToText(std::string_view text,
+                         size_t indentation = detectIndentation);
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_SCALAR_HPP
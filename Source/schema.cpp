@@ -0,0 +1,295 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions to resolve the type of plain scalars
+ *        according to the YAML core schema.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <charconv>
+#include <climits>
+#include <initializer_list>
+
+#include "schema.hpp"
+
+using std::string_view;
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using yaypeg::ResolvedScalar;
+using yaypeg::ScalarType;
+using yaypeg::ValueBuffer;
+
+/**
+ * @brief This function checks if the given character is a decimal digit.
+ *
+ * @param character This argument stores the character the function checks.
+ *
+ * @retval true If `character` is a digit (`ns_dec_digit`)
+ * @retval false Otherwise
+ */
+bool isDigit(char character) noexcept {
+  return character >= '0' && character <= '9';
+}
+
+/**
+ * @brief This function checks if the given text is equal to one of the given
+ *        spellings.
+ *
+ * @param text This argument stores the text the function checks.
+ * @param spellings This argument stores the accepted spellings.
+ *
+ * @retval true If `text` is equal to an element of `spellings`
+ * @retval false Otherwise
+ */
+bool isAnyOf(string_view text,
+             std::initializer_list<string_view> spellings) noexcept {
+  for (auto spelling : spellings) {
+    if (text == spelling) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief This function checks if the given text only contains decimal
+ *        digits.
+ *
+ * @param text This argument stores the text the function checks.
+ *
+ * @retval true If `text` contains at least one character and only digits
+ * @retval false Otherwise
+ */
+bool isDigits(string_view text) noexcept {
+  if (text.empty()) {
+    return false;
+  }
+  for (char character : text) {
+    if (!isDigit(character)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief This function checks if the given (unsigned) text is a float of the
+ *        core schema (`\.[0-9]+|[0-9]+(\.[0-9]*)?`, followed by an optional
+ *        exponent).
+ *
+ * @param text This argument stores the text the function checks.
+ *
+ * @retval true If `text` represents a float
+ * @retval false Otherwise
+ */
+bool isFloat(string_view text) noexcept {
+  size_t position = 0;
+  size_t digits = 0;
+  for (; position < text.size() && isDigit(text[position]); position++) {
+    digits++;
+  }
+  if (position < text.size() && text[position] == '.') {
+    position++;
+    size_t fraction = 0;
+    for (; position < text.size() && isDigit(text[position]); position++) {
+      fraction++;
+    }
+    // A leading dot requires at least one digit after it
+    if (digits == 0 && fraction == 0) {
+      return false;
+    }
+  } else if (digits == 0) {
+    return false;
+  }
+
+  if (position < text.size() &&
+      (text[position] == 'e' || text[position] == 'E')) {
+    position++;
+    if (position < text.size() &&
+        (text[position] == '-' || text[position] == '+')) {
+      position++;
+    }
+    return isDigits(text.substr(position));
+  }
+  return position == text.size();
+}
+
+/**
+ * @brief This function parses the given text as number.
+ *
+ * @param text This argument stores the text of the number.
+ * @param base This number specifies the base of the number.
+ * @param number The function stores the parsed number in this variable.
+ *
+ * @retval true If `text` is a number that fits into `Number`
+ * @retval false Otherwise
+ */
+template <typename Number>
+bool parse(string_view text, int base, Number &number) noexcept {
+  char const *end = text.data() + text.size();
+  auto result = std::from_chars(text.data(), end, number, base);
+  return result.ec == std::errc{} && result.ptr == end;
+}
+
+/**
+ * @brief This function stores the decimal representation of an integer.
+ *
+ * @param type This argument specifies the type of the integer.
+ * @param number This argument stores the integer.
+ * @param buffer The function stores the null terminated text of `number` in
+ *               this buffer.
+ *
+ * @return A resolved scalar with the type `type` and the value `number`
+ */
+template <typename Number>
+ResolvedScalar format(ScalarType type, Number number,
+                      ValueBuffer &buffer) noexcept {
+  auto result =
+      std::to_chars(buffer.data(), buffer.data() + buffer.size() - 1, number);
+  *result.ptr = '\0';
+  return ResolvedScalar{
+      type, string_view{buffer.data(),
+                        static_cast<size_t>(result.ptr - buffer.data())}};
+}
+
+/**
+ * @brief This function resolves an octal (`0o`) or hexadecimal (`0x`)
+ *        integer.
+ *
+ * @param text This argument stores the text of the scalar.
+ * @param digits This argument stores the digits after the prefix.
+ * @param base This number specifies the base of the integer.
+ * @param buffer The function stores the canonical value in this buffer.
+ *
+ * @return The resolved integer, or a string if `digits` are no valid digits
+ *         or the number does not fit into 64 bits
+ */
+ResolvedScalar resolveBase(string_view text, string_view digits, int base,
+                           ValueBuffer &buffer) noexcept {
+  // Unlike signed numbers, `from_chars` does not accept a sign for unsigned
+  // numbers.
+  unsigned long long number;
+  if (!parse(digits, base, number)) {
+    return ResolvedScalar{ScalarType::STRING, text};
+  }
+  if (number <= static_cast<unsigned long long>(LLONG_MAX)) {
+    return format(ScalarType::INTEGER, static_cast<long long>(number),
+                  buffer);
+  }
+  return format(ScalarType::UNSIGNED_INTEGER, number, buffer);
+}
+
+} // namespace
+
+namespace yaypeg {
+
+/**
+ * @brief This function resolves the type of a plain scalar.
+ *
+ * The function only inspects the bytes of the scalar and parses integers
+ * with `std::from_chars`. It therefore does not allocate memory and does not
+ * depend on the locale.
+ *
+ * @param text This argument stores the text of a plain scalar.
+ * @param buffer The function stores the canonical value of integers in this
+ *               buffer.
+ *
+ * @return The type and canonical value of `text`
+ */
+ResolvedScalar resolveScalar(string_view text, ValueBuffer &buffer) noexcept {
+  ResolvedScalar unresolved{ScalarType::STRING, text};
+  if (text.empty()) {
+    return ResolvedScalar{ScalarType::NULL_VALUE, ""};
+  }
+
+  // Most scalars are neither null, booleans nor numbers. We reject them
+  // after looking at the first character.
+  char first = text[0];
+  switch (first) {
+  case '~':
+  case 'n':
+  case 'N':
+    return isAnyOf(text, {"~", "null", "Null", "NULL"})
+               ? ResolvedScalar{ScalarType::NULL_VALUE, ""}
+               : unresolved;
+  case 't':
+  case 'T':
+    return isAnyOf(text, {"true", "True", "TRUE"})
+               ? ResolvedScalar{ScalarType::BOOLEAN, "1"}
+               : unresolved;
+  case 'f':
+  case 'F':
+    return isAnyOf(text, {"false", "False", "FALSE"})
+               ? ResolvedScalar{ScalarType::BOOLEAN, "0"}
+               : unresolved;
+  case '-':
+  case '+':
+  case '.':
+    break;
+  default:
+    if (!isDigit(first)) {
+      return unresolved;
+    }
+  }
+
+  if (text.size() > 2 && first == '0' && text[1] == 'o') {
+    return resolveBase(text, text.substr(2), 8, buffer);
+  }
+  if (text.size() > 2 && first == '0' && text[1] == 'x') {
+    return resolveBase(text, text.substr(2), 16, buffer);
+  }
+
+  bool negative = first == '-';
+  string_view body = negative || first == '+' ? text.substr(1) : text;
+  if (isAnyOf(body, {".inf", ".Inf", ".INF"})) {
+    return ResolvedScalar{ScalarType::FLOAT, negative ? "-inf" : "inf"};
+  }
+  if (isAnyOf(text, {".nan", ".NaN", ".NAN"})) {
+    return ResolvedScalar{ScalarType::FLOAT, "nan"};
+  }
+
+  if (isDigits(body)) {
+    long long number;
+    if (parse(negative ? text : body, 10, number)) {
+      return format(ScalarType::INTEGER, number, buffer);
+    }
+    unsigned long long natural;
+    if (!negative && parse(body, 10, natural)) {
+      return format(ScalarType::UNSIGNED_INTEGER, natural, buffer);
+    }
+    // Integers that do not fit into 64 bits are still valid floats
+    return ResolvedScalar{ScalarType::FLOAT, text};
+  }
+  return isFloat(body) ? ResolvedScalar{ScalarType::FLOAT, text} : unresolved;
+}
+
+/**
+ * @brief This function returns the name Elektra uses for the given type.
+ *
+ * @param type This argument specifies a resolved type.
+ *
+ * @return The value of the metakey `type` for `type`, or `nullptr` for
+ *         strings and null values
+ */
+char const *typeName(ScalarType type) noexcept {
+  switch (type) {
+  case ScalarType::BOOLEAN:
+    return "boolean";
+  case ScalarType::INTEGER:
+    return "long_long";
+  case ScalarType::UNSIGNED_INTEGER:
+    return "unsigned_long_long";
+  case ScalarType::FLOAT:
+    return "double";
+  default:
+    return nullptr;
+  }
+}
+
+} // namespace yaypeg
@@ -0,0 +1,82 @@
+/**
+ * @file
+ *
+ * @brief This file contains functions to resolve the type of plain scalars
+ *        according to the YAML core schema.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_SCHEMA_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_SCHEMA_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// -- Types & Functions --------------------------------------------------------
+
+namespace yaypeg {
+
+/** @brief This enumeration specifies the tags of the YAML core schema. */
+enum class ScalarType : uint8_t {
+  STRING,
+  NULL_VALUE,
+  BOOLEAN,
+  INTEGER,
+  UNSIGNED_INTEGER,
+  FLOAT
+};
+
+/**
+ * @brief This type stores the canonical text of a resolved number. The
+ *        buffer is large enough for every 64 bit integer and a null
+ *        character.
+ */
+using ValueBuffer = std::array<char, 24>;
+
+/** @brief This struct stores the result of a type resolution. */
+struct ResolvedScalar {
+  /** @brief This variable specifies the type of the scalar. */
+  ScalarType type;
+  /**
+   * @brief This variable stores the canonical value of the scalar: `1` or
+   *        `0` for booleans, the decimal representation of integers, and
+   *        `inf`, `-inf` or `nan` for special floats. These values are null
+   *        terminated. For other floats and strings the variable stores
+   *        the (unterminated) text of the scalar.
+   */
+  std::string_view value;
+};
+
+/**
+ * @brief This function resolves the type of a plain scalar.
+ *
+ * The function only inspects the bytes of the scalar and parses integers
+ * with `std::from_chars`. It therefore does not allocate memory and does not
+ * depend on the locale.
+ *
+ * @param text This argument stores the text of a plain scalar.
+ * @param buffer The function stores the canonical value of integers in this
+ *               buffer.
+ *
+ * @return The type and canonical value of `text`
+ */
+ResolvedScalar resolveScalar(std::string_view text,
+                             ValueBuffer &buffer) noexcept;
+
+/**
+ * @brief This function returns the name Elektra uses for the given type.
+ *
+ * @param type This argument specifies a resolved type.
+ *
+ * @return The value of the metakey `type` for `type`, or `nullptr` for
+ *         strings and null values
+ */
+char const *typeName(ScalarType type) noexcept;
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_SCHEMA_HPP
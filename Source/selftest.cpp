@@ -0,0 +1,782 @@
+/**
+ * @file
+ *
+ * @brief This file contains a tool that checks parts of the library the
+ *        command line tool does not expose.
+ *
+ * Every check uses temporary files and prints a message for every
+ * unexpected result. The tool runs all checks, unless the user specifies the
+ * names of the checks.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <kdb.hpp>
+#include <kdbhelper.h>
+
+#include "cache.hpp"
+#include "convert.hpp"
+#include "emitter.hpp"
+#include "file.hpp"
+#include "hash.hpp"
+#include "incremental.hpp"
+#include "intern.hpp"
+#include "lazy.hpp"
+#include "limits.hpp"
+#include "plugin.hpp"
+#include "snapshot.hpp"
+
+#if defined(__linux__)
+#include "watcher.hpp"
+#endif
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::exception;
+using std::function;
+using std::invalid_argument;
+using std::ofstream;
+using std::runtime_error;
+using std::string;
+using std::system_category;
+using std::system_error;
+using std::vector;
+
+using CppKey = kdb::Key;
+using CppKeySet = kdb::KeySet;
+
+using yaypeg::Cache;
+using yaypeg::convertBuffer;
+using yaypeg::convertFile;
+using yaypeg::convertWithSnapshot;
+using yaypeg::emitFile;
+using yaypeg::hash;
+using yaypeg::IncrementalParser;
+using yaypeg::InternTable;
+using yaypeg::LazyKeySet;
+using yaypeg::limit_error;
+using yaypeg::Limits;
+using yaypeg::Options;
+using yaypeg::readFile;
+using yaypeg::Snapshot;
+using yaypeg::writeSnapshot;
+
+#if defined(__linux__)
+using yaypeg::Watcher;
+#endif
+
+// -- Types --------------------------------------------------------------------
+
+namespace {
+
+/** @brief This struct stores a named check. */
+struct Check {
+  /** @brief This text stores the name of the check. */
+  char const *name;
+  /** @brief This function runs the check and returns `true` on success. */
+  function<bool()> run;
+};
+
+/**
+ * @brief This class creates an empty temporary file and removes it again.
+ */
+class TemporaryFile {
+public:
+  /** @brief This text stores the path of the file. */
+  string path;
+
+  /**
+   * @brief This constructor creates an empty temporary file.
+   *
+   * @throws system_error if the constructor is unable to create the file
+   */
+  TemporaryFile() {
+    char name[] = "/tmp/yaypeg-XXXXXX";
+    int descriptor = mkstemp(name);
+    if (descriptor < 0) {
+      throw system_error(errno, system_category(),
+                         "Unable to create temporary file");
+    }
+    ::close(descriptor);
+    path = name;
+  }
+
+  TemporaryFile(TemporaryFile const &) = delete;
+  TemporaryFile &operator=(TemporaryFile const &) = delete;
+
+  /**
+   * @brief This destructor removes the file.
+   */
+  ~TemporaryFile() { unlink(path.c_str()); }
+};
+
+// -- Functions ----------------------------------------------------------------
+
+/**
+ * @brief This function reports an unexpected result.
+ *
+ * @param condition This value specifies if the result was expected.
+ * @param message This text describes the unexpected result.
+ *
+ * @return The value of `condition`
+ */
+bool expect(bool condition, string const &message) {
+  if (!condition) {
+    cerr << "  ✗ " << message << endl;
+  }
+  return condition;
+}
+
+/**
+ * @brief This function replaces the content of a file.
+ *
+ * @param filename This text stores the path of the file.
+ * @param text This text stores the new content of the file.
+ */
+void writeText(string const &filename, string const &text) {
+  ofstream{filename, std::ios::binary | std::ios::trunc} << text;
+}
+
+/**
+ * @brief This function changes the modification time of a file.
+ *
+ * @param filename This text stores the path of the file.
+ * @param seconds This number specifies the new modification time.
+ *
+ * @throws system_error if the function is unable to change the time
+ */
+void setModificationTime(string const &filename, time_t seconds) {
+  timeval times[2] = {{seconds, 0}, {seconds, 0}};
+  if (utimes(filename.c_str(), times) != 0) {
+    throw system_error(errno, system_category(),
+                       "Unable to change time of “" + filename + "”");
+  }
+}
+
+/**
+ * @brief This function returns the value of a key.
+ *
+ * @param keys This key set stores the key.
+ * @param name This text stores the name of the key.
+ *
+ * @return The value of the key or `<missing>`, if `keys` does not contain a
+ *         key called `name`
+ */
+string value(CppKeySet const &keys, string const &name) {
+  CppKey key = keys.lookup(name);
+  return key ? key.getString() : "<missing>";
+}
+
+/**
+ * @brief This function checks when the cache reads a file again.
+ *
+ * @retval true If the cache returned the expected keys in all cases
+ * @retval false Otherwise
+ */
+bool checkCache() {
+  TemporaryFile file;
+  CppKey parent{"user/tests/cache", KEY_END};
+  string const name = "user/tests/cache/key";
+  Cache cache;
+  bool valid = true;
+
+  time_t past = time(nullptr) - 3600;
+  writeText(file.path, "key: one\n");
+  setModificationTime(file.path, past);
+  valid = expect(value(cache.get(parent, file.path), name) == "one",
+                 "The cache did not convert a new file") &&
+          valid;
+
+  // The file changed in an earlier second than the cache read it. Since
+  // size and modification time stay the same, the cache must not read it.
+  writeText(file.path, "key: two\n");
+  setModificationTime(file.path, past);
+  valid = expect(value(cache.get(parent, file.path), name) == "one",
+                 "The cache read a file with unchanged size and time") &&
+          valid;
+
+  setModificationTime(file.path, past + 1);
+  valid = expect(value(cache.get(parent, file.path), name) == "two",
+                 "The cache ignored a changed modification time") &&
+          valid;
+
+  writeText(file.path, "key: three\n");
+  setModificationTime(file.path, past + 1);
+  valid = expect(value(cache.get(parent, file.path), name) == "three",
+                 "The cache ignored a changed size") &&
+          valid;
+
+  // A file with a modification time at or after the time the cache read it
+  // may change without a visible change of its status (racily clean).
+  time_t future = time(nullptr) + 3600;
+  writeText(file.path, "key: seven\n");
+  setModificationTime(file.path, future);
+  cache.get(parent, file.path);
+  writeText(file.path, "key: eight\n");
+  setModificationTime(file.path, future);
+  valid = expect(value(cache.get(parent, file.path), name) == "eight",
+                 "The cache trusted the status of a racily clean file") &&
+          valid;
+
+  // Changes of the returned keys must not change the cached keys
+  CppKeySet keys = cache.get(parent, file.path);
+  keys.lookup(name).setString("changed");
+  valid = expect(value(cache.get(parent, file.path), name) == "eight",
+                 "Changing a returned key changed the cache") &&
+          valid;
+
+  CppKey other{"user/tests/other", KEY_END};
+  valid = expect(value(cache.get(other, file.path), "user/tests/other/key") ==
+                     "eight",
+                 "The cache ignored a changed parent key") &&
+          valid;
+  valid = expect(cache.size() == 1, "The cache stores a file twice") && valid;
+
+  cache.clear();
+  return expect(cache.size() == 0, "Clearing the cache left entries") &&
+         valid;
+}
+
+/**
+ * @brief This function checks the contract, `get` and `set` of the plugin.
+ *
+ * @retval true If the plugin behaved as expected
+ * @retval false Otherwise
+ */
+bool checkPlugin() {
+  TemporaryFile file;
+  CppKey errorKey{"user/tests/error", KEY_END};
+  Plugin *handle = elektraPluginExport("yaypeg", ELEKTRA_PLUGIN_OPEN,
+                                       &elektraYaypegOpen, ELEKTRA_PLUGIN_END);
+  bool valid = expect(elektraYaypegOpen(handle, errorKey.getKey()) ==
+                          ELEKTRA_PLUGIN_STATUS_SUCCESS,
+                      "Unable to open the plugin");
+
+  CppKeySet contract;
+  CppKey module{"system/elektra/modules/yaypeg", KEY_END};
+  elektraYaypegGet(handle, contract.getKeySet(), module.getKey());
+  valid = expect(value(contract,
+                       "system/elektra/modules/yaypeg/infos/provides") ==
+                     "storage/yaml",
+                 "The contract does not provide YAML storage") &&
+          valid;
+  string const exports = "system/elektra/modules/yaypeg/exports/get";
+  valid = expect(static_cast<bool>(contract.lookup(exports)),
+                 "The contract does not export `get`") &&
+          valid;
+
+  writeText(file.path, "key: value\nlist:\n  - element\n");
+  CppKey parent{"user/tests/yaypeg", KEY_VALUE, file.path.c_str(), KEY_END};
+  string const name = "user/tests/yaypeg/key";
+  CppKeySet keys;
+  valid = expect(elektraYaypegGet(handle, keys.getKeySet(), parent.getKey()) ==
+                     ELEKTRA_PLUGIN_STATUS_SUCCESS,
+                 "The plugin was unable to read a file") &&
+          valid;
+  valid = expect(value(keys, "user/tests/yaypeg/list/#0") == "element",
+                 "The plugin did not convert a sequence") &&
+          valid;
+
+  keys.lookup(name).setString("changed");
+  valid = expect(elektraYaypegSet(handle, keys.getKeySet(), parent.getKey()) ==
+                     ELEKTRA_PLUGIN_STATUS_SUCCESS,
+                 "The plugin was unable to write a file") &&
+          valid;
+
+  // The file changed in the same second the plugin read it
+  CppKeySet stored;
+  elektraYaypegGet(handle, stored.getKeySet(), parent.getKey());
+  valid = expect(value(stored, name) == "changed",
+                 "The plugin returned outdated keys after `set`") &&
+          valid;
+
+  // The first `kdbSet` creates the file of a new mount point
+  string const missingPath = file.path + ".missing";
+  CppKey missing{"user/tests/yaypeg", KEY_VALUE, missingPath.c_str(),
+                 KEY_END};
+  CppKeySet empty;
+  valid = expect(elektraYaypegGet(handle, empty.getKeySet(),
+                                  missing.getKey()) !=
+                         ELEKTRA_PLUGIN_STATUS_ERROR &&
+                     empty.size() == 0,
+                 "The plugin did not return empty keys for a missing file") &&
+          valid;
+  CppKeySet created;
+  created.append(CppKey{name, KEY_VALUE, "created", KEY_END});
+  valid = expect(elektraYaypegSet(handle, created.getKeySet(),
+                                  missing.getKey()) ==
+                         ELEKTRA_PLUGIN_STATUS_SUCCESS &&
+                     value(convertFile(parent, missingPath), name) ==
+                         "created",
+                 "The plugin was unable to create a missing file") &&
+          valid;
+  unlink(missingPath.c_str());
+
+  writeText(file.path, "key: [unterminated\n");
+  CppKeySet invalid;
+  valid = expect(elektraYaypegGet(handle, invalid.getKeySet(),
+                                  parent.getKey()) ==
+                     ELEKTRA_PLUGIN_STATUS_ERROR,
+                 "The plugin accepted invalid YAML") &&
+          valid;
+
+  elektraYaypegClose(handle, errorKey.getKey());
+  elektraFree(handle);
+  return valid;
+}
+
+/**
+ * @brief This function checks that the emitter rejects keys YAML is unable
+ *        to represent and that emitted files convert back to the same keys.
+ *
+ * @retval true If the emitter behaved as expected
+ * @retval false Otherwise
+ */
+bool checkEmitter() {
+  TemporaryFile file;
+  CppKey parent{"user/tests/emitter", KEY_END};
+  string const original = "key: value\n";
+
+  CppKeySet valueAndChildren;
+  valueAndChildren.append(
+      CppKey{"user/tests/emitter/map", KEY_VALUE, "value", KEY_END});
+  valueAndChildren.append(
+      CppKey{"user/tests/emitter/map/key", KEY_VALUE, "child", KEY_END});
+  CppKeySet mixed;
+  mixed.append(CppKey{"user/tests/emitter/list/#0", KEY_VALUE, "one", KEY_END});
+  mixed.append(
+      CppKey{"user/tests/emitter/list/key", KEY_VALUE, "two", KEY_END});
+  // Quoting makes the key longer than an implicit key
+  CppKeySet longKey;
+  longKey.append(CppKey{"user/tests/emitter/" + string(1023, '\'') + "/key",
+                        KEY_VALUE, "value", KEY_END});
+
+  bool valid = true;
+  for (auto const &keys : {valueAndChildren, mixed, longKey}) {
+    writeText(file.path, original);
+    bool rejected = false;
+    try {
+      emitFile(keys, parent, file.path);
+    } catch (invalid_argument const &) {
+      rejected = true;
+    }
+    valid = expect(rejected, "The emitter accepted keys YAML can not store") &&
+            expect(readFile(file.path) == original,
+                   "The emitter changed the file after a failed write") &&
+            valid;
+  }
+
+  CppKeySet keys;
+  keys.append(CppKey{"user/tests/emitter/key", KEY_VALUE, "value", KEY_END});
+  keys.append(CppKey{"user/tests/emitter/list", KEY_META, "array", "#1",
+                     KEY_END});
+  keys.append(CppKey{"user/tests/emitter/list/#0", KEY_VALUE, "one", KEY_END});
+  keys.append(CppKey{"user/tests/emitter/list/#1/key", KEY_VALUE, "two",
+                     KEY_END});
+  keys.append(CppKey{"user/tests/emitter/quoted", KEY_VALUE, "- # text: ",
+                     KEY_END});
+  string const longest(1024, 'k');
+  keys.append(
+      CppKey{"user/tests/emitter/" + longest, KEY_VALUE, "long", KEY_END});
+  emitFile(keys, parent, file.path);
+  CppKeySet converted = convertFile(parent, file.path);
+  for (string name : {string{"key"}, string{"list/#0"},
+                      string{"list/#1/key"}, string{"quoted"}, longest}) {
+    name = "user/tests/emitter/" + name;
+    valid = expect(value(converted, name) == value(keys, name),
+                   "The emitted file stores “" + value(converted, name) +
+                       "” instead of “" + value(keys, name) + "” in “" +
+                       name + "”") &&
+            valid;
+  }
+  return valid;
+}
+
+/**
+ * @brief This function checks how the incremental parser handles UTF-16
+ *        documents.
+ *
+ * @retval true If the parser converted the document and rejected an edit
+ *         range for it
+ * @retval false Otherwise
+ */
+bool checkIncremental() {
+  CppKey parent{"user/tests/incremental", KEY_END};
+  string const name = "user/tests/incremental/key";
+  // `key: value` as UTF-16 (little endian) with byte order mark
+  string utf16{"\xff\xfe", 2};
+  for (char character : string{"key: value\n"}) {
+    utf16 += character;
+    utf16 += '\0';
+  }
+
+  IncrementalParser parser{parent};
+  parser.update(utf16);
+  bool valid = expect(value(parser.getKeySet(), name) == "value",
+                      "The incremental parser did not convert UTF-16 input");
+
+  bool rejected = false;
+  try {
+    parser.update(utf16, 0, 0);
+  } catch (invalid_argument const &) {
+    rejected = true;
+  }
+  return expect(rejected, "The incremental parser accepted an edit range "
+                          "for UTF-16 input") &&
+         valid;
+}
+
+/**
+ * @brief This function checks that an intern table stops storing scalars
+ *        once it reaches its capacity.
+ *
+ * @retval true If the table stayed below its capacity and the conversion
+ *              returned the correct values
+ * @retval false Otherwise
+ */
+bool checkIntern() {
+  CppKey parent{"user/tests/intern", KEY_END};
+  string input;
+  for (size_t entry = 0; entry < 100; entry++) {
+    input += "key" + std::to_string(entry) + ": 'value " +
+             std::to_string(entry % 10) + "'\n";
+  }
+
+  InternTable table{1024};
+  Options options;
+  options.intern = &table;
+  CppKeySet keys =
+      convertBuffer(parent, input.data(), input.size(), "intern", options);
+  auto statistics = table.statistics();
+  bool valid = expect(statistics.bytesStored <= 1024 &&
+                          statistics.rejected > 0,
+                      "The intern table exceeded its capacity");
+  valid = expect(statistics.hits > 0, "The intern table did not reuse "
+                                      "stored values") &&
+          valid;
+  return expect(keys.size() == 100 &&
+                    value(keys, "user/tests/intern/key0") == "value 0" &&
+                    value(keys, "user/tests/intern/key99") == "value 9",
+                "A full intern table returned wrong values") &&
+         valid;
+}
+
+/**
+ * @brief This function checks that the lazy key set handles keys that replace
+ *        other keys.
+ *
+ * @retval true If the lazy key set returned the last value of every key
+ * @retval false Otherwise
+ */
+bool checkLazy() {
+  CppKey parent{"user/tests/lazy", KEY_END};
+  string const input = "key: first\nlist: text\nkey: 'second'\nlist:\n"
+                       "  - element\nother: \"value\"\n";
+
+  LazyKeySet lazy{parent, input.data(), input.size(), "duplicate keys"};
+  bool valid = expect(lazy.get("user/tests/lazy/key") == "second",
+                      "The lazy key set returned the value of a replaced key");
+  valid = expect(lazy.unconverted() == 3,
+                 "The lazy key set stores scalars of replaced keys") &&
+          valid;
+
+  CppKeySet keys = lazy.getKeySet();
+  return expect(value(keys, "user/tests/lazy/key") == "second" &&
+                    value(keys, "user/tests/lazy/list").empty() &&
+                    value(keys, "user/tests/lazy/list/#0") == "element" &&
+                    value(keys, "user/tests/lazy/other") == "value",
+                "The lazy key set did not convert the remaining values") &&
+         valid;
+}
+
+/**
+ * @brief This function checks that the default and the incremental parser
+ *        stop conversions that exceed a limit.
+ *
+ * @retval true If all conversions failed with a limit error
+ * @retval false Otherwise
+ */
+bool checkLimits() {
+  using std::chrono::seconds;
+  using std::chrono::steady_clock;
+
+  CppKey parent{"user/tests/limits", KEY_END};
+  string large;
+  for (size_t line = 0; line < 1000; line++) {
+    large += "key" + std::to_string(line) + ": value\n";
+  }
+
+  struct Case {
+    char const *name;
+    string input;
+    function<void(Limits &)> restrict;
+  };
+  vector<Case> cases{
+      {"depth", "a:\n  b:\n    c:\n      d:\n        e: f\n",
+       [](Limits &limits) { limits.maximumDepth = 3; }},
+      {"keys", "a: 1\nb: 2\nc: 3\n",
+       [](Limits &limits) { limits.maximumKeys = 2; }},
+      {"scalar size", "key: long value\n",
+       [](Limits &limits) { limits.maximumScalarBytes = 4; }},
+      {"rule budget", "a: 1\nb: 2\nc: 3\n",
+       [](Limits &limits) { limits.maximumRuleInvocations = 100; }},
+      {"deadline", large,
+       [](Limits &limits) {
+         limits.deadline = steady_clock::now() - seconds{1};
+       }},
+  };
+
+  bool valid = true;
+  for (auto const &limit : cases) {
+    Options options;
+    limit.restrict(options.limits);
+
+    bool stopped = false;
+    try {
+      convertBuffer(parent, limit.input.data(), limit.input.size(),
+                    limit.name, options);
+    } catch (limit_error const &) {
+      stopped = true;
+    }
+    valid = expect(stopped, string{"The parser ignored the "} + limit.name +
+                                " limit") &&
+            valid;
+
+    stopped = false;
+    IncrementalParser parser{parent, options};
+    try {
+      parser.update(limit.input);
+    } catch (limit_error const &) {
+      stopped = true;
+    }
+    valid = expect(stopped, string{"The incremental parser ignored the "} +
+                                limit.name + " limit") &&
+            valid;
+  }
+
+  // An update of a single entry has to respect the limit for the whole
+  // document
+  Options options;
+  options.limits.maximumKeys = 3;
+  IncrementalParser parser{parent, options};
+  parser.update("a: 1\nb: 2\n");
+  bool stopped = false;
+  try {
+    parser.update("a: 1\nb: 2\nc: 3\nd: 4\n");
+  } catch (limit_error const &) {
+    stopped = true;
+  }
+  return expect(stopped && parser.getKeySet().size() == 2,
+                "The incremental parser ignored the key limit of an update") &&
+         valid;
+}
+
+/**
+ * @brief This function checks that conversions write, reuse and replace
+ *        snapshots.
+ *
+ * @retval true If the snapshots behaved as expected
+ * @retval false Otherwise
+ */
+bool checkSnapshot() {
+  TemporaryFile file;
+  TemporaryFile snapshot;
+  CppKey parent{"user/tests/snapshot", KEY_END};
+  string const name = "user/tests/snapshot/key";
+
+  // The snapshot file is empty and therefore invalid
+  string content = "key: value\nlist:\n  - element\n";
+  writeText(file.path, content);
+  CppKeySet keys = convertWithSnapshot(parent, file.path, snapshot.path);
+  bool valid = expect(value(keys, name) == "value",
+                      "Unable to convert a file without valid snapshot");
+  Snapshot written{snapshot.path};
+  valid = expect(written.matches(hash(content.data(), content.size()),
+                                 content.size()) &&
+                     written.size() == static_cast<size_t>(keys.size()),
+                 "The conversion did not write a snapshot") &&
+          valid;
+
+  CppKey other{"user/tests/other", KEY_END};
+  CppKeySet moved = written.toKeySet(other);
+  CppKey array = moved.lookup(string{"user/tests/other/list"});
+  valid = expect(value(moved, "user/tests/other/list/#0") == "element" &&
+                     array && array.getMeta<string>("array") == "#0",
+                 "The snapshot does not restore values and metadata") &&
+          valid;
+
+  // A snapshot for the current content replaces the conversion
+  CppKeySet stored;
+  stored.append(CppKey{name, KEY_VALUE, "stored", KEY_END});
+  writeSnapshot(stored, parent, hash(content.data(), content.size()),
+                content.size(), snapshot.path);
+  valid = expect(value(convertWithSnapshot(parent, file.path, snapshot.path),
+                       name) == "stored",
+                 "The conversion did not reuse a valid snapshot") &&
+          valid;
+
+  content = "key: other\n";
+  writeText(file.path, content);
+  valid = expect(value(convertWithSnapshot(parent, file.path, snapshot.path),
+                       name) == "other",
+                 "The conversion used the snapshot of a changed file") &&
+          valid;
+  valid = expect(Snapshot{snapshot.path}.matches(
+                     hash(content.data(), content.size()), content.size()),
+                 "The conversion did not replace an outdated snapshot") &&
+          valid;
+
+  // Truncated snapshots are invalid
+  string data = readFile(snapshot.path);
+  writeText(snapshot.path, data.substr(0, data.size() - 1));
+  bool rejected = false;
+  try {
+    Snapshot truncated{snapshot.path};
+  } catch (runtime_error const &) {
+    rejected = true;
+  }
+  valid = expect(rejected, "Reading a truncated snapshot did not fail") &&
+          valid;
+  return expect(value(convertWithSnapshot(parent, file.path, snapshot.path),
+                      name) == "other",
+                "The conversion failed for a truncated snapshot") &&
+         valid;
+}
+
+#if defined(__linux__)
+/**
+ * @brief This function checks that the watcher publishes reloaded keys and
+ *        keeps old snapshots and the last valid keys.
+ *
+ * @retval true If the watcher behaved as expected
+ * @retval false Otherwise
+ */
+bool checkWatcher() {
+  using std::chrono::milliseconds;
+  using std::chrono::seconds;
+  using std::chrono::steady_clock;
+
+  TemporaryFile file;
+  CppKey parent{"user/tests/watcher", KEY_END};
+  string const name = "user/tests/watcher/key";
+  writeText(file.path, "key: first\n");
+  Watcher watcher{parent, {file.path}};
+
+  auto valueOf = [&name](Watcher::Snapshot const &snapshot) {
+    ckdb::Key const *key = snapshot.lookup(name);
+    return key ? string{ckdb::keyString(key)} : string{"<missing>"};
+  };
+  // The watcher reloads the file on a background thread
+  auto await = [&watcher](uint64_t version, uint64_t failures) {
+    auto start = steady_clock::now();
+    while (watcher.version() == version && watcher.failures() == failures) {
+      if (steady_clock::now() - start > seconds{5}) {
+        return false;
+      }
+      std::this_thread::sleep_for(milliseconds{1});
+    }
+    return true;
+  };
+
+  Watcher::Snapshot old = watcher.snapshot();
+  bool valid = expect(valueOf(old) == "first",
+                      "The watcher did not convert the file");
+
+  uint64_t version = watcher.version();
+  writeText(file.path, "key: second\n");
+  valid = expect(await(version, watcher.failures()) &&
+                     watcher.version() > version,
+                 "The watcher did not publish a reload") &&
+          valid;
+  valid = expect(valueOf(watcher.snapshot()) == "second",
+                 "The watcher published the wrong keys") &&
+          valid;
+  valid = expect(valueOf(old) == "first",
+                 "A reload changed the keys of an old snapshot") &&
+          valid;
+
+  uint64_t failures = watcher.failures();
+  writeText(file.path, "key: \"unterminated\n");
+  valid = expect(await(watcher.version(), failures) &&
+                     watcher.failures() > failures,
+                 "The watcher did not report an invalid file") &&
+          valid;
+  return expect(valueOf(watcher.snapshot()) == "second",
+                "The watcher did not keep the last valid keys") &&
+         valid;
+}
+#endif
+
+/**
+ * @brief This function returns all checks of the tool.
+ *
+ * @return A list of named checks
+ */
+vector<Check> checks() {
+  return {
+      {"cache", checkCache},
+      {"emitter", checkEmitter},
+      {"incremental", checkIncremental},
+      {"intern", checkIntern},
+      {"lazy", checkLazy},
+      {"limits", checkLimits},
+      {"plugin", checkPlugin},
+      {"snapshot", checkSnapshot},
+#if defined(__linux__)
+      {"watcher", checkWatcher},
+#endif
+  };
+}
+
+} // namespace
+
+// -- Main ---------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+  vector<string> selected{argv + 1, argv + argc};
+  bool valid = true;
+  size_t executed = 0;
+
+  for (auto const &check : checks()) {
+    if (!selected.empty() &&
+        std::find(selected.begin(), selected.end(), check.name) ==
+            selected.end()) {
+      continue;
+    }
+    executed++;
+    cout << "• " << check.name << endl;
+    try {
+      valid = check.run() && valid;
+    } catch (exception const &error) {
+      cerr << "  ✗ " << error.what() << endl;
+      valid = false;
+    }
+  }
+
+  if (executed == 0) {
+    cerr << "Usage: " << argv[0] << " [check…]" << endl;
+    return EXIT_FAILURE;
+  }
+  return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,447 @@
+/**
+ * @file
+ *
+ * @brief This file contains the implementation of a binary key set snapshot.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+#include "convert.hpp"
+#include "hash.hpp"
+#include "snapshot.hpp"
+
+using kdb::Key;
+using kdb::KeySet;
+using std::runtime_error;
+using std::string;
+using std::string_view;
+using std::vector;
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using yaypeg::Snapshot;
+
+/** @brief This text identifies snapshot files. */
+char const magic[8] = {'Y', 'A', 'Y', 'P', 'E', 'G', 'K', 'S'};
+
+/** @brief This number specifies the version of the snapshot format. */
+uint32_t const version = 1;
+
+/**
+ * @brief This function adds a string to the string table.
+ *
+ * @param strings This variable stores the string table.
+ * @param text This argument stores the string the function adds.
+ *
+ * @return The offset of `text` in the string table
+ */
+uint64_t addString(string &strings, string_view text) {
+  uint64_t offset = strings.size();
+  strings.append(text.data(), text.size());
+  strings.push_back('\0');
+  return offset;
+}
+
+/**
+ * @brief This function checks if the string table contains a null terminated
+ *        string at the given location.
+ *
+ * @param strings This variable stores the start of the string table.
+ * @param size This number stores the size of the string table.
+ * @param offset This number specifies the start of the string.
+ * @param length This number specifies the length of the string.
+ *
+ * @retval true If the location is valid
+ * @retval false Otherwise
+ */
+bool valid(char const *strings, uint64_t size, uint64_t offset,
+           uint32_t length) {
+  return offset < size && length < size - offset &&
+         strings[offset + length] == '\0';
+}
+
+/**
+ * @brief This function writes the given data to a file descriptor.
+ *
+ * @param descriptor This number specifies the file descriptor.
+ * @param data This argument stores the data the function writes.
+ *
+ * @retval true If the function wrote all data successfully
+ * @retval false Otherwise
+ */
+bool writeAll(int descriptor, string const &data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t bytes =
+        write(descriptor, data.data() + written, data.size() - written);
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes < 0) {
+      return false;
+    }
+    written += static_cast<size_t>(bytes);
+  }
+  return true;
+}
+
+} // namespace
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+// ===========
+// = KeyView =
+// ===========
+
+/**
+ * @brief This method returns the name of the key relative to the parent key
+ *        of the snapshot.
+ *
+ * @return The relative (null terminated) name of the key
+ */
+string_view Snapshot::KeyView::name() const noexcept {
+  return snapshot->text(record->name, record->nameSize);
+}
+
+/**
+ * @brief This method returns the (null terminated) value of the key.
+ *
+ * @return The value of the key or an empty view with data `nullptr` if the
+ *         key does not store a value
+ */
+string_view Snapshot::KeyView::value() const noexcept {
+  if (record->value == null) {
+    return string_view{};
+  }
+  return snapshot->text(record->value, record->valueSize);
+}
+
+/**
+ * @brief This method returns the value of a metakey.
+ *
+ * @param metaName This parameter specifies the name of the metakey.
+ *
+ * @return The value of the metakey or an empty view with data `nullptr` if
+ *         the key does not contain the given metakey
+ */
+string_view Snapshot::KeyView::meta(string_view metaName) const noexcept {
+  for (auto meta = snapshot->metaRecords + record->meta;
+       meta < snapshot->metaRecords + record->meta + record->metaKeys;
+       meta++) {
+    if (snapshot->text(meta->name, meta->nameSize) == metaName) {
+      return snapshot->text(meta->value, meta->valueSize);
+    }
+  }
+  return string_view{};
+}
+
+// ============
+// = Snapshot =
+// ============
+
+/**
+ * @brief This method returns a string from the string table.
+ *
+ * @param offset This number specifies the start of the string.
+ * @param size This number specifies the length of the string.
+ *
+ * @return The string at the given location
+ */
+string_view Snapshot::text(uint64_t offset, uint32_t size) const noexcept {
+  return string_view{strings + offset, size};
+}
+
+/**
+ * @brief This constructor maps the given snapshot file into memory.
+ *
+ * @param filename This parameter stores the path of the snapshot file.
+ *
+ * @throws std::system_error if the constructor is unable to read `filename`
+ * @throws std::runtime_error if `filename` does not contain a valid snapshot
+ */
+Snapshot::Snapshot(string const &filename) : file{filename} {
+  char const *data = file.data();
+  uint64_t size = file.size();
+
+  if (size < sizeof(Header)) {
+    throw runtime_error("Snapshot “" + filename + "” is too small");
+  }
+  header = reinterpret_cast<Header const *>(data);
+  if (memcmp(header->magic, magic, sizeof(magic)) != 0 ||
+      header->version != version || header->byteOrder != 0x01020304) {
+    throw runtime_error("“" + filename + "” is not a compatible snapshot");
+  }
+
+  uint64_t available = size - sizeof(Header);
+  if (header->keys > available / sizeof(Record) ||
+      header->metaKeys >
+          (available - header->keys * sizeof(Record)) / sizeof(MetaRecord) ||
+      header->strings != available - header->keys * sizeof(Record) -
+                             header->metaKeys * sizeof(MetaRecord)) {
+    throw runtime_error("Snapshot “" + filename + "” is truncated");
+  }
+
+  records = reinterpret_cast<Record const *>(data + sizeof(Header));
+  metaRecords = reinterpret_cast<MetaRecord const *>(records + header->keys);
+  strings = reinterpret_cast<char const *>(metaRecords + header->metaKeys);
+
+  // We check all offsets once, so that the accessors do not need to check
+  // them again.
+  for (auto record = records; record < records + header->keys; record++) {
+    bool correct =
+        valid(strings, header->strings, record->name, record->nameSize) &&
+        (record->value == null ||
+         valid(strings, header->strings, record->value, record->valueSize)) &&
+        record->meta <= header->metaKeys &&
+        record->metaKeys <= header->metaKeys - record->meta;
+    if (!correct) {
+      throw runtime_error("Snapshot “" + filename + "” is corrupt");
+    }
+  }
+  for (auto meta = metaRecords; meta < metaRecords + header->metaKeys;
+       meta++) {
+    if (!valid(strings, header->strings, meta->name, meta->nameSize) ||
+        !valid(strings, header->strings, meta->value, meta->valueSize)) {
+      throw runtime_error("Snapshot “" + filename + "” is corrupt");
+    }
+  }
+}
+
+/**
+ * @brief This method checks if the snapshot contains the data of the given
+ *        YAML file.
+ *
+ * @param sourceHash This number specifies the hash of the YAML file.
+ * @param sourceSize This number specifies the size of the YAML file.
+ *
+ * @retval true If the snapshot was created from a file with the given hash
+ *              and size
+ * @retval false Otherwise
+ */
+bool Snapshot::matches(uint64_t sourceHash, uint64_t sourceSize) const
+    noexcept {
+  return header->sourceHash == sourceHash && header->sourceSize == sourceSize;
+}
+
+/**
+ * @brief This method returns the number of keys stored in the snapshot.
+ *
+ * @return The number of keys in the snapshot
+ */
+size_t Snapshot::size() const noexcept { return header->keys; }
+
+/**
+ * @brief This method returns a view of the key at the given position.
+ *
+ * @pre The value of `index` has to be smaller than `size()`.
+ *
+ * @param index This number specifies the position of the key.
+ *
+ * @return A read only view of the key
+ */
+Snapshot::KeyView Snapshot::operator[](size_t index) const noexcept {
+  return KeyView{this, records + index};
+}
+
+/**
+ * @brief This method creates a key set from the data of the snapshot.
+ *
+ * @param parent This key specifies the parent of all keys the method
+ *               creates.
+ *
+ * @return A key set containing all keys of the snapshot
+ */
+KeySet Snapshot::toKeySet(Key const &parent) const {
+  ckdb::KeySet *keys = ckdb::ksNew(size(), KS_END);
+  string name = parent.getName();
+  size_t prefix = name.size();
+
+  // The snapshot stores the keys in the order of the original key set.
+  // Appending them in this order is therefore cheap.
+  for (size_t index = 0; index < size(); index++) {
+    KeyView view = (*this)[index];
+    name.resize(prefix);
+    name.append(view.name());
+
+    ckdb::Key *key = view.value().data()
+                         ? ckdb::keyNew(name.c_str(), KEY_VALUE,
+                                        view.value().data(), KEY_END)
+                         : ckdb::keyNew(name.c_str(), KEY_END);
+    for (auto meta = metaRecords + view.record->meta;
+         meta < metaRecords + view.record->meta + view.record->metaKeys;
+         meta++) {
+      ckdb::keySetMeta(key, strings + meta->name, strings + meta->value);
+    }
+    ckdb::ksAppendKey(keys, key);
+  }
+
+  return KeySet{keys};
+}
+
+// -- Functions ----------------------------------------------------------------
+
+/**
+ * @brief This function stores the given key set in a snapshot file.
+ *
+ * @param keys This key set stores the keys the function saves.
+ * @param parent This key specifies the parent of all keys in `keys`.
+ * @param sourceHash This number specifies the hash of the YAML file that
+ *                   contains the data of `keys`.
+ * @param sourceSize This number specifies the size of the YAML file.
+ * @param filename This parameter stores the path of the snapshot file.
+ *
+ * @throws std::system_error if the function is unable to write `filename`
+ * @throws std::invalid_argument if `keys` contains a key that is not located
+ *         below `parent`
+ */
+void writeSnapshot(KeySet const &keys, Key const &parent, uint64_t sourceHash,
+                   uint64_t sourceSize, string const &filename) {
+  using std::invalid_argument;
+  using std::system_category;
+  using std::system_error;
+
+  string parentName = parent.getName();
+  vector<Snapshot::Record> records;
+  vector<Snapshot::MetaRecord> metaRecords;
+  string strings;
+  records.reserve(static_cast<size_t>(keys.size()));
+
+  for (auto key : keys) {
+    ckdb::Key *handle = key.getKey();
+    string_view name{ckdb::keyName(handle)};
+    if (name.compare(0, parentName.size(), parentName) != 0 ||
+        (name.size() > parentName.size() && name[parentName.size()] != '/')) {
+      throw invalid_argument("Key “" + string{name} + "” is not below “" +
+                             parentName + "”");
+    }
+    name.remove_prefix(parentName.size());
+
+    Snapshot::Record record;
+    record.nameSize = static_cast<uint32_t>(name.size());
+    record.name = addString(strings, name);
+    if (ckdb::keyGetValueSize(handle) > 0) {
+      string_view value{ckdb::keyString(handle)};
+      record.valueSize = static_cast<uint32_t>(value.size());
+      record.value = addString(strings, value);
+    } else {
+      record.valueSize = 0;
+      record.value = Snapshot::null;
+    }
+
+    record.meta = static_cast<uint32_t>(metaRecords.size());
+    ckdb::keyRewindMeta(handle);
+    while (ckdb::Key const *meta = ckdb::keyNextMeta(handle)) {
+      string_view metaName{ckdb::keyName(meta)};
+      string_view metaValue{ckdb::keyString(meta)};
+      Snapshot::MetaRecord metaRecord;
+      metaRecord.nameSize = static_cast<uint32_t>(metaName.size());
+      metaRecord.name = addString(strings, metaName);
+      metaRecord.valueSize = static_cast<uint32_t>(metaValue.size());
+      metaRecord.value = addString(strings, metaValue);
+      metaRecords.push_back(metaRecord);
+    }
+    record.metaKeys = static_cast<uint32_t>(metaRecords.size() - record.meta);
+    records.push_back(record);
+  }
+
+  Snapshot::Header header;
+  memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.byteOrder = 0x01020304;
+  header.sourceHash = sourceHash;
+  header.sourceSize = sourceSize;
+  header.keys = records.size();
+  header.metaKeys = metaRecords.size();
+  header.strings = strings.size();
+
+  string content;
+  content.reserve(sizeof(header) + records.size() * sizeof(Snapshot::Record) +
+                  metaRecords.size() * sizeof(Snapshot::MetaRecord) +
+                  strings.size());
+  content.append(reinterpret_cast<char const *>(&header), sizeof(header));
+  content.append(reinterpret_cast<char const *>(records.data()),
+                 records.size() * sizeof(Snapshot::Record));
+  content.append(reinterpret_cast<char const *>(metaRecords.data()),
+                 metaRecords.size() * sizeof(Snapshot::MetaRecord));
+  content.append(strings);
+
+  // We write to a temporary file first, so that readers never see a partial
+  // snapshot.
+  string temporary = filename + ".XXXXXX";
+  int descriptor = mkstemp(&temporary[0]);
+  if (descriptor < 0) {
+    throw system_error(errno, system_category(),
+                       "Unable to create snapshot “" + filename + "”");
+  }
+  bool success = writeAll(descriptor, content);
+  int error = errno;
+  success = (close(descriptor) == 0) && success;
+  if (success && rename(temporary.c_str(), filename.c_str()) == 0) {
+    return;
+  }
+  error = success ? errno : error;
+  unlink(temporary.c_str());
+  throw system_error(error, system_category(),
+                     "Unable to write snapshot “" + filename + "”");
+}
+
+/**
+ * @brief This function converts the given YAML file to a key set using a
+ *        snapshot file if possible.
+ *
+ * If the snapshot is missing or was created from a different version of the
+ * YAML file, then the function parses the YAML file and updates the
+ * snapshot.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param filename This parameter stores the path of the YAML file.
+ * @param snapshot This parameter stores the path of the snapshot file.
+ *
+ * @throws std::system_error if the function is unable to read `filename`
+ * @throws parse_error if the file does not contain (supported) YAML data
+ *
+ * @return A key set containing the data stored in `filename`
+ */
+KeySet convertWithSnapshot(Key const &parent, string const &filename,
+                           string const &snapshot) {
+  using std::exception;
+
+  MappedFile input{filename};
+  uint64_t checksum = hash(input.data(), input.size());
+
+  try {
+    Snapshot stored{snapshot};
+    if (stored.matches(checksum, input.size())) {
+      return stored.toKeySet(parent);
+    }
+  } catch (exception const &) {
+    // We ignore missing or invalid snapshots and parse the YAML file instead
+  }
+
+  KeySet keys = convertBuffer(parent, input.data(), input.size(), filename);
+
+  try {
+    writeSnapshot(keys, parent, checksum, input.size(), snapshot);
+  } catch (exception const &) {
+    // A missing snapshot only affects the speed of the next conversion
+  }
+
+  return keys;
+}
+
+} // namespace yaypeg
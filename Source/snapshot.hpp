@@ -0,0 +1,260 @@
+/**
+ * @file
+ *
+ * @brief This file contains the declaration of a binary key set snapshot.
+ *
+ * A snapshot stores the key set of a converted YAML file. Loading the
+ * snapshot is much faster than parsing the YAML file again. The layout of a
+ * snapshot file is:
+ *
+ * 1. a header (`Snapshot::Header`),
+ * 2. a record for every key (`Snapshot::Record`),
+ * 3. a record for every metakey (`Snapshot::MetaRecord`), and
+ * 4. a table of null terminated strings.
+ *
+ * Records refer to names and values using offsets into the string table.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_SNAPSHOT_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_SNAPSHOT_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <kdb.hpp>
+
+#include "file.hpp"
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This class provides read only access to a snapshot file.
+ */
+class Snapshot {
+public:
+  /** @brief This offset specifies that a key does not store a value. */
+  static constexpr uint64_t null = UINT64_MAX;
+
+  /**
+   * @brief This struct stores the header of a snapshot file.
+   */
+  struct Header {
+    /** @brief This text identifies the file as snapshot. */
+    char magic[8];
+    /** @brief This number stores the version of the file format. */
+    uint32_t version;
+    /** @brief This number stores the value `0x01020304` in the byte order
+     *         of the machine that wrote the snapshot. */
+    uint32_t byteOrder;
+    /** @brief This number stores the hash of the YAML file. */
+    uint64_t sourceHash;
+    /** @brief This number stores the size of the YAML file in bytes. */
+    uint64_t sourceSize;
+    /** @brief This number stores the number of key records. */
+    uint64_t keys;
+    /** @brief This number stores the number of metakey records. */
+    uint64_t metaKeys;
+    /** @brief This number stores the size of the string table in bytes. */
+    uint64_t strings;
+  };
+
+  /**
+   * @brief This struct stores the data of a single key.
+   */
+  struct Record {
+    /** @brief This number stores the offset of the key name relative to the
+     *         name of the parent key. */
+    uint64_t name;
+    /** @brief This number stores the offset of the value. The value
+     *         `Snapshot::null` specifies a key without value. */
+    uint64_t value;
+    /** @brief This number stores the length of the name. */
+    uint32_t nameSize;
+    /** @brief This number stores the length of the value. */
+    uint32_t valueSize;
+    /** @brief This number stores the index of the first metakey record. */
+    uint32_t meta;
+    /** @brief This number stores the number of metakeys. */
+    uint32_t metaKeys;
+  };
+
+  /**
+   * @brief This struct stores the data of a single metakey.
+   */
+  struct MetaRecord {
+    /** @brief This number stores the offset of the name. */
+    uint64_t name;
+    /** @brief This number stores the offset of the value. */
+    uint64_t value;
+    /** @brief This number stores the length of the name. */
+    uint32_t nameSize;
+    /** @brief This number stores the length of the value. */
+    uint32_t valueSize;
+  };
+
+  /**
+   * @brief This struct provides read only access to a key of the snapshot.
+   */
+  struct KeyView {
+    /** @brief This variable stores the snapshot containing the key. */
+    Snapshot const *snapshot;
+    /** @brief This variable stores the record of the key. */
+    Record const *record;
+
+    /**
+     * @brief This method returns the name of the key relative to the parent
+     *        key of the snapshot.
+     *
+     * @return The relative (null terminated) name of the key
+     */
+    std::string_view name() const noexcept;
+
+    /**
+     * @brief This method returns the (null terminated) value of the key.
+     *
+     * @return The value of the key or an empty view with data `nullptr` if
+     *         the key does not store a value
+     */
+    std::string_view value() const noexcept;
+
+    /**
+     * @brief This method returns the value of a metakey.
+     *
+     * @param metaName This parameter specifies the name of the metakey.
+     *
+     * @return The value of the metakey or an empty view with data `nullptr`
+     *         if the key does not contain the given metakey
+     */
+    std::string_view meta(std::string_view metaName) const noexcept;
+  };
+
+private:
+  /** @brief This variable stores the memory mapped snapshot file. */
+  MappedFile file;
+
+  /** @brief This variable stores the header of the snapshot. */
+  Header const *header;
+
+  /** @brief This variable stores the first key record. */
+  Record const *records;
+
+  /** @brief This variable stores the first metakey record. */
+  MetaRecord const *metaRecords;
+
+  /** @brief This variable stores the start of the string table. */
+  char const *strings;
+
+  /**
+   * @brief This method returns a string from the string table.
+   *
+   * @param offset This number specifies the start of the string.
+   * @param size This number specifies the length of the string.
+   *
+   * @return The string at the given location
+   */
+  std::string_view text(uint64_t offset, uint32_t size) const noexcept;
+
+public:
+  /**
+   * @brief This constructor maps the given snapshot file into memory.
+   *
+   * @param filename This parameter stores the path of the snapshot file.
+   *
+   * @throws std::system_error if the constructor is unable to read `filename`
+   * @throws std::runtime_error if `filename` does not contain a valid
+   *         snapshot
+   */
+  explicit Snapshot(std::string const &filename);
+
+  /**
+   * @brief This method checks if the snapshot contains the data of the given
+   *        YAML file.
+   *
+   * @param sourceHash This number specifies the hash of the YAML file.
+   * @param sourceSize This number specifies the size of the YAML file.
+   *
+   * @retval true If the snapshot was created from a file with the given hash
+   *              and size
+   * @retval false Otherwise
+   */
+  bool matches(uint64_t sourceHash, uint64_t sourceSize) const noexcept;
+
+  /**
+   * @brief This method returns the number of keys stored in the snapshot.
+   *
+   * @return The number of keys in the snapshot
+   */
+  size_t size() const noexcept;
+
+  /**
+   * @brief This method returns a view of the key at the given position.
+   *
+   * @pre The value of `index` has to be smaller than `size()`.
+   *
+   * @param index This number specifies the position of the key.
+   *
+   * @return A read only view of the key
+   */
+  KeyView operator[](size_t index) const noexcept;
+
+  /**
+   * @brief This method creates a key set from the data of the snapshot.
+   *
+   * @param parent This key specifies the parent of all keys the method
+   *               creates.
+   *
+   * @return A key set containing all keys of the snapshot
+   */
+  kdb::KeySet toKeySet(kdb::Key const &parent) const;
+};
+
+/**
+ * @brief This function stores the given key set in a snapshot file.
+ *
+ * @param keys This key set stores the keys the function saves.
+ * @param parent This key specifies the parent of all keys in `keys`.
+ * @param sourceHash This number specifies the hash of the YAML file that
+ *                   contains the data of `keys`.
+ * @param sourceSize This number specifies the size of the YAML file.
+ * @param filename This parameter stores the path of the snapshot file.
+ *
+ * @throws std::system_error if the function is unable to write `filename`
+ * @throws std::invalid_argument if `keys` contains a key that is not located
+ *         below `parent`
+ */
+void writeSnapshot(kdb::KeySet const &keys, kdb::Key const &parent,
+                   uint64_t sourceHash, uint64_t sourceSize,
+                   std::string const &filename);
+
+/**
+ * @brief This function converts the given YAML file to a key set using a
+ *        snapshot file if possible.
+ *
+ * If the snapshot is missing or was created from a different version of the
+ * YAML file, then the function parses the YAML file and updates the
+ * snapshot.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param filename This parameter stores the path of the YAML file.
+ * @param snapshot This parameter stores the path of the snapshot file.
+ *
+ * @throws std::system_error if the function is unable to read `filename`
+ * @throws parse_error if the file does not contain (supported) YAML data
+ *
+ * @return A key set containing the data stored in `filename`
+ */
+kdb::KeySet convertWithSnapshot(kdb::Key const &parent,
+                                std::string const &filename,
+                                std::string const &snapshot);
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_SNAPSHOT_HPP
@@ -12,16 +12,27 @@
 
 // -- Imports ------------------------------------------------------------------
 
+#include <cstdint>
 #include <deque>
 #include <stack>
 #include <string>
+#include <unordered_map>
 
 #include <kdb.hpp>
 
+#include "limits.hpp"
+#include "memory.hpp"
+
 // -- Class --------------------------------------------------------------------
 
+namespace spdlog {
+class logger;
+} // namespace spdlog
+
 namespace yaypeg {
 
+class StructuralIndex;
+
 /**
  * @brief This custom state stores contextual data used during the parsing
  *        process.
@@ -44,8 +55,12 @@ struct State {
                ///< collection.
   };
 
+  /** @brief This counter records the memory usage of the stacks of the
+   *         state. */
+  MemoryCounter memory;
+
   /** @brief This stack stores the current contexts. */
-  std::stack<Context> context;
+  CountedStack<Context> context{CountingAllocator<Context>{&memory}};
 
   /**
    * @brief We use this double ended queue as stack to store the indentation
@@ -54,7 +69,40 @@ struct State {
    * We use a `deque` instead of a stack since we need access to both the last
    * element and the element before that.
    */
-  std::deque<long long> indentation{std::initializer_list<long long>{-1}};
+  CountedDeque<long long> indentation{std::initializer_list<long long>{-1},
+                                      CountingAllocator<long long>{&memory}};
+
+  /**
+   * @brief This map stores the content indentation of block scalars with an
+   *        indentation indicator by the position of their header.
+   *
+   * The indentation of these scalars depends on the indentation of their
+   * parent node, which their text does not contain.
+   */
+  std::unordered_map<char const *, size_t> blockIndentation;
+
+  /** @brief This variable stores the start of the first line after the
+   *         current document that starts with a document marker, or
+   *         `nullptr` if the document ends with the input. */
+  char const *documentEnd = nullptr;
+
+  /** @brief This variable stores the resource limits of the conversion. */
+  Limits limits;
+
+  /** @brief This number stores how often the parser invoked grammar rules. */
+  uint64_t invocations = 0;
+
+  /** @brief This number stores the nesting depth of the collection the
+   *         parser currently matches. */
+  size_t depth = 0;
+
+  /** @brief Grammar rules read spaces and line breaks from this index of the
+   *         input, if it is not `nullptr`. */
+  StructuralIndex const *structure = nullptr;
+
+  /** @brief The parser writes trace messages to this logger, if it is not
+   *         `nullptr`. */
+  spdlog::logger *logger = nullptr;
 
   /**
    * @brief This method converts the state to a string.
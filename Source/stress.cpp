@@ -0,0 +1,220 @@
+/**
+ * @file
+ *
+ * @brief This file contains a tool that converts documents on many threads
+ *        at the same time.
+ *
+ * The tool first converts every file once on the main thread. Afterwards it
+ * starts multiple threads that all convert every file again and compares the
+ * results with the first conversion. Built with Thread Sanitizer
+ * (`ENABLE_THREAD_SANITIZER`), the tool reports data races between
+ * concurrent conversions.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <tao/pegtl.hpp>
+
+#include <kdb.hpp>
+
+#include "convert.hpp"
+#include "file.hpp"
+#include "intern.hpp"
+#include "options.hpp"
+
+using std::atomic;
+using std::cerr;
+using std::endl;
+using std::exception;
+using std::string;
+using std::system_error;
+using std::thread;
+using std::vector;
+
+using kdb::Key;
+using kdb::KeySet;
+
+using yaypeg::convertBuffer;
+using yaypeg::InternTable;
+using yaypeg::MappedFile;
+using yaypeg::Options;
+
+// -- Types --------------------------------------------------------------------
+
+namespace {
+
+/** @brief This struct stores an input file and its expected conversion. */
+struct Document {
+  /** @brief This text stores the path of the file. */
+  string filename;
+  /** @brief This text stores the content of the file. */
+  string content;
+  /** @brief This text stores the keys of the first conversion, or the error
+   *         message if the conversion failed. */
+  string expected;
+};
+
+// -- Constants ----------------------------------------------------------------
+
+/** @brief This constant specifies the default number of threads. */
+constexpr size_t defaultThreads = 8;
+
+/** @brief This constant specifies how often each thread converts every file
+ *         by default. */
+constexpr size_t defaultIterations = 50;
+
+// -- Functions ----------------------------------------------------------------
+
+/**
+ * @brief This function converts the given document and describes the result.
+ *
+ * @param document This argument stores the document the function converts.
+ * @param options This argument specifies options for the conversion.
+ *
+ * @return The names, values and metadata of all keys, or the error message
+ *         of a failed conversion
+ */
+string convert(Document const &document, Options const &options) {
+  Key parent{"user", KEY_END};
+  string result;
+  try {
+    KeySet keys = convertBuffer(parent, document.content.data(),
+                                document.content.size(), document.filename,
+                                options);
+    for (auto key : keys) {
+      result += key.getName() + ": " + key.getString() + "\n";
+      key.rewindMeta();
+      while (Key meta = key.nextMeta()) {
+        result += "  " + meta.getName() + ": " + meta.getString() + "\n";
+      }
+    }
+  } catch (exception const &error) {
+    result = string{"Error: "} + error.what();
+  }
+  return result;
+}
+
+/**
+ * @brief This function converts all documents multiple times and compares
+ *        the results with the expected output.
+ *
+ * @param documents This vector stores the documents the function converts.
+ * @param iterations This number specifies how often the function converts
+ *                   every document.
+ * @param failures The function increases this counter for every conversion
+ *                 with an unexpected result.
+ */
+void run(vector<Document> const &documents, size_t iterations,
+         atomic<size_t> &failures) {
+  // Intern tables are not thread-safe. Every thread therefore uses its own
+  // table (and options).
+  InternTable table;
+  Options options;
+  options.intern = &table;
+
+  for (size_t iteration = 0; iteration < iterations; iteration++) {
+    for (auto const &document : documents) {
+      if (convert(document, options) != document.expected) {
+        failures++;
+      }
+    }
+  }
+}
+
+/**
+ * @brief This function parses a positive number.
+ *
+ * @param text This text stores the number.
+ * @param number The function stores the number in this variable.
+ *
+ * @retval true If `text` contains a positive number
+ * @retval false Otherwise
+ */
+bool parseCount(char const *text, size_t &number) {
+  number = std::strtoull(text, nullptr, 10);
+  return number > 0;
+}
+
+} // namespace
+
+// -- Main ---------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+  string usage = string{"Usage: "} + argv[0] +
+                 " [--threads count] [--iterations count] filename…";
+
+  size_t threads = defaultThreads;
+  size_t iterations = defaultIterations;
+  int argument = 1;
+  for (; argument < argc && strncmp(argv[argument], "--", 2) == 0;
+       argument += 2) {
+    string option = argv[argument];
+    bool valid = argument + 1 < argc;
+    if (valid && option == "--threads") {
+      valid = parseCount(argv[argument + 1], threads);
+    } else if (valid && option == "--iterations") {
+      valid = parseCount(argv[argument + 1], iterations);
+    } else {
+      valid = false;
+    }
+    if (!valid) {
+      cerr << usage << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (argument >= argc) {
+    cerr << usage << endl;
+    return EXIT_FAILURE;
+  }
+
+  vector<Document> documents;
+  for (; argument < argc; argument++) {
+    try {
+      MappedFile file{argv[argument]};
+      documents.push_back(
+          Document{argv[argument], string{file.data(), file.size()}, ""});
+    } catch (system_error const &error) {
+      cerr << "Unable to open input: " << error.what() << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // The first conversion uses a fresh table, so the expected output does not
+  // depend on the tables of the threads.
+  InternTable table;
+  Options options;
+  options.intern = &table;
+  for (auto &document : documents) {
+    document.expected = convert(document, options);
+  }
+
+  atomic<size_t> failures{0};
+  vector<thread> workers;
+  for (size_t worker = 0; worker < threads; worker++) {
+    workers.emplace_back(run, std::cref(documents), iterations,
+                         std::ref(failures));
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  if (failures > 0) {
+    cerr << failures << " of " << threads * iterations * documents.size()
+         << " concurrent conversions returned an unexpected result" << endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,280 @@
+/**
+ * @file
+ *
+ * @brief This file contains a class that classifies the bytes of an input
+ *        before the parser reads it.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "structure.hpp"
+
+using std::vector;
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+/**
+ * @brief This function returns the length of a run of set bits.
+ *
+ * @pre The last bit of `bits` has to be unset.
+ *
+ * @param bits This bit map stores the bits the function checks.
+ * @param offset This number specifies the first bit of the run.
+ *
+ * @return The number of consecutive set bits starting at `offset`
+ */
+size_t runLength(vector<uint64_t> const &bits, size_t offset) noexcept {
+  size_t length = 0;
+  size_t word = offset / 64;
+  size_t bit = offset % 64;
+  while (true) {
+    uint64_t unset = ~(bits[word] >> bit);
+    size_t run = unset == 0 ? 64 : static_cast<size_t>(__builtin_ctzll(unset));
+    if (run < 64 - bit) {
+      return length + run;
+    }
+    length += 64 - bit;
+    word++;
+    bit = 0;
+  }
+}
+
+} // namespace
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+// ===========
+// = Private =
+// ===========
+
+/**
+ * @brief This method classifies a block of 64 characters.
+ *
+ * @param block This variable stores the start of the block.
+ * @param word This number specifies the index of the block.
+ */
+void StructuralIndex::classify(char const *block, size_t word) noexcept {
+  uint64_t spaces = 0;
+  uint64_t lineFeeds = 0;
+  uint64_t text = 0;
+  uint64_t stops = 0; // Tabs and indicators that end a run of plain text
+
+#if defined(__AVX2__)
+  __m256i const space = _mm256_set1_epi8(' ');
+  __m256i const lineFeed = _mm256_set1_epi8('\n');
+  __m256i const tab = _mm256_set1_epi8('\t');
+  __m256i const control = _mm256_set1_epi8(0x1F);
+  __m256i const del = _mm256_set1_epi8(0x7F);
+  for (size_t part = 0; part < 64; part += 32) {
+    __m256i characters =
+        _mm256_loadu_si256(reinterpret_cast<__m256i const *>(block + part));
+    // Characters above `0x7F` are negative and therefore no text
+    __m256i printable =
+        _mm256_or_si256(_mm256_andnot_si256(_mm256_cmpeq_epi8(characters, del),
+                                            _mm256_cmpgt_epi8(characters,
+                                                              control)),
+                        _mm256_cmpeq_epi8(characters, tab));
+    __m256i stop = _mm256_cmpeq_epi8(characters, tab);
+    for (char indicator : {':', '#', ',', '[', ']', '{', '}'}) {
+      stop = _mm256_or_si256(
+          stop, _mm256_cmpeq_epi8(characters, _mm256_set1_epi8(indicator)));
+    }
+    stops |= static_cast<uint64_t>(
+                 static_cast<uint32_t>(_mm256_movemask_epi8(stop)))
+             << part;
+    spaces |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(
+                  _mm256_cmpeq_epi8(characters, space))))
+              << part;
+    lineFeeds |= static_cast<uint64_t>(static_cast<uint32_t>(
+                     _mm256_movemask_epi8(
+                         _mm256_cmpeq_epi8(characters, lineFeed))))
+                 << part;
+    text |= static_cast<uint64_t>(
+                static_cast<uint32_t>(_mm256_movemask_epi8(printable)))
+            << part;
+  }
+#elif defined(__SSE2__)
+  __m128i const space = _mm_set1_epi8(' ');
+  __m128i const lineFeed = _mm_set1_epi8('\n');
+  __m128i const tab = _mm_set1_epi8('\t');
+  __m128i const control = _mm_set1_epi8(0x1F);
+  __m128i const del = _mm_set1_epi8(0x7F);
+  for (size_t part = 0; part < 64; part += 16) {
+    __m128i characters =
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(block + part));
+    // Characters above `0x7F` are negative and therefore no text
+    __m128i printable = _mm_or_si128(
+        _mm_andnot_si128(_mm_cmpeq_epi8(characters, del),
+                         _mm_cmpgt_epi8(characters, control)),
+        _mm_cmpeq_epi8(characters, tab));
+    __m128i stop = _mm_cmpeq_epi8(characters, tab);
+    for (char indicator : {':', '#', ',', '[', ']', '{', '}'}) {
+      stop = _mm_or_si128(stop,
+                          _mm_cmpeq_epi8(characters, _mm_set1_epi8(indicator)));
+    }
+    stops |=
+        static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(stop)))
+        << part;
+    spaces |= static_cast<uint64_t>(static_cast<uint32_t>(
+                  _mm_movemask_epi8(_mm_cmpeq_epi8(characters, space))))
+              << part;
+    lineFeeds |= static_cast<uint64_t>(static_cast<uint32_t>(
+                     _mm_movemask_epi8(_mm_cmpeq_epi8(characters, lineFeed))))
+                 << part;
+    text |= static_cast<uint64_t>(
+                static_cast<uint32_t>(_mm_movemask_epi8(printable)))
+            << part;
+  }
+#else
+  for (size_t index = 0; index < 64; index++) {
+    auto character = static_cast<unsigned char>(block[index]);
+    uint64_t bit = uint64_t{1} << index;
+    if (character == ' ') {
+      spaces |= bit;
+    } else if (character == '\n') {
+      lineFeeds |= bit;
+    }
+    if ((character > 0x1F && character < 0x7F) || character == '\t') {
+      text |= bit;
+    }
+    if (character != 0 && strchr("\t:#,[]{}", character)) {
+      stops |= bit;
+    }
+  }
+#endif
+
+  spaceBits[word] = spaces;
+  lineFeedBits[word] = lineFeeds;
+  textBits[word] = text;
+  plainBits[word] = text & ~spaces & ~stops;
+}
+
+// ==========
+// = Public =
+// ==========
+
+/**
+ * @brief This constructor creates the index of the given input.
+ *
+ * @param data This variable stores the start of the input.
+ * @param size This number specifies the length of `data` in bytes.
+ */
+StructuralIndex::StructuralIndex(char const *data, size_t size)
+    : begin{data}, end{data + size}, spaceBits(size / 64 + 1),
+      lineFeedBits(size / 64 + 1), textBits(size / 64 + 1),
+      plainBits(size / 64 + 1) {
+  size_t word = 0;
+  for (; (word + 1) * 64 <= size; word++) {
+    classify(data + word * 64, word);
+  }
+
+  // The last block always contains padding after the input, so every run of
+  // set bits ends inside the bit maps. Null characters belong to no class.
+  char last[64] = {};
+  if (size > word * 64) {
+    memcpy(last, data + word * 64, size - word * 64);
+  }
+  classify(last, word);
+}
+
+/**
+ * @brief This method returns the number of spaces at a location.
+ *
+ * @param position This variable points to a character of the input (or
+ *                 to its end).
+ *
+ * @return The number of consecutive spaces starting at `position`
+ */
+size_t StructuralIndex::spaces(char const *position) const noexcept {
+  return runLength(spaceBits, static_cast<size_t>(position - begin));
+}
+
+/**
+ * @brief This method returns the end of a run of text.
+ *
+ * @param position This variable points to a character of the input (or
+ *                 to its end).
+ *
+ * @return The first character at or after `position` that is neither a
+ *         printable ASCII character nor a tab, or the end of the input
+ */
+char const *StructuralIndex::textEnd(char const *position) const noexcept {
+  return position + runLength(textBits, static_cast<size_t>(position - begin));
+}
+
+/**
+ * @brief This method returns the end of a run of plain text.
+ *
+ * @param position This variable points to a character of the input (or
+ *                 to its end).
+ *
+ * @return The first character at or after `position` that is a space, a
+ *         tab, one of the indicators `:#,[]{}`, no printable ASCII character
+ *         or the end of the input
+ */
+char const *StructuralIndex::plainEnd(char const *position) const noexcept {
+  return position +
+         runLength(plainBits, static_cast<size_t>(position - begin));
+}
+
+/**
+ * @brief This method returns the start of the next line.
+ *
+ * @param position This variable points to a character of the input (or
+ *                 to its end).
+ *
+ * @return The first character after the next line feed or the end of the
+ *         input, if the input does not contain another line feed
+ */
+char const *StructuralIndex::nextLine(char const *position) const noexcept {
+  auto offset = static_cast<size_t>(position - begin);
+  size_t word = offset / 64;
+  uint64_t bits = lineFeedBits[word] & (~uint64_t{0} << (offset % 64));
+  while (bits == 0) {
+    if (++word == lineFeedBits.size()) {
+      return end;
+    }
+    bits = lineFeedBits[word];
+  }
+  return begin + word * 64 + static_cast<size_t>(__builtin_ctzll(bits)) + 1;
+}
+
+/**
+ * @brief This method returns the number of lines of the input.
+ *
+ * @return The number of line feeds plus one
+ */
+size_t StructuralIndex::lines() const noexcept {
+  size_t count = 1;
+  for (auto bits : lineFeedBits) {
+    count += static_cast<size_t>(__builtin_popcountll(bits));
+  }
+  return count;
+}
+
+/**
+ * @brief This method returns the memory usage of the index.
+ *
+ * @return The size of the bit maps in bytes
+ */
+size_t StructuralIndex::bytes() const noexcept {
+  return (spaceBits.capacity() + lineFeedBits.capacity() +
+          textBits.capacity() + plainBits.capacity()) *
+         sizeof(uint64_t);
+}
+
+} // namespace yaypeg
@@ -0,0 +1,143 @@
+/**
+ * @file
+ *
+ * @brief This file contains a class that classifies the bytes of an input
+ *        before the parser reads it.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_STRUCTURE_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_STRUCTURE_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This class stores the structural index (stage 1) of an input.
+ *
+ * The structure of YAML data depends on line breaks and the number of spaces
+ * at the start of each line. The index classifies every byte of the input
+ * with SIMD instructions (AVX2 or SSE2, if available) and stores one bit per
+ * byte and class:
+ *
+ * - spaces (` `),
+ * - line feeds (`\n`), which mark the start of lines,
+ * - text (printable ASCII characters and tabs), and
+ * - plain text: printable ASCII characters except for spaces and the
+ *   indicators `:`, `#`, `,`, `[`, `]`, `{` and `}`. These characters
+ *   continue a plain scalar in every context. The indicators `-` and `?`
+ *   only matter at the start of a scalar and therefore count as plain text.
+ *
+ * Grammar rules use the index to count indentation spaces and to skip whole
+ * lines or runs of text and plain scalars, instead of reading the input
+ * character by character. The index does not mark quoted regions: Whether a
+ * quote starts a scalar (`'text'`) or belongs to a plain scalar (`don't`)
+ * depends on the grammar.
+ */
+class StructuralIndex {
+  /** @brief This variable stores the start of the input. */
+  char const *begin;
+
+  /** @brief This variable stores the end of the input. */
+  char const *end;
+
+  /** @brief This bit map marks all spaces of the input. */
+  std::vector<uint64_t> spaceBits;
+
+  /** @brief This bit map marks all line feeds of the input. */
+  std::vector<uint64_t> lineFeedBits;
+
+  /** @brief This bit map marks all printable ASCII characters and tabs. */
+  std::vector<uint64_t> textBits;
+
+  /** @brief This bit map marks all printable ASCII characters except for
+   *         spaces and indicators that end a run of plain text. */
+  std::vector<uint64_t> plainBits;
+
+  /**
+   * @brief This method classifies a block of 64 characters.
+   *
+   * @param block This variable stores the start of the block.
+   * @param word This number specifies the index of the block.
+   */
+  void classify(char const *block, size_t word) noexcept;
+
+public:
+  /**
+   * @brief This constructor creates the index of the given input.
+   *
+   * @param data This variable stores the start of the input.
+   * @param size This number specifies the length of `data` in bytes.
+   */
+  StructuralIndex(char const *data, size_t size);
+
+  /**
+   * @brief This method returns the number of spaces at a location.
+   *
+   * @param position This variable points to a character of the input (or
+   *                 to its end).
+   *
+   * @return The number of consecutive spaces starting at `position`
+   */
+  size_t spaces(char const *position) const noexcept;
+
+  /**
+   * @brief This method returns the end of a run of text.
+   *
+   * @param position This variable points to a character of the input (or
+   *                 to its end).
+   *
+   * @return The first character at or after `position` that is neither a
+   *         printable ASCII character nor a tab, or the end of the input
+   */
+  char const *textEnd(char const *position) const noexcept;
+
+  /**
+   * @brief This method returns the end of a run of plain text.
+   *
+   * @param position This variable points to a character of the input (or
+   *                 to its end).
+   *
+   * @return The first character at or after `position` that is a space, a
+   *         tab, one of the indicators `:#,[]{}`, no printable ASCII
+   *         character or the end of the input
+   */
+  char const *plainEnd(char const *position) const noexcept;
+
+  /**
+   * @brief This method returns the start of the next line.
+   *
+   * @param position This variable points to a character of the input (or
+   *                 to its end).
+   *
+   * @return The first character after the next line feed or the end of the
+   *         input, if the input does not contain another line feed
+   */
+  char const *nextLine(char const *position) const noexcept;
+
+  /**
+   * @brief This method returns the number of lines of the input.
+   *
+   * @return The number of line feeds plus one
+   */
+  size_t lines() const noexcept;
+
+  /**
+   * @brief This method returns the memory usage of the index.
+   *
+   * @return The size of the bit maps in bytes
+   */
+  size_t bytes() const noexcept;
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_STRUCTURE_HPP
@@ -0,0 +1,525 @@
+/**
+ * @file
+ *
+ * @brief This file contains a listener that records the calls of the walker
+ *        and a function that replays them.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "convert.hpp"
+#include "encoding.hpp"
+#include "file.hpp"
+#include "hash.hpp"
+#include "trace.hpp"
+#include "writer.hpp"
+
+using std::runtime_error;
+using std::string;
+using std::string_view;
+using std::system_category;
+using std::system_error;
+using std::vector;
+
+using kdb::Key;
+using kdb::KeySet;
+
+// -- Constants ----------------------------------------------------------------
+
+namespace {
+
+/** @brief This variable stores the signature at the start of every trace. */
+char const signature[8] = {'Y', 'A', 'Y', 'P', 'E', 'G', 'T', 'R'};
+
+/** @brief This number specifies the version of the trace format. */
+uint8_t const version = 1;
+
+/** @brief This enumeration specifies the listener methods of a trace. */
+enum Event : uint8_t {
+  EXIT_VALUE,
+  EXIT_INDENTED_VALUE,
+  EXIT_KEY,
+  EXIT_PAIR,
+  EXIT_ANCHOR,
+  EXIT_ALIAS,
+  ENTER_SEQUENCE,
+  EXIT_SEQUENCE,
+  ENTER_ELEMENT,
+  EXIT_ELEMENT
+};
+
+/**
+ * @brief This class reads the parts of a trace.
+ */
+class TraceReader {
+  /** @brief This variable stores the current position in the trace. */
+  char const *position;
+
+  /** @brief This variable stores the end of the trace. */
+  char const *end;
+
+public:
+  /**
+   * @brief This constructor creates a reader for the given trace.
+   *
+   * @param data This variable stores the start of the trace.
+   * @param size This number specifies the length of `data` in bytes.
+   */
+  TraceReader(char const *data, size_t size)
+      : position{data}, end{data + size} {}
+
+  /**
+   * @brief This method checks if the reader reached the end of the trace.
+   *
+   * @retval true If there are no more calls in the trace
+   * @retval false Otherwise
+   */
+  bool done() const noexcept { return position == end; }
+
+  /**
+   * @brief This method reads a single byte.
+   *
+   * @throws runtime_error if the trace ends early
+   *
+   * @return The byte at the current position
+   */
+  uint8_t byte() {
+    if (position == end) {
+      throw runtime_error("Trace is truncated");
+    }
+    return static_cast<uint8_t>(*position++);
+  }
+
+  /**
+   * @brief This method reads a variable length number.
+   *
+   * @throws runtime_error if the trace ends early or the number is too large
+   *
+   * @return The number at the current position
+   */
+  size_t number() {
+    size_t result = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      uint8_t part = byte();
+      result |= static_cast<size_t>(part & 0x7F) << shift;
+      if ((part & 0x80) == 0) {
+        return result;
+      }
+    }
+    throw runtime_error("Trace contains an invalid number");
+  }
+
+  /**
+   * @brief This method reads a text argument.
+   *
+   * @throws runtime_error if the trace ends early
+   *
+   * @return A view of the text in the trace
+   */
+  string_view text() {
+    size_t length = number();
+    if (length > static_cast<size_t>(end - position)) {
+      throw runtime_error("Trace is truncated");
+    }
+    string_view result{position, length};
+    position += length;
+    return result;
+  }
+};
+
+/**
+ * @brief This function replaces the letters and digits of a scalar.
+ *
+ * The function keeps the length and the style of the scalar: It does not
+ * change quotes, escape sequences, the header of block scalars, white space,
+ * punctuation and non-ASCII characters. The replacement only depends on the
+ * text of the scalar, so an alias still refers to its (scrambled) anchor.
+ *
+ * @param text This variable contains the text of the scalar as it appears
+ *             in the input.
+ *
+ * @return A scalar of the same length and style as `text`
+ */
+string scramble(string_view text) {
+  string result{text};
+  uint64_t random = yaypeg::hash(text.data(), text.size()) | 1;
+  size_t position = 0;
+  bool quoted = !text.empty() && text[0] == '"';
+  if (!text.empty() && (text[0] == '|' || text[0] == '>')) {
+    position = text.find('\n');
+    position = position == string_view::npos ? text.size() : position;
+  }
+
+  for (; position < result.size(); position++) {
+    char character = result[position];
+    if (quoted && character == '\\' && position + 1 < result.size()) {
+      // We keep the escaped character and the digits of `\x`, `\u` and `\U`
+      char escaped = result[++position];
+      position += escaped == 'x' ? 2 : escaped == 'u' ? 4 : 0;
+      position += escaped == 'U' ? 8 : 0;
+      continue;
+    }
+    // xorshift64
+    random ^= random << 13;
+    random ^= random >> 7;
+    random ^= random << 17;
+    if (character >= 'a' && character <= 'z') {
+      result[position] = static_cast<char>('a' + random % 26);
+    } else if (character >= 'A' && character <= 'Z') {
+      result[position] = static_cast<char>('A' + random % 26);
+    } else if (character >= '0' && character <= '9') {
+      result[position] = static_cast<char>('0' + random % 10);
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief This function checks that a trace event closes the innermost open
+ *        node of a trace.
+ *
+ * @param open This stack stores the events that opened the current nodes.
+ * @param opening This number specifies the event that has to open the
+ *                innermost node.
+ *
+ * @throws runtime_error if the innermost node was not opened by `opening`
+ */
+void closeNode(vector<uint8_t> &open, uint8_t opening) {
+  if (open.empty() || open.back() != opening) {
+    throw runtime_error("Trace contains an unbalanced event");
+  }
+  open.pop_back();
+}
+
+} // namespace
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This constructor creates a listener with an empty trace.
+ *
+ * @param parent This argument specifies the parent key of the key set this
+ *               listener produces.
+ * @param settings This argument specifies options for the conversion.
+ * @param scrambleScalars This value specifies if the trace stores scrambled
+ *                        versions of all scalars instead of their text.
+ */
+TraceListener::TraceListener(Key const &parent, Options const &settings,
+                             bool scrambleScalars)
+    : Listener{parent, settings}, trace{signature, sizeof(signature)},
+      scrambled{scrambleScalars} {
+  trace.push_back(static_cast<char>(version));
+}
+
+/**
+ * @brief This method records a call without arguments.
+ *
+ * @param event This number specifies the method.
+ */
+void TraceListener::record(uint8_t event) {
+  trace.push_back(static_cast<char>(event));
+}
+
+/**
+ * @brief This method records a call with a text argument.
+ *
+ * @param event This number specifies the method.
+ * @param text This argument stores the text of the call.
+ */
+void TraceListener::record(uint8_t event, string_view text) {
+  record(event);
+  append(text.size());
+  trace.append(scrambled ? scramble(text) : string{text});
+}
+
+/**
+ * @brief This method adds a variable length number to the trace.
+ *
+ * @param number This argument stores the number the method adds.
+ */
+void TraceListener::append(size_t number) {
+  // Every byte stores 7 bits of the number, starting with the lowest bits.
+  // The highest bit marks that another byte follows.
+  while (number >= 0x80) {
+    trace.push_back(static_cast<char>((number & 0x7F) | 0x80));
+    number >>= 7;
+  }
+  trace.push_back(static_cast<char>(number));
+}
+
+/**
+ * @brief This method records a value and stores it at the current key.
+ *
+ * @param text This variable contains the text of the value as it appears in
+ *             the input.
+ */
+void TraceListener::exitValue(string_view text) {
+  auto indentation = blockIndentation.find(text.data());
+  if (indentation == blockIndentation.end()) {
+    record(EXIT_VALUE, text);
+  } else {
+    record(EXIT_INDENTED_VALUE);
+    append(indentation->second);
+    append(text.size());
+    trace.append(scrambled ? scramble(text) : string{text});
+  }
+  Listener::exitValue(text);
+}
+
+/**
+ * @brief This method records a key and adds it to the current key name.
+ *
+ * @param text This variable contains the text of the key as it appears in
+ *             the input.
+ */
+void TraceListener::exitKey(string_view text) {
+  record(EXIT_KEY, text);
+  Listener::exitKey(text);
+}
+
+/**
+ * @brief This method records the end of a key-value pair.
+ */
+void TraceListener::exitPair() {
+  record(EXIT_PAIR);
+  Listener::exitPair();
+}
+
+/**
+ * @brief This method records an anchor of the current node.
+ *
+ * @param name This variable stores the name of the anchor.
+ */
+void TraceListener::exitAnchor(string_view name) {
+  record(EXIT_ANCHOR, name);
+  Listener::exitAnchor(name);
+}
+
+/**
+ * @brief This method records an alias and converts it.
+ *
+ * @param name This variable stores the name of the anchor the alias refers
+ *             to.
+ *
+ * @retval true If the method converted the alias
+ * @retval false If there is no complete node with the anchor `name`
+ */
+bool TraceListener::exitAlias(string_view name) {
+  record(EXIT_ALIAS, name);
+  return Listener::exitAlias(name);
+}
+
+/**
+ * @brief This method records the start of a sequence.
+ */
+void TraceListener::enterSequence() {
+  record(ENTER_SEQUENCE);
+  Listener::enterSequence();
+}
+
+/**
+ * @brief This method records the end of a sequence.
+ */
+void TraceListener::exitSequence() {
+  record(EXIT_SEQUENCE);
+  Listener::exitSequence();
+}
+
+/**
+ * @brief This method records the start of a sequence element.
+ */
+void TraceListener::enterElement() {
+  record(ENTER_ELEMENT);
+  Listener::enterElement();
+}
+
+/**
+ * @brief This method records the end of a sequence element.
+ */
+void TraceListener::exitElement() {
+  record(EXIT_ELEMENT);
+  Listener::exitElement();
+}
+
+/**
+ * @brief This method removes all keys and the recorded trace.
+ */
+void TraceListener::reset() {
+  Listener::reset();
+  trace.assign(signature, sizeof(signature));
+  trace.push_back(static_cast<char>(version));
+}
+
+/**
+ * @brief This method returns the recorded trace.
+ *
+ * @return The binary trace of all calls since the last reset
+ */
+string const &TraceListener::getTrace() const noexcept { return trace; }
+
+// -- Functions ----------------------------------------------------------------
+
+/**
+ * @brief This function converts a YAML file and stores the calls of the
+ *        walker in a trace file.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param filename This parameter stores the path of the YAML file.
+ * @param traceFilename This parameter stores the path of the trace file.
+ * @param options This argument specifies options for the conversion.
+ * @param scrambleScalars This value specifies if the trace stores scrambled
+ *                        versions of all scalars instead of their text.
+ *
+ * @throws std::system_error if the function is unable to read `filename` or
+ *         write `traceFilename`
+ * @throws parse_error if the file does not contain (supported) YAML data
+ * @throws limit_error if the conversion exceeds one of the limits stored in
+ *         `options`
+ *
+ * @return A key set containing the data stored in `filename`
+ */
+KeySet recordTrace(Key const &parent, string const &filename,
+                   string const &traceFilename, Options const &options,
+                   bool scrambleScalars) {
+  MappedFile file{filename};
+  string transcoded;
+  char const *data = file.data();
+  size_t size = file.size();
+  Encoding encoding = detectEncoding(data, size);
+  if (encoding != Encoding::UTF_8) {
+    transcoded = toUtf8(data, size, encoding, filename);
+    data = transcoded.data();
+    size = transcoded.size();
+  }
+
+  TraceListener listener{parent, options, scrambleScalars};
+  convertBuffer(listener, data, size, filename);
+
+  int descriptor =
+      open(traceFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (descriptor < 0) {
+    throw system_error(errno, system_category(),
+                       "Unable to create trace “" + traceFilename + "”");
+  }
+  try {
+    Writer writer{descriptor};
+    writer.write(listener.getTrace());
+    writer.flush();
+  } catch (...) {
+    close(descriptor);
+    throw;
+  }
+  if (close(descriptor) != 0) {
+    throw system_error(errno, system_category(),
+                       "Unable to write trace “" + traceFilename + "”");
+  }
+  return listener.getKeySet();
+}
+
+/**
+ * @brief This function calls the methods of a listener in the order stored
+ *        in a trace.
+ *
+ * The listener receives the text arguments as views into `data`. The
+ * function checks that keys, sequences and elements are properly nested
+ * before it calls the listener.
+ *
+ * @param data This variable stores the start of the trace.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param listener The function calls the methods of this listener.
+ *
+ * @throws std::runtime_error if `data` does not contain a valid trace
+ *
+ * @return The number of calls the function replayed
+ */
+size_t replayTrace(char const *data, size_t size, Listener &listener) {
+  if (size < sizeof(signature) + 1 ||
+      memcmp(data, signature, sizeof(signature)) != 0 ||
+      static_cast<uint8_t>(data[sizeof(signature)]) != version) {
+    throw runtime_error("Input is not a compatible trace");
+  }
+
+  TraceReader reader{data + sizeof(signature) + 1,
+                     size - sizeof(signature) - 1};
+  // The listener expects that every node it leaves is the innermost node it
+  // entered before. We therefore reject unbalanced traces before we call the
+  // listener.
+  vector<uint8_t> open;
+  size_t calls = 0;
+  for (; !reader.done(); calls++) {
+    switch (reader.byte()) {
+    case EXIT_VALUE:
+      listener.exitValue(reader.text());
+      break;
+    case EXIT_INDENTED_VALUE: {
+      // The listener finds the indentation by the location of the text
+      size_t indentation = reader.number();
+      string_view text = reader.text();
+      listener.setBlockIndentation({{text.data(), indentation}});
+      listener.exitValue(text);
+      break;
+    }
+    case EXIT_KEY:
+      listener.exitKey(reader.text());
+      open.push_back(EXIT_KEY);
+      break;
+    case EXIT_PAIR:
+      closeNode(open, EXIT_KEY);
+      listener.exitPair();
+      break;
+    case EXIT_ANCHOR:
+      listener.exitAnchor(reader.text());
+      break;
+    case EXIT_ALIAS: {
+      string_view name = reader.text();
+      if (!listener.exitAlias(name)) {
+        throw runtime_error("Alias “" + string{name} +
+                            "” does not refer to a previous anchor");
+      }
+      break;
+    }
+    case ENTER_SEQUENCE:
+      listener.enterSequence();
+      open.push_back(ENTER_SEQUENCE);
+      break;
+    case EXIT_SEQUENCE:
+      closeNode(open, ENTER_SEQUENCE);
+      listener.exitSequence();
+      break;
+    case ENTER_ELEMENT:
+      if (open.empty() || open.back() != ENTER_SEQUENCE) {
+        throw runtime_error("Trace contains an element outside of a "
+                            "sequence");
+      }
+      listener.enterElement();
+      open.push_back(ENTER_ELEMENT);
+      break;
+    case EXIT_ELEMENT:
+      closeNode(open, ENTER_ELEMENT);
+      listener.exitElement();
+      break;
+    default:
+      throw runtime_error("Trace contains an unknown event");
+    }
+  }
+  if (!open.empty()) {
+    throw runtime_error("Trace is truncated");
+  }
+  return calls;
+}
+
+} // namespace yaypeg
@@ -0,0 +1,205 @@
+/**
+ * @file
+ *
+ * @brief This file contains a listener that records the calls of the walker
+ *        and a function that replays them.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_TRACE_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_TRACE_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <kdb.hpp>
+
+#include "listener.hpp"
+#include "options.hpp"
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This listener creates keys like the default listener and records
+ *        every method call in a binary trace.
+ *
+ * A trace starts with an 8 byte signature and a format version. Every call
+ * uses one byte for the method. Calls with text arguments (keys, values,
+ * anchors and aliases) add the length of the text as variable length number
+ * followed by the text. Values of block scalars with an indentation indicator
+ * also store the content indentation, since the listener finds it by the
+ * position of the scalar in the input.
+ *
+ * To share a trace without its data, the listener can scramble all scalars:
+ * It then replaces the letters and digits of every scalar, but keeps its
+ * length and style (quotes, escape sequences and block scalar headers).
+ */
+class TraceListener : public Listener {
+  /** @brief This text stores the trace of all calls so far. */
+  std::string trace;
+
+  /** @brief This variable specifies if the trace stores scrambled scalars. */
+  bool scrambled;
+
+  /**
+   * @brief This method records a call without arguments.
+   *
+   * @param event This number specifies the method.
+   */
+  void record(uint8_t event);
+
+  /**
+   * @brief This method records a call with a text argument.
+   *
+   * @param event This number specifies the method.
+   * @param text This argument stores the text of the call.
+   */
+  void record(uint8_t event, std::string_view text);
+
+  /**
+   * @brief This method adds a variable length number to the trace.
+   *
+   * @param number This argument stores the number the method adds.
+   */
+  void append(size_t number);
+
+public:
+  /**
+   * @brief This constructor creates a listener with an empty trace.
+   *
+   * @param parent This argument specifies the parent key of the key set this
+   *               listener produces.
+   * @param settings This argument specifies options for the conversion.
+   * @param scrambleScalars This value specifies if the trace stores
+   *                        scrambled versions of all scalars instead of
+   *                        their text.
+   */
+  TraceListener(kdb::Key const &parent, Options const &settings = Options{},
+                bool scrambleScalars = false);
+
+  /**
+   * @brief This method records a value and stores it at the current key.
+   *
+   * @param text This variable contains the text of the value as it appears
+   *             in the input.
+   */
+  void exitValue(std::string_view text) override;
+
+  /**
+   * @brief This method records a key and adds it to the current key name.
+   *
+   * @param text This variable contains the text of the key as it appears in
+   *             the input.
+   */
+  void exitKey(std::string_view text) override;
+
+  /**
+   * @brief This method records the end of a key-value pair.
+   */
+  void exitPair() override;
+
+  /**
+   * @brief This method records an anchor of the current node.
+   *
+   * @param name This variable stores the name of the anchor.
+   */
+  void exitAnchor(std::string_view name) override;
+
+  /**
+   * @brief This method records an alias and converts it.
+   *
+   * @param name This variable stores the name of the anchor the alias refers
+   *             to.
+   *
+   * @retval true If the method converted the alias
+   * @retval false If there is no complete node with the anchor `name`
+   */
+  bool exitAlias(std::string_view name) override;
+
+  /**
+   * @brief This method records the start of a sequence.
+   */
+  void enterSequence() override;
+
+  /**
+   * @brief This method records the end of a sequence.
+   */
+  void exitSequence() override;
+
+  /**
+   * @brief This method records the start of a sequence element.
+   */
+  void enterElement() override;
+
+  /**
+   * @brief This method records the end of a sequence element.
+   */
+  void exitElement() override;
+
+  /**
+   * @brief This method removes all keys and the recorded trace.
+   */
+  void reset() override;
+
+  /**
+   * @brief This method returns the recorded trace.
+   *
+   * @return The binary trace of all calls since the last reset
+   */
+  std::string const &getTrace() const noexcept;
+};
+
+// -- Functions ----------------------------------------------------------------
+
+/**
+ * @brief This function converts a YAML file and stores the calls of the
+ *        walker in a trace file.
+ *
+ * @param parent This key specifies the parent of all keys the function
+ *               creates.
+ * @param filename This parameter stores the path of the YAML file.
+ * @param traceFilename This parameter stores the path of the trace file.
+ * @param options This argument specifies options for the conversion.
+ * @param scrambleScalars This value specifies if the trace stores scrambled
+ *                        versions of all scalars instead of their text.
+ *
+ * @throws std::system_error if the function is unable to read `filename` or
+ *         write `traceFilename`
+ * @throws parse_error if the file does not contain (supported) YAML data
+ * @throws limit_error if the conversion exceeds one of the limits stored in
+ *         `options`
+ *
+ * @return A key set containing the data stored in `filename`
+ */
+kdb::KeySet recordTrace(kdb::Key const &parent, std::string const &filename,
+                        std::string const &traceFilename,
+                        Options const &options = Options{},
+                        bool scrambleScalars = false);
+
+/**
+ * @brief This function calls the methods of a listener in the order stored
+ *        in a trace.
+ *
+ * The listener receives the text arguments as views into `data`. The
+ * function checks that keys, sequences and elements are properly nested
+ * before it calls the listener.
+ *
+ * @param data This variable stores the start of the trace.
+ * @param size This number specifies the length of `data` in bytes.
+ * @param listener The function calls the methods of this listener.
+ *
+ * @throws std::runtime_error if `data` does not contain a valid trace
+ *
+ * @return The number of calls the function replayed
+ */
+size_t replayTrace(char const *data, size_t size, Listener &listener);
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_TRACE_HPP
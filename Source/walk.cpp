@@ -9,10 +9,12 @@
 // -- Imports ------------------------------------------------------------------
 
 #include <iostream>
+#include <string_view>
 
 #include "listener.hpp"
 #include "walk.hpp"
 
+using tao::TAO_PEGTL_NAMESPACE::parse_error;
 using tao::TAO_PEGTL_NAMESPACE::parse_tree::node;
 
 // -- Functions ----------------------------------------------------------------
@@ -20,9 +22,23 @@ using tao::TAO_PEGTL_NAMESPACE::parse_tree::node;
 namespace {
 
 using std::string;
+using std::string_view;
 
+using yaypeg::LineIndex;
 using yaypeg::Listener;
 
+/**
+ * @brief This function returns the text of a tree node without copying it.
+ *
+ * @param node This argument stores the tree node.
+ *
+ * @return A view of the input that matched `node`
+ */
+string_view text(node const &node) {
+  return string_view{node.m_begin.data,
+                     static_cast<size_t>(node.m_end.data - node.m_begin.data)};
+}
+
 /**
  * @brief This function checks if a given string ends with another string
  *
@@ -40,6 +56,93 @@ bool ends_with(std::string const &text, std::string const &ending) {
              : std::equal(ending.rbegin(), ending.rend(), text.rbegin());
 }
 
+/**
+ * @brief This function returns the text of a flow node without the node
+ *        properties and the separation after them.
+ *
+ * @pre The first child of `flow` stores the properties of the node.
+ *
+ * @param flow This argument stores the flow node.
+ *
+ * @return A view of the content of `flow`
+ */
+string_view content(node const &flow) {
+  string_view rest = text(flow).substr(text(*flow.children.front()).size());
+
+  // Scalars never start with white space or the comment indicator `#`
+  size_t start = 0;
+  while (start < rest.size()) {
+    if (rest[start] == '#') {
+      start = rest.find('\n', start);
+    } else if (rest[start] == ' ' || rest[start] == '\t' ||
+               rest[start] == '\n' || rest[start] == '\r') {
+      start++;
+    } else {
+      break;
+    }
+  }
+  return start < rest.size() ? rest.substr(start) : string_view{};
+}
+
+/**
+ * @brief This function calls the listener methods for a node that stores the
+ *        value of a key.
+ *
+ * @param listener The function calls methods of this class.
+ * @param lines This index converts locations of the input to positions.
+ * @param node This argument stores the value node.
+ *
+ * @throws parse_error if the node is an alias for an unknown anchor
+ */
+void exitNode(Listener &listener, LineIndex const &lines, node const &node) {
+  if (node.children.empty()) {
+    listener.exitValue(text(node));
+    return;
+  }
+
+  auto const &property = *node.children.front();
+  if (ends_with(property.name(), "c_ns_alias_node")) {
+    if (!listener.exitAlias(text(property).substr(1))) {
+      throw parse_error("Alias “" + property.content() +
+                            "” does not refer to a previous anchor",
+                        lines.locate(property.m_begin.data));
+    }
+    return;
+  }
+
+  listener.exitAnchor(text(property).substr(1));
+  listener.exitValue(content(node));
+}
+
+/**
+ * @brief This function calls the listener methods for a node that stores a
+ *        key of a mapping.
+ *
+ * Anchors of keys refer to the scalar of the key and not to a key of the key
+ * set. The function therefore ignores them.
+ *
+ * @param listener The function calls methods of this class.
+ * @param lines This index converts locations of the input to positions.
+ * @param node This argument stores the key node.
+ *
+ * @throws parse_error if the key is an alias
+ */
+void exitKeyNode(Listener &listener, LineIndex const &lines,
+                 node const &node) {
+  if (node.children.empty()) {
+    listener.exitKey(text(node));
+    return;
+  }
+
+  auto const &property = *node.children.front();
+  if (ends_with(property.name(), "c_ns_alias_node")) {
+    throw parse_error("Aliases as mapping keys are not supported",
+                      lines.locate(property.m_begin.data));
+  }
+  listener.exitKey(content(node));
+}
+
+#ifndef NDEBUG
 /**
  * @brief This function returns the string representation of a tree node.
  *
@@ -65,6 +168,7 @@ string toString(node const &node, string const indent = "") {
   }
   return representation;
 }
+#endif
 
 /**
  * @brief This function will be called before the walker enters a tree node.
@@ -90,25 +194,29 @@ void executeEnter(Listener &listener, node const &node) {
  *
  * @param listener The function calls methods of this class when it encounters
  *                 a node with a certain name.
+ * @param lines This index converts locations of the input to positions.
  * @param node This argument stores the parse tree node
  */
-void executeExit(Listener &listener, node const &node) {
+void executeExit(Listener &listener, LineIndex const &lines,
+                 node const &node) {
   if (node.is_root()) {
     return;
   }
 
   if (ends_with(node.name(), "ns_s_block_map_implicit_key")) {
-    listener.exitKey(node.children.back()->content());
+    exitKeyNode(listener, lines, *node.children.back());
   } else if (ends_with(node.name(), "c_l_block_map_implicit_value") &&
              ends_with(node.children.back()->name(), "node")) {
-    listener.exitValue(node.children.back()->content());
+    exitNode(listener, lines, *node.children.back());
+  } else if (ends_with(node.name(), "c_ns_anchor_property")) {
+    listener.exitAnchor(text(node).substr(1));
   } else if (ends_with(node.name(), "ns_l_block_map_implicit_entry")) {
     listener.exitPair();
   } else if (ends_with(node.name(), "l_plus_block_sequence")) {
     listener.exitSequence();
   } else if (ends_with(node.name(), "c_l_block_seq_entry")) {
     if (ends_with(node.children.back()->name(), "node")) {
-      listener.exitValue(node.children.back()->content());
+      exitNode(listener, lines, *node.children.back());
     }
     listener.exitElement();
   }
@@ -119,19 +227,24 @@ void executeExit(Listener &listener, node const &node) {
  *
  * @param listener The function calls methods of this class while it traverses
  *                 the tree.
+ * @param lines This index converts locations of the input to positions.
  * @param node This argument stores the tree node that this function traverses.
  */
-void executeListenerMethods(Listener &listener, node const &node) {
+void executeListenerMethods(Listener &listener, LineIndex const &lines,
+                            node const &node) {
 
   executeEnter(listener, node);
 
-  if (!node.children.empty()) {
+  // The functions `exitKeyNode` and `exitNode` handle the properties of
+  // keys and flow nodes.
+  if (!node.children.empty() && !ends_with(node.name(), "node") &&
+      !ends_with(node.name(), "ns_s_block_map_implicit_key")) {
     for (auto &child : node.children) {
-      executeListenerMethods(listener, *child);
+      executeListenerMethods(listener, lines, *child);
     }
   }
 
-  executeExit(listener, node);
+  executeExit(listener, lines, node);
 }
 
 } // namespace
@@ -145,14 +258,18 @@ namespace yaypeg {
  *                 uses to convert the tree to a key set.
  * @param root This variable stores the root of the tree this function
  *             visits.
+ * @param lines This index converts locations of the input to positions in
+ *              error messages.
  */
-void walk(Listener &listener, node const &node) {
+void walk(Listener &listener, node const &node, LineIndex const &lines) {
+#ifndef NDEBUG
   using std::cerr;
   using std::endl;
 
   cerr << "\n— Tree ————\n" << endl;
 
   cerr << toString(node) << "\n" << endl;
+#endif
 
   // If the document contains only one a single value we call `exitValue`
   // for that function. We need to handle that special case to not add
@@ -161,11 +278,11 @@ void walk(Listener &listener, node const &node) {
   // `c_l_block_map_implicit_value`).
   if (node.is_root() && !node.children.empty() &&
       ends_with(node.children.back()->name(), "node")) {
-    listener.exitValue(node.children.back()->content());
+    exitNode(listener, lines, *node.children.back());
     return;
   }
 
-  executeListenerMethods(listener, node);
+  executeListenerMethods(listener, lines, node);
 }
 
 } // namespace yaypeg
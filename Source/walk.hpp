@@ -11,6 +11,7 @@
 
 // -- Imports ------------------------------------------------------------------
 
+#include "lines.hpp"
 #include "listener.hpp"
 
 #define TAO_PEGTL_NAMESPACE yaypeg
@@ -27,9 +28,12 @@ namespace yaypeg {
  * @param listener This argument specifies the listener which this function
  *                 uses to convert the tree to a key set.
  * @param root This variable stores the root of the tree this function visits.
+ * @param lines This index converts locations of the input to positions in
+ *              error messages.
  */
 void walk(Listener &listener,
-          tao::TAO_PEGTL_NAMESPACE::parse_tree::node const &root);
+          tao::TAO_PEGTL_NAMESPACE::parse_tree::node const &root,
+          LineIndex const &lines);
 
 } // namespace yaypeg
 
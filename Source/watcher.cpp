@@ -0,0 +1,384 @@
+/**
+ * @file
+ *
+ * @brief This file contains a class that reloads YAML files when they change.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <system_error>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "convert.hpp"
+#include "watcher.hpp"
+
+using std::string;
+using std::system_category;
+using std::system_error;
+using std::vector;
+
+using kdb::Key;
+using kdb::KeySet;
+
+// -- Constants ----------------------------------------------------------------
+
+namespace {
+
+/** @brief This constant specifies how often (in milliseconds) the background
+ *         thread tries to free replaced key sets that readers still use. */
+constexpr int reclaimInterval = 10;
+
+/**
+ * @brief This function splits a path into directory and file name.
+ *
+ * @param path This text stores the path of a file.
+ *
+ * @return The directory of `path` (`.` if the path does not contain one) and
+ *         the name of the file
+ */
+std::pair<string, string> split(string const &path) {
+  size_t slash = path.rfind('/');
+  if (slash == string::npos) {
+    return {".", path};
+  }
+  return {slash == 0 ? "/" : path.substr(0, slash), path.substr(slash + 1)};
+}
+
+} // namespace
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This constructor creates a snapshot for a pinned key set.
+ *
+ * @param occupied This variable stores the reader slot of the snapshot.
+ * @param current This variable stores the key set of the snapshot.
+ */
+Watcher::Snapshot::Snapshot(std::atomic<uint64_t> *occupied,
+                            ckdb::KeySet *current) noexcept
+    : slot{occupied}, keys{current} {}
+
+/**
+ * @brief This constructor moves a snapshot.
+ *
+ * @param other This variable stores the snapshot the constructor moves.
+ */
+Watcher::Snapshot::Snapshot(Snapshot &&other) noexcept
+    : slot{other.slot}, keys{other.keys} {
+  other.slot = nullptr;
+  other.keys = nullptr;
+}
+
+/**
+ * @brief This destructor releases the key set of the snapshot.
+ */
+Watcher::Snapshot::~Snapshot() {
+  if (slot) {
+    // The release store orders all reads of the key set before the watcher
+    // frees it.
+    slot->store(idle, std::memory_order_release);
+  }
+}
+
+/**
+ * @brief This method returns the number of keys of the snapshot.
+ *
+ * @return The size of the key set
+ */
+size_t Watcher::Snapshot::size() const noexcept {
+  return static_cast<size_t>(ckdb::ksGetSize(keys));
+}
+
+/**
+ * @brief This method returns the key at the given position.
+ *
+ * @param index This number specifies the position of the key.
+ *
+ * @return The key at position `index`, which stays valid as long as the
+ *         snapshot exists
+ */
+ckdb::Key const *Watcher::Snapshot::at(size_t index) const noexcept {
+  return ckdb::ksAtCursor(keys, static_cast<ckdb::cursor_t>(index));
+}
+
+/**
+ * @brief This method searches for a key without changing the key set.
+ *
+ * @param name This text stores the name of the key.
+ *
+ * @return The key with the given name or `nullptr`, if the snapshot does
+ *         not contain such a key
+ */
+ckdb::Key const *Watcher::Snapshot::lookup(string const &name) const {
+  Key search{name, KEY_END};
+  if (!search) {
+    return nullptr;
+  }
+
+  // Key sets store their keys in order, so a binary search only reads the
+  // key set
+  size_t low = 0;
+  size_t high = size();
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    if (ckdb::keyCmp(at(middle), search.getKey()) < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  if (low < size() && ckdb::keyCmp(at(low), search.getKey()) == 0) {
+    return at(low);
+  }
+  return nullptr;
+}
+
+/**
+ * @brief This constructor converts the given files and starts watching them
+ *        for changes.
+ *
+ * @param root This key specifies the parent of all keys the watcher creates.
+ * @param paths This vector stores the paths of the YAML files.
+ * @param settings This argument specifies options for the conversions.
+ *
+ * @throws std::system_error if the constructor is unable to watch a file
+ * @throws input_error if the constructor is unable to read a file
+ * @throws parse_error if a file does not contain (supported) YAML data
+ */
+Watcher::Watcher(Key const &root, vector<string> paths,
+                 Options const &settings)
+    : parent{root.dup()}, options{settings}, filenames{std::move(paths)} {
+  for (auto const &filename : filenames) {
+    files.push_back(convertFile(parent, filename, options));
+  }
+  KeySet keys;
+  for (auto const &file : files) {
+    keys.append(file);
+  }
+  current.store(keys.release());
+
+  try {
+    notifier = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stopper = eventfd(0, EFD_CLOEXEC);
+    if (notifier < 0 || stopper < 0) {
+      throw system_error(errno, system_category(),
+                         "Unable to create file notifications");
+    }
+    // Editors often replace a file by renaming a new version, so the watcher
+    // watches the directory of each file instead of the file itself.
+    for (auto const &filename : filenames) {
+      int watch = inotify_add_watch(notifier, split(filename).first.c_str(),
+                                    IN_CLOSE_WRITE | IN_MOVED_TO);
+      if (watch < 0) {
+        throw system_error(errno, system_category(),
+                           "Unable to watch “" + filename + "”");
+      }
+      watches.push_back(watch);
+    }
+    worker = std::thread{&Watcher::run, this};
+  } catch (...) {
+    close();
+    ckdb::ksDel(current.load());
+    throw;
+  }
+}
+
+/**
+ * @brief This destructor stops the background thread and frees all key sets.
+ *
+ * @pre No snapshot of the watcher exists anymore.
+ */
+Watcher::~Watcher() {
+  // Writing to an event file descriptor only fails if its counter
+  // overflows
+  uint64_t signal = 1;
+  [[maybe_unused]] ssize_t written = write(stopper, &signal, sizeof(signal));
+  worker.join();
+  close();
+
+  ckdb::ksDel(current.load());
+  for (auto const &[keys, replaced] : retired) {
+    ckdb::ksDel(keys);
+  }
+}
+
+/**
+ * @brief This method closes the file descriptors of the watcher.
+ */
+void Watcher::close() noexcept {
+  for (int descriptor : {notifier, stopper}) {
+    if (descriptor >= 0) {
+      ::close(descriptor);
+    }
+  }
+  notifier = stopper = -1;
+}
+
+/**
+ * @brief This method waits for changes and reloads the changed files.
+ */
+void Watcher::run() {
+  alignas(inotify_event) char buffer[4096];
+
+  for (;;) {
+    pollfd descriptors[] = {{notifier, POLLIN, 0}, {stopper, POLLIN, 0}};
+    int timeout = retired.empty() ? -1 : reclaimInterval;
+    if (poll(descriptors, 2, timeout) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    if (descriptors[1].revents != 0) {
+      return;
+    }
+
+    // Collect all pending events first, so that a burst of writes causes
+    // only one new key set
+    vector<bool> changed(filenames.size(), false);
+    ssize_t length;
+    while ((length = read(notifier, buffer, sizeof(buffer))) > 0) {
+      for (char *position = buffer; position < buffer + length;) {
+        auto event = reinterpret_cast<inotify_event *>(position);
+        for (size_t file = 0; file < filenames.size(); file++) {
+          if (watches[file] == event->wd && event->len > 0 &&
+              split(filenames[file]).second == event->name) {
+            changed[file] = true;
+          }
+        }
+        position += sizeof(inotify_event) + event->len;
+      }
+    }
+
+    bool reloaded = false;
+    for (size_t file = 0; file < filenames.size(); file++) {
+      if (changed[file] && reload(file)) {
+        reloaded = true;
+      }
+    }
+    if (reloaded) {
+      publish();
+    }
+    reclaim();
+  }
+}
+
+/**
+ * @brief This method converts a watched file again.
+ *
+ * @param file This number specifies the index of the file.
+ *
+ * @retval true If the conversion was successful
+ * @retval false Otherwise
+ */
+bool Watcher::reload(size_t file) {
+  try {
+    files[file] = convertFile(parent, filenames[file], options);
+    return true;
+  } catch (std::exception const &) {
+    failed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+}
+
+/**
+ * @brief This method publishes the keys of all files as a new key set.
+ */
+void Watcher::publish() {
+  KeySet keys;
+  for (auto const &file : files) {
+    keys.append(file);
+  }
+
+  // A reader that still uses the old key set pinned an epoch before the
+  // swap, which is smaller than the epoch after the increment.
+  ckdb::KeySet *replaced = current.exchange(keys.release());
+  uint64_t swapped = epoch.fetch_add(1) + 1;
+  retired.emplace_back(replaced, swapped);
+  published.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief This method frees all replaced key sets no reader uses anymore.
+ */
+void Watcher::reclaim() {
+  uint64_t oldest = idle;
+  for (auto const &reader : readers) {
+    oldest = std::min(oldest, reader.epoch.load());
+  }
+
+  auto used = retired.begin();
+  for (auto &entry : retired) {
+    if (entry.second <= oldest) {
+      ckdb::ksDel(entry.first);
+    } else {
+      *used++ = entry;
+    }
+  }
+  retired.erase(used, retired.end());
+}
+
+/**
+ * @brief This method returns the current version of the keys.
+ *
+ * The method does not lock and does not wait for a running reload. It only
+ * waits, yielding to other threads, while 64 snapshots exist at the same
+ * time.
+ *
+ * @return A snapshot of the current key set
+ */
+Watcher::Snapshot Watcher::snapshot() const noexcept {
+  size_t start =
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) % readerSlots;
+  for (size_t attempt = 0;; attempt++) {
+    auto &slot = readers[(start + attempt) % readerSlots].epoch;
+    uint64_t expected = idle;
+    // The reader pins the epoch before it loads the key set. The watcher
+    // therefore keeps every key set the reader may load.
+    if (slot.load(std::memory_order_relaxed) == idle &&
+        slot.compare_exchange_strong(expected, epoch.load())) {
+      return Snapshot{&slot, current.load()};
+    }
+    // All slots are taken: Let the readers that hold them run, before we
+    // check them again
+    if (attempt % readerSlots == readerSlots - 1) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+/**
+ * @brief This method returns how often the watcher published new keys.
+ *
+ * @return The number of successful reloads
+ */
+uint64_t Watcher::version() const noexcept {
+  return published.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief This method returns how often a reload failed.
+ *
+ * The watcher keeps the last valid keys, if a changed file does not contain
+ * valid YAML data.
+ *
+ * @return The number of failed reloads
+ */
+uint64_t Watcher::failures() const noexcept {
+  return failed.load(std::memory_order_relaxed);
+}
+
+} // namespace yaypeg
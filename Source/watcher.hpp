@@ -0,0 +1,261 @@
+/**
+ * @file
+ *
+ * @brief This file contains a class that reloads YAML files when they change.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_WATCHER_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_WATCHER_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <kdb.hpp>
+
+#include "options.hpp"
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This class converts YAML files and converts them again on a
+ *        background thread whenever inotify reports a change.
+ *
+ * The watcher publishes every version of the keys as a new immutable key set
+ * by swapping an atomic pointer. Readers never wait for a reload and never
+ * see a partially converted key set. The watcher frees an old key set only
+ * after all readers that might still use it released their snapshot
+ * (epoch-based reclamation).
+ */
+class Watcher {
+public:
+  /**
+   * @brief This class gives a reader access to one version of the keys.
+   *
+   * The key set of a snapshot does not change and stays valid as long as the
+   * snapshot exists. Other threads read the same key set at the same time,
+   * so the class only offers functions that do not modify it (Elektra's
+   * lookup functions update the cursor of a key set).
+   */
+  class Snapshot {
+    friend class Watcher;
+
+    /** @brief This variable stores the reader slot the snapshot occupies. */
+    std::atomic<uint64_t> *slot;
+
+    /** @brief This variable stores the key set of the snapshot. */
+    ckdb::KeySet *keys;
+
+    /**
+     * @brief This constructor creates a snapshot for a pinned key set.
+     *
+     * @param occupied This variable stores the reader slot of the snapshot.
+     * @param current This variable stores the key set of the snapshot.
+     */
+    Snapshot(std::atomic<uint64_t> *occupied, ckdb::KeySet *current) noexcept;
+
+  public:
+    /**
+     * @brief This constructor moves a snapshot.
+     *
+     * @param other This variable stores the snapshot the constructor moves.
+     */
+    Snapshot(Snapshot &&other) noexcept;
+
+    Snapshot(Snapshot const &) = delete;
+    Snapshot &operator=(Snapshot const &) = delete;
+    Snapshot &operator=(Snapshot &&) = delete;
+
+    /**
+     * @brief This destructor releases the key set of the snapshot.
+     */
+    ~Snapshot();
+
+    /**
+     * @brief This method returns the number of keys of the snapshot.
+     *
+     * @return The size of the key set
+     */
+    size_t size() const noexcept;
+
+    /**
+     * @brief This method returns the key at the given position.
+     *
+     * @param index This number specifies the position of the key.
+     *
+     * @return The key at position `index`, which stays valid as long as the
+     *         snapshot exists
+     */
+    ckdb::Key const *at(size_t index) const noexcept;
+
+    /**
+     * @brief This method searches for a key without changing the key set.
+     *
+     * @param name This text stores the name of the key.
+     *
+     * @return The key with the given name or `nullptr`, if the snapshot does
+     *         not contain such a key
+     */
+    ckdb::Key const *lookup(std::string const &name) const;
+  };
+
+private:
+  /** @brief This constant specifies the maximum number of snapshots that
+   *         may exist at the same time without waiting. */
+  static constexpr size_t readerSlots = 64;
+
+  /** @brief This constant marks a reader slot without snapshot. */
+  static constexpr uint64_t idle = UINT64_MAX;
+
+  /** @brief This struct stores the epoch a reader pinned in its own cache
+   *         line. */
+  struct alignas(64) Slot {
+    /** @brief This variable stores the pinned epoch or `idle`. */
+    std::atomic<uint64_t> epoch{idle};
+  };
+
+  /** @brief This key specifies the parent of all keys of the watcher. */
+  kdb::Key parent;
+
+  /** @brief This variable stores the options for the conversions. */
+  Options options;
+
+  /** @brief This vector stores the paths of the watched files. */
+  std::vector<std::string> filenames;
+
+  /** @brief This vector stores the keys of every watched file. */
+  std::vector<kdb::KeySet> files;
+
+  /** @brief This vector stores the inotify watch of every file. */
+  std::vector<int> watches;
+
+  /** @brief This array stores the epochs readers pinned. */
+  mutable std::array<Slot, readerSlots> readers;
+
+  /** @brief This variable stores the global epoch, which the watcher
+   *         increments whenever it replaces a key set. */
+  std::atomic<uint64_t> epoch{0};
+
+  /** @brief This variable stores the current key set. */
+  std::atomic<ckdb::KeySet *> current{nullptr};
+
+  /** @brief This vector stores replaced key sets and the epoch after their
+   *         replacement. Only the background thread accesses it. */
+  std::vector<std::pair<ckdb::KeySet *, uint64_t>> retired;
+
+  /** @brief This variable counts the published versions of the keys. */
+  std::atomic<uint64_t> published{0};
+
+  /** @brief This variable counts the reloads that failed. */
+  std::atomic<uint64_t> failed{0};
+
+  /** @brief This variable stores the inotify file descriptor. */
+  int notifier = -1;
+
+  /** @brief This variable stores the event file descriptor that stops the
+   *         background thread. */
+  int stopper = -1;
+
+  /** @brief This variable stores the background thread. */
+  std::thread worker;
+
+  /**
+   * @brief This method waits for changes and reloads the changed files.
+   */
+  void run();
+
+  /**
+   * @brief This method converts a watched file again.
+   *
+   * @param file This number specifies the index of the file.
+   *
+   * @retval true If the conversion was successful
+   * @retval false Otherwise
+   */
+  bool reload(size_t file);
+
+  /**
+   * @brief This method publishes the keys of all files as a new key set.
+   */
+  void publish();
+
+  /**
+   * @brief This method frees all replaced key sets no reader uses anymore.
+   */
+  void reclaim();
+
+  /**
+   * @brief This method closes the file descriptors of the watcher.
+   */
+  void close() noexcept;
+
+public:
+  /**
+   * @brief This constructor converts the given files and starts watching
+   *        them for changes.
+   *
+   * @param root This key specifies the parent of all keys the watcher
+   *             creates.
+   * @param paths This vector stores the paths of the YAML files.
+   * @param settings This argument specifies options for the conversions.
+   *
+   * @throws std::system_error if the constructor is unable to watch a file
+   * @throws input_error if the constructor is unable to read a file
+   * @throws parse_error if a file does not contain (supported) YAML data
+   */
+  Watcher(kdb::Key const &root, std::vector<std::string> paths,
+          Options const &settings = Options{});
+
+  Watcher(Watcher const &) = delete;
+  Watcher &operator=(Watcher const &) = delete;
+
+  /**
+   * @brief This destructor stops the background thread and frees all key
+   *        sets.
+   *
+   * @pre No snapshot of the watcher exists anymore.
+   */
+  ~Watcher();
+
+  /**
+   * @brief This method returns the current version of the keys.
+   *
+   * The method does not lock and does not wait for a running reload. It only
+   * waits, yielding to other threads, while 64 snapshots exist at the same
+   * time.
+   *
+   * @return A snapshot of the current key set
+   */
+  Snapshot snapshot() const noexcept;
+
+  /**
+   * @brief This method returns how often the watcher published new keys.
+   *
+   * @return The number of successful reloads
+   */
+  uint64_t version() const noexcept;
+
+  /**
+   * @brief This method returns how often a reload failed.
+   *
+   * The watcher keeps the last valid keys, if a changed file does not
+   * contain valid YAML data.
+   *
+   * @return The number of failed reloads
+   */
+  uint64_t failures() const noexcept;
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_WATCHER_HPP
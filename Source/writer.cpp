@@ -0,0 +1,145 @@
+/**
+ * @file
+ *
+ * @brief This file contains a buffered writer for file descriptors.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cerrno>
+#include <system_error>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "writer.hpp"
+
+// -- Functions ----------------------------------------------------------------
+
+namespace {
+
+using std::system_category;
+using std::system_error;
+
+/**
+ * @brief This function writes all data described by the given vectors to a
+ *        file descriptor.
+ *
+ * @param descriptor This number specifies the file descriptor of the output.
+ * @param vectors This array stores the location and size of the data.
+ * @param count This number specifies the length of `vectors`.
+ *
+ * @throws std::system_error if writing to the file descriptor fails
+ */
+void writeAll(int descriptor, iovec *vectors, int count) {
+  while (count > 0) {
+    ssize_t written = writev(descriptor, vectors, count);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written < 0) {
+      throw system_error(errno, system_category(), "Unable to write output");
+    }
+
+    // Skip the vectors the kernel wrote completely and adjust the first
+    // partially written vector
+    size_t bytes = static_cast<size_t>(written);
+    while (count > 0 && bytes >= vectors->iov_len) {
+      bytes -= vectors->iov_len;
+      vectors++;
+      count--;
+    }
+    if (count > 0) {
+      vectors->iov_base = static_cast<char *>(vectors->iov_base) + bytes;
+      vectors->iov_len -= bytes;
+    }
+  }
+}
+
+} // namespace
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This constructor creates a writer for the given file descriptor.
+ *
+ * @param output This number specifies the file descriptor of the output. The
+ *               writer does not close the descriptor.
+ * @param size This number specifies the capacity of the output buffer.
+ */
+Writer::Writer(int output, size_t size)
+    : descriptor{output}, buffer{new char[size > 0 ? size : 1]},
+      capacity{size > 0 ? size : 1} {}
+
+/**
+ * @brief This destructor writes the remaining data of the buffer. It ignores
+ *        errors; call `flush` to detect them.
+ */
+Writer::~Writer() {
+  try {
+    flush();
+  } catch (system_error const &) {
+  }
+}
+
+/**
+ * @brief This method writes the buffer followed by the given data to the file
+ *        descriptor.
+ *
+ * @param data This variable stores data that does not fit into the buffer.
+ * @param size This number specifies the length of `data`.
+ *
+ * @throws std::system_error if writing to the file descriptor fails
+ */
+void Writer::spill(char const *data, size_t size) {
+  // Small chunks go into the (now empty) buffer, large chunks directly to the
+  // file descriptor together with the buffered data in a single system call
+  if (size < capacity / 2) {
+    flush();
+    memcpy(buffer.get(), data, size);
+    used = size;
+    return;
+  }
+
+  iovec vectors[] = {{buffer.get(), used},
+                     {const_cast<char *>(data), size}};
+  used = 0;
+  writeAll(descriptor, vectors, 2);
+}
+
+/**
+ * @brief This method adds the given number of spaces to the output.
+ *
+ * @param count This number specifies how many spaces the method writes.
+ *
+ * @throws std::system_error if writing to the file descriptor fails
+ */
+void Writer::indent(size_t count) {
+  static char const spaces[] = "                                "
+                               "                                ";
+  while (count > sizeof(spaces) - 1) {
+    write(spaces, sizeof(spaces) - 1);
+    count -= sizeof(spaces) - 1;
+  }
+  write(spaces, count);
+}
+
+/**
+ * @brief This method writes all buffered data to the file descriptor.
+ *
+ * @throws std::system_error if writing to the file descriptor fails
+ */
+void Writer::flush() {
+  if (used == 0) {
+    return;
+  }
+  iovec vector = {buffer.get(), used};
+  used = 0;
+  writeAll(descriptor, &vector, 1);
+}
+
+} // namespace yaypeg
@@ -0,0 +1,129 @@
+/**
+ * @file
+ *
+ * @brief This file contains a buffered writer for file descriptors.
+ *
+ * @copyright BSD License (see LICENSE.md or https://www.libelektra.org)
+ */
+
+#ifndef ELEKTRA_PLUGIN_YAYPEG_WRITER_HPP
+#define ELEKTRA_PLUGIN_YAYPEG_WRITER_HPP
+
+// -- Imports ------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+// -- Class --------------------------------------------------------------------
+
+namespace yaypeg {
+
+/**
+ * @brief This class collects output in a large buffer and writes it to a file
+ *        descriptor with as few system calls as possible.
+ */
+class Writer {
+  /** @brief This variable specifies the file descriptor of the output. */
+  int descriptor;
+
+  /** @brief This buffer stores data that the writer did not flush yet. */
+  std::unique_ptr<char[]> buffer;
+
+  /** @brief This number stores the capacity of `buffer`. */
+  size_t capacity;
+
+  /** @brief This number stores the number of used bytes in `buffer`. */
+  size_t used = 0;
+
+  /**
+   * @brief This method writes the buffer followed by the given data to the
+   *        file descriptor.
+   *
+   * @param data This variable stores data that does not fit into the buffer.
+   * @param size This number specifies the length of `data`.
+   *
+   * @throws std::system_error if writing to the file descriptor fails
+   */
+  void spill(char const *data, size_t size);
+
+public:
+  /**
+   * @brief This constructor creates a writer for the given file descriptor.
+   *
+   * @param output This number specifies the file descriptor of the output.
+   *               The writer does not close the descriptor.
+   * @param size This number specifies the capacity of the output buffer.
+   */
+  explicit Writer(int output, size_t size = 1 << 20);
+
+  Writer(Writer const &) = delete;
+  Writer &operator=(Writer const &) = delete;
+
+  /**
+   * @brief This destructor writes the remaining data of the buffer. It
+   *        ignores errors; call `flush` to detect them.
+   */
+  ~Writer();
+
+  /**
+   * @brief This method adds the given data to the output.
+   *
+   * @param data This variable stores the data this method writes.
+   * @param size This number specifies the length of `data`.
+   *
+   * @throws std::system_error if writing to the file descriptor fails
+   */
+  void write(char const *data, size_t size) {
+    if (size <= capacity - used) {
+      memcpy(buffer.get() + used, data, size);
+      used += size;
+      return;
+    }
+    spill(data, size);
+  }
+
+  /**
+   * @brief This method adds the given text to the output.
+   *
+   * @param text This argument stores the text this method writes.
+   *
+   * @throws std::system_error if writing to the file descriptor fails
+   */
+  void write(std::string_view text) { write(text.data(), text.size()); }
+
+  /**
+   * @brief This method adds a single character to the output.
+   *
+   * @param character This argument stores the character this method writes.
+   *
+   * @throws std::system_error if writing to the file descriptor fails
+   */
+  void put(char character) {
+    if (used == capacity) {
+      flush();
+    }
+    buffer[used++] = character;
+  }
+
+  /**
+   * @brief This method adds the given number of spaces to the output.
+   *
+   * @param count This number specifies how many spaces the method writes.
+   *
+   * @throws std::system_error if writing to the file descriptor fails
+   */
+  void indent(size_t count);
+
+  /**
+   * @brief This method writes all buffered data to the file descriptor.
+   *
+   * @throws std::system_error if writing to the file descriptor fails
+   */
+  void flush();
+};
+
+} // namespace yaypeg
+
+#endif // ELEKTRA_PLUGIN_YAYPEG_WRITER_HPP
@@ -1,82 +1,476 @@
 // -- Imports ------------------------------------------------------------------
 
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#define TAO_PEGTL_NAMESPACE yaypeg
 
 #include <tao/pegtl.hpp>
 
 #include <kdb.hpp>
 
+#include "check.hpp"
 #include "convert.hpp"
+#include "emitter.hpp"
+#include "file.hpp"
+#include "incremental.hpp"
+#include "intern.hpp"
+#include "limits.hpp"
+#include "memory.hpp"
+#include "query.hpp"
+#include "trace.hpp"
+#include "writer.hpp"
 
 using std::cerr;
-using std::cout;
 using std::endl;
 using std::string;
+using std::string_view;
+using std::system_error;
+using std::vector;
 
-using tao::pegtl::input_error;
-using tao::pegtl::parse_error;
+using tao::TAO_PEGTL_NAMESPACE::input_error;
+using tao::TAO_PEGTL_NAMESPACE::parse_error;
 
 using ckdb::keyNew;
 using kdb::Key;
 using kdb::KeySet;
 
 using yaypeg::addToKeySet;
+using yaypeg::checkFile;
+using yaypeg::emit;
+using yaypeg::IncrementalParser;
+using yaypeg::InternTable;
+using yaypeg::limit_error;
+using yaypeg::MemoryUsage;
+using yaypeg::Options;
+using yaypeg::queryFile;
+using yaypeg::readFile;
+using yaypeg::recordTrace;
+using yaypeg::Writer;
 
 #if defined(__clang__)
-#include <spdlog/spdlog.h>
-
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
 
-using spdlog::logger;
-using spdlog::set_level;
-using spdlog::set_pattern;
-using spdlog::stderr_color_mt;
 using spdlog::level::trace;
-
-using std::shared_ptr;
-
-shared_ptr<logger> console;
+using spdlog::sinks::stderr_color_sink_st;
 #endif
 
 // -- Functions ----------------------------------------------------------------
 
-void printOutput(KeySet const &keys) {
-  cout << endl << "— Output ————" << endl << endl;
+/** @brief This enumeration specifies the output formats of the tool. */
+enum class Format { TEXT, NDJSON, NULL_DELIMITED, YAML };
+
+/**
+ * @brief This function writes the given text as JSON string.
+ *
+ * @param text This argument stores the text the function writes.
+ * @param writer The function writes the string to this output.
+ */
+void writeJsonString(string_view text, Writer &writer) {
+  static char const digits[] = "0123456789abcdef";
+
+  writer.put('"');
+  size_t start = 0;
+  for (size_t position = 0; position < text.size(); position++) {
+    auto character = static_cast<unsigned char>(text[position]);
+    if (character >= 0x20 && character != '"' && character != '\\') {
+      continue;
+    }
+    writer.write(text.data() + start, position - start);
+    start = position + 1;
+    switch (character) {
+    case '"':
+      writer.write("\\\"");
+      break;
+    case '\\':
+      writer.write("\\\\");
+      break;
+    case '\n':
+      writer.write("\\n");
+      break;
+    case '\t':
+      writer.write("\\t");
+      break;
+    case '\r':
+      writer.write("\\r");
+      break;
+    default: {
+      char escape[] = {'\\', 'u', '0', '0', digits[character >> 4],
+                       digits[character & 0xf]};
+      writer.write(escape, sizeof(escape));
+    }
+    }
+  }
+  writer.write(text.data() + start, text.size() - start);
+  writer.put('"');
+}
+
+/**
+ * @brief This function writes a key as `name: value` line to an output
+ *        buffer.
+ *
+ * @param name This text stores the name of the key.
+ * @param value This text stores the value of the key.
+ * @param writer The function writes the line to this output.
+ *
+ * @throws std::system_error if writing to the output fails
+ */
+void writeLine(string_view name, string_view value, Writer &writer) {
+  writer.write(name);
+  writer.put(':');
+  if (!value.empty()) {
+    writer.put(' ');
+    writer.write(value);
+  }
+  writer.put('\n');
+}
+
+/**
+ * @brief This function writes the given keys to an output buffer.
+ *
+ * The function streams names and values directly from the keys into the
+ * output buffer.
+ *
+ * @param keys This key set stores the keys the function prints.
+ * @param parent This key specifies the root of the YAML output.
+ * @param format This value specifies the output format.
+ * @param writer The function writes the keys to this output.
+ *
+ * @throws std::system_error if writing to the output fails
+ * @throws std::invalid_argument if YAML is unable to represent the keys
+ */
+void printOutput(KeySet const &keys, Key const &parent, Format format,
+                 Writer &writer) {
+  if (format == Format::YAML) {
+    emit(keys, parent, writer);
+    return;
+  }
+
   for (auto key : keys) {
-    cout << key.getName() << ":"
-         << (key.getStringSize() > 1 ? " " + key.getString() : "") << endl;
+    ckdb::Key *handle = key.getKey();
+    string_view name{ckdb::keyName(handle)};
+    ssize_t size = ckdb::keyGetValueSize(handle);
+    string_view value = size > 1 ? string_view{ckdb::keyString(handle),
+                                               static_cast<size_t>(size - 1)}
+                                 : string_view{};
+
+    switch (format) {
+    case Format::TEXT:
+      writeLine(name, value, writer);
+      break;
+    case Format::NDJSON:
+      writer.write("{\"name\":");
+      writeJsonString(name, writer);
+      writer.write(",\"value\":");
+      if (size > 0) {
+        writeJsonString(value, writer);
+      } else {
+        writer.write("null");
+      }
+      if (ckdb::Key const *type = ckdb::keyGetMeta(handle, "type")) {
+        writer.write(",\"type\":");
+        writeJsonString(ckdb::keyString(type), writer);
+      }
+      writer.write("}\n");
+      break;
+    case Format::NULL_DELIMITED:
+      writer.write(name);
+      writer.put('\0');
+      writer.write(value);
+      writer.put('\0');
+      break;
+    case Format::YAML:
+      break;
+    }
+  }
+}
+
+/**
+ * @brief This function writes the changes of an incremental update to an
+ *        output buffer.
+ *
+ * The function writes one `name: value` line per key and marks removed keys
+ * with `-`, changed keys with `~` and added keys with `+`.
+ *
+ * @param changes This argument stores the changes the function prints.
+ * @param writer The function writes the changes to this output.
+ *
+ * @throws std::system_error if writing to the output fails
+ */
+void printChanges(IncrementalParser::Changes const &changes, Writer &writer) {
+  std::pair<char, KeySet const *> const groups[] = {
+      {'-', &changes.removed}, {'~', &changes.changed}, {'+', &changes.added}};
+  for (auto const &[marker, keys] : groups) {
+    for (auto key : *keys) {
+      writer.put(marker);
+      writer.put(' ');
+      writeLine(key.getName(), key.getString(), writer);
+    }
   }
 }
 
+/**
+ * @brief This function prints usage information about the intern table.
+ *
+ * @param table This argument stores the table the function describes.
+ */
+void printStatistics(InternTable const &table) {
+  auto statistics = table.statistics();
+  cerr << "— Statistics ————\n\n"
+       << "Interned scalars: " << statistics.lookups << " lookups, "
+       << statistics.hits << " hits, " << statistics.entries
+       << " distinct entries\n"
+       << "Intern table full: " << statistics.rejected
+       << " scalars not stored\n"
+       << "Intern table size: " << statistics.bytesStored << " bytes\n"
+       << "Temporary values avoided: " << statistics.bytesAvoided
+       << " bytes\n"
+       << "Net effect: ";
+  // The table keeps its entries for the whole batch, while the listener
+  // frees temporary values right after it stored them in a key
+  if (statistics.bytesAvoided >= statistics.bytesStored) {
+    cerr << statistics.bytesAvoided - statistics.bytesStored
+         << " bytes fewer allocated" << endl;
+  } else {
+    cerr << statistics.bytesStored - statistics.bytesAvoided
+         << " bytes more retained" << endl;
+  }
+}
+
+/**
+ * @brief This function prints the memory usage of a conversion.
+ *
+ * @param filename This text stores the path of the converted file.
+ * @param memory This argument stores the memory usage the function prints.
+ */
+void printMemoryUsage(string const &filename, MemoryUsage const &memory) {
+  cerr << "— Memory “" << filename << "” ————\n\n"
+       << "Input: " << memory.inputBytes << " bytes\n"
+       << "Parse: " << memory.parsePeakBytes() << " bytes peak (state "
+       << memory.parserPeakBytes << " bytes, tree " << memory.treeBytes
+       << " bytes)\n"
+       << "Walk: " << memory.walkPeakBytes() << " bytes peak (listener "
+       << memory.listenerPeakBytes << " bytes)\n"
+       << "Key set: " << memory.retainedBytes() << " bytes retained\n"
+       << "Peak: " << memory.peakBytes() << " bytes ("
+       << memory.bytesPerInputByte() << " bytes per input byte)" << endl;
+}
+
 // -- Main ---------------------------------------------------------------------
 
 int main(int argc, char *argv[]) {
+  string usage = string{"Usage: "} + argv[0] +
+                 " [--format text|ndjson|null|yaml] [--statistics] [--memory]"
+                 " [--types] [--query path]… [--check]"
+                 " [--trace path [--scramble]] filename…\n       " +
+                 argv[0] + " --diff old new";
+  Format format = Format::TEXT;
+  bool statistics = false;
+  bool types = false;
+  bool memory = false;
+  bool check = false;
+  bool diff = false;
+  string tracePath;
+  bool scramble = false;
+  vector<string> queries;
+  int argument = 1;
+  for (; argument < argc && strncmp(argv[argument], "--", 2) == 0;
+       argument++) {
+    string option = argv[argument];
+    if (option == "--statistics") {
+      statistics = true;
+      continue;
+    }
+    if (option == "--types") {
+      types = true;
+      continue;
+    }
+    if (option == "--memory") {
+      memory = true;
+      continue;
+    }
+    if (option == "--check") {
+      check = true;
+      continue;
+    }
+    if (option == "--diff") {
+      diff = true;
+      continue;
+    }
+    if (option == "--query" && argument + 1 < argc) {
+      queries.push_back(argv[++argument]);
+      continue;
+    }
+    if (option == "--trace" && argument + 1 < argc) {
+      tracePath = argv[++argument];
+      continue;
+    }
+    if (option == "--scramble") {
+      scramble = true;
+      continue;
+    }
+    if (option != "--format" || argument + 1 >= argc) {
+      cerr << usage << endl;
+      return EXIT_FAILURE;
+    }
+    string name = argv[++argument];
+    if (name == "text") {
+      format = Format::TEXT;
+    } else if (name == "ndjson") {
+      format = Format::NDJSON;
+    } else if (name == "null") {
+      format = Format::NULL_DELIMITED;
+    } else if (name == "yaml") {
+      format = Format::YAML;
+    } else {
+      cerr << "Unknown format “" << name << "”\n" << usage << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  // A trace stores the calls for exactly one file
+  if (argument >= argc ||
+      (!tracePath.empty() && (argument + 1 != argc || !queries.empty())) ||
+      (scramble && tracePath.empty())) {
+    cerr << usage << endl;
+    return EXIT_FAILURE;
+  }
+
+  // The diff mode converts the old file and prints how the keys change, when
+  // the incremental parser updates the document to the new file
+  if (diff) {
+    if (argc - argument != 2) {
+      cerr << usage << endl;
+      return EXIT_FAILURE;
+    }
+    try {
+      IncrementalParser parser{Key{"user", KEY_END}};
+      parser.update(readFile(argv[argument]));
+      Writer writer{STDOUT_FILENO};
+      printChanges(parser.update(readFile(argv[argument + 1])), writer);
+      writer.flush();
+    } catch (system_error const &error) {
+      cerr << "Unable to open input: " << error.what() << endl;
+      return EXIT_FAILURE;
+    } catch (parse_error const &error) {
+      cerr << "Unable to parse input: " << error.what() << endl;
+      return EXIT_FAILURE;
+    } catch (limit_error const &error) {
+      cerr << "Unable to parse input: " << error.what() << endl;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  // The check mode only reports invalid files and does not create any keys
+  if (check) {
+    bool valid = true;
+    for (; argument < argc; argument++) {
+      try {
+        checkFile(argv[argument]);
+      } catch (input_error const &error) {
+        cerr << "Unable to open input: " << error.what() << endl;
+        valid = false;
+      } catch (parse_error const &error) {
+        cerr << "Unable to parse input: " << error.what() << endl;
+        valid = false;
+      } catch (limit_error const &error) {
+        cerr << "Unable to parse input: " << error.what() << endl;
+        valid = false;
+      } catch (std::exception const &error) {
+        cerr << argv[argument] << ": " << error.what() << endl;
+        valid = false;
+      }
+    }
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  // All files of a batch share the same intern table
+  InternTable table;
+  Options options;
+  options.intern = &table;
+  options.resolveTypes = types;
+  MemoryUsage memoryUsage;
+  if (memory) {
+    options.memory = &memoryUsage;
+  }
 
 #if defined(__clang__)
-  set_pattern("%v");
-  set_level(trace);
-  console = stderr_color_mt("console");
+  // The tool converts the files one after another. It therefore does not
+  // need a thread-safe sink for the trace messages of the parser.
+  options.logger = std::make_shared<spdlog::logger>(
+      "yaypeg", std::make_shared<stderr_color_sink_st>());
+  options.logger->set_pattern("%v");
+  options.logger->set_level(trace);
 #endif
 
-  if (argc != 2) {
-    cerr << "Usage: " << argv[0] << " filename" << endl;
-    return EXIT_FAILURE;
-  }
+  Writer writer{STDOUT_FILENO};
+  bool success = true;
+  int first = argument;
+  for (; argument < argc; argument++) {
+    string filename = argv[argument];
+    KeySet keys;
+    Key parent{keyNew("user", KEY_END, "", KEY_VALUE)};
+    int status = -1;
+
+    try {
+      if (!tracePath.empty()) {
+        keys = recordTrace(parent, filename, tracePath, options, scramble);
+        status = keys.size() > 0 ? 1 : 0;
+      } else if (queries.empty()) {
+        status = addToKeySet(keys, parent, filename, options);
+      } else {
+        keys = queryFile(parent, filename, queries, options);
+        status = keys.size() > 0 ? 1 : 0;
+      }
+    } catch (system_error const &error) {
+      cerr << "Unable to open input: " << error.what() << endl;
+    } catch (input_error const &error) {
+      cerr << "Unable to open input: " << error.what() << endl;
+    } catch (parse_error const &error) {
+      cerr << "Unable to parse input: " << error.what() << endl;
+    } catch (limit_error const &error) {
+      cerr << "Unable to parse input: " << error.what() << endl;
+    } catch (std::exception const &error) {
+      cerr << filename << ": " << error.what() << endl;
+    }
+    success = success && status >= 0;
+    if (memory && status >= 0) {
+      printMemoryUsage(filename, memoryUsage);
+    }
 
-  string filename = argv[1];
-  KeySet keys;
-  Key parent{keyNew("user", KEY_END, "", KEY_VALUE)};
-  int status = -1;
+    try {
+      // YAML output separates the documents of multiple files
+      if (format == Format::YAML && argument != first) {
+        writer.write("---\n");
+      }
+      printOutput(keys, parent, format, writer);
+    } catch (system_error const &error) {
+      cerr << error.what() << endl;
+      return EXIT_FAILURE;
+    } catch (std::invalid_argument const &error) {
+      cerr << "Unable to write YAML: " << error.what() << endl;
+      success = false;
+    }
+  }
 
   try {
-    status = addToKeySet(keys, parent, filename);
-  } catch (input_error const &error) {
-    cerr << "Unable to open input: " << error.what() << endl;
-  } catch (parse_error const &error) {
-    cerr << "Unable to parse input: " << error.what() << endl;
+    writer.flush();
+  } catch (system_error const &error) {
+    cerr << error.what() << endl;
+    return EXIT_FAILURE;
   }
 
-  printOutput(keys);
-  return (status >= 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+  if (statistics) {
+    printStatistics(table);
+  }
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
 }
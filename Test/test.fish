@@ -4,7 +4,7 @@ set parser "Build/yaypeg"
 trap cleanup EXIT INT QUIT TERM
 
 function cleanup -d 'Remove temporary files'
-    rm -f "$output" "$difference"
+    rm -f "$output" "$difference" "$emitted"
 end
 
 set IFS (printf '\n\b')
@@ -20,7 +20,6 @@ for file in (find Data -depth 1 -type file -name '*.yaml' | sort)
         continue
     end
 
-    perl -0777pe 's/.*— Output ————\n\n(.*)/\1/sm' -i "$output"
     set difference (mktemp)
     set -l expected (printf "$file" | sed 's/\.[^.]*$/.txt/')
     if ! diff --side-by-side "$output" "$expected" >"$difference"
@@ -28,6 +27,229 @@ for file in (find Data -depth 1 -type file -name '*.yaml' | sort)
         cat "$difference" >&2
         set failed 'true'
     end
+
+    # Emitting the keys as YAML and converting the result again has to
+    # return the same keys
+    set emitted (mktemp)
+    if ! eval $parser --format yaml "\"$file\"" >"$emitted" 2>"$difference"
+        printf "\nUnable to emit the keys of “%s”:\n\n" "$file" >&2
+        cat "$difference" >&2
+        set failed 'true'
+    else if ! eval $parser "\"$emitted\"" 2>/dev/null | diff - "$expected" >"$difference"
+        printf "\nThe round trip for “%s” did not return the same keys:\n\n" "$file" >&2
+        cat "$difference" >&2
+        set failed 'true'
+    end
+end
+
+# The files in `Data/Complexity` contain input that caused super linear run
+# time in the past.
+for file in (find Data/Complexity -depth 1 -type file -name '*.yaml' | sort)
+    printf "• Check complexity of “%s”\n" "$file"
+
+    set -l error_message (Build/yaypeg-complexity "$file" 2>&1)
+    if test "$status" -ne 0
+        printf "\nThe conversion of “%s” exceeded the budget:\n\n" "$file" >&2
+        printf '%s\n\n' "$error_message" >&2
+        set failed 'true'
+    end
+end
+
+# The files in `Data/Types` check the type resolution of the core schema
+# (`--types`). Emitting the keys has to keep the types of typed values and
+# quote strings that look like other types.
+for file in (find Data/Types -depth 1 -type file -name '*.yaml' | sort)
+    printf "• Test types of “%s”\n" "$file"
+
+    set -l expected (cat (printf "$file" | sed 's/\.[^.]*$/.txt/'))
+    set -l result (Build/yaypeg --types --format ndjson "$file" 2>/dev/null)
+    if test "$result" != "$expected"
+        printf "\nThe types of “%s” were “%s” instead of “%s”\n\n" \
+            "$file" "$result" "$expected" >&2
+        set failed 'true'
+    end
+
+    set emitted (mktemp)
+    Build/yaypeg --types --format yaml "$file" >"$emitted" 2>/dev/null
+    set -l result (Build/yaypeg --types --format ndjson "$emitted" 2>/dev/null)
+    if test "$result" != "$expected"
+        printf "\nThe emitter changed the types of “%s” to “%s”\n\n" \
+            "$file" "$result" >&2
+        set failed 'true'
+    end
+
+    set -l strings (Build/yaypeg --format ndjson "$file" 2>/dev/null)
+    Build/yaypeg --format yaml "$file" >"$emitted" 2>/dev/null
+    set -l result (Build/yaypeg --types --format ndjson "$emitted" 2>/dev/null)
+    if test "$result" != "$strings"
+        printf "\nThe emitter did not quote the strings of “%s”: “%s”\n\n" \
+            "$file" "$result" >&2
+        set failed 'true'
+    end
+    rm -f "$emitted"
+end
+
+# Nested aliases in “billion laughs” documents create exponentially many keys.
+# The conversion has to stop with an error once the aliases exceed the
+# expansion budget.
+printf "• Check alias expansion budget\n"
+set -l error_message (Build/yaypeg 'Data/Complexity/Billion Laughs.yaml' \
+    2>&1 >/dev/null)
+if test "$status" -eq 0
+    or ! string match -q '*exceeds expansion budget*' -- $error_message
+    printf "\nThe conversion of “billion laughs” did not exceed the expansion budget\n\n" >&2
+    set failed 'true'
+end
+
+# Query single keys instead of converting the whole file
+printf "• Query keys\n"
+set -l result (Build/yaypeg --query d/g --query 'primes/#3' \
+    'Data/Map>Map>Plain Scalars.yaml' 'Data/Map>List>Plain Scalars.yaml' \
+    2>/dev/null)
+set -l expected 'user/d/g: h' 'user/primes/#3: seven'
+if test "$result" != "$expected"
+    printf "\nThe query returned “%s” instead of “%s”\n\n" "$result" \
+        "$expected" >&2
+    set failed 'true'
+end
+
+# Queries have to report invalid input and exceeded limits instead of
+# aborting
+set -l invalid (mktemp)
+printf 'key: "unterminated\n' >"$invalid"
+set -l error_message (Build/yaypeg --query key "$invalid" 2>&1 >/dev/null)
+if test "$status" -ne 1
+    or ! string match -q 'Unable to parse input*' -- $error_message
+    printf "\nThe query did not reject invalid input:\n\n" >&2
+    printf '%s\n\n' "$error_message" >&2
+    set failed 'true'
+end
+rm -f "$invalid"
+set -l error_message (Build/yaypeg --query a \
+    'Data/Complexity/Billion Laughs.yaml' 2>&1 >/dev/null)
+if test "$status" -ne 1
+    or ! string match -q '*exceeds expansion budget*' -- $error_message
+    printf "\nThe query of “billion laughs” did not exceed the expansion budget:\n\n" >&2
+    printf '%s\n\n' "$error_message" >&2
+    set failed 'true'
+end
+
+# Update documents with the incremental parser and compare the changes it
+# reports. Every directory in `Data/Diff` contains an old and a new version of
+# a document. If the update has to fail, the file `Error.txt` contains the
+# start of the error message instead.
+for directory in (find Data/Diff -depth 1 -type directory | sort)
+    printf "• Check changes of “%s”\n" "$directory"
+
+    if test -e "$directory/Error.txt"
+        set -l error_message (Build/yaypeg --diff "$directory/Old.yaml" \
+            "$directory/New.yaml" 2>&1 >/dev/null)
+        set -l expected (cat "$directory/Error.txt")
+        if test "$status" -ne 1
+            or ! string match -q -- "$expected*" $error_message
+            printf "\nThe update of “%s” did not fail with “%s”:\n\n" \
+                "$directory" "$expected" >&2
+            printf '%s\n\n' "$error_message" >&2
+            set failed 'true'
+        end
+        continue
+    end
+
+    set -l result (Build/yaypeg --diff "$directory/Old.yaml" \
+        "$directory/New.yaml" 2>/dev/null)
+    set -l expected (cat "$directory/Changes.txt")
+    if test "$result" != "$expected"
+        printf "\nThe changes of “%s” were “%s” instead of “%s”\n\n" \
+            "$directory" "$result" "$expected" >&2
+        set failed 'true'
+    end
+end
+
+# Check the syntax of all test files without converting them
+printf "• Check test files\n"
+set -l error_message (Build/yaypeg --check \
+    (find Data -depth 1 -type file -name '*.yaml' | sort) 2>&1)
+if test "$status" -ne 0
+    printf "\nThe check mode rejected valid input:\n\n" >&2
+    printf '%s\n\n' "$error_message" >&2
+    set failed 'true'
+end
+set -l invalid (mktemp)
+printf 'key: "unterminated\n' >"$invalid"
+set -l error_message (Build/yaypeg --check "$invalid" 2>&1)
+if test "$status" -eq 0
+    or ! string match -q 'Unable to parse input*' -- $error_message
+    printf "\nThe check mode did not report a syntax error:\n\n" >&2
+    printf '%s\n\n' "$error_message" >&2
+    set failed 'true'
+end
+rm -f "$invalid"
+
+# Record the listener calls for test files and replay them without parsing
+printf "• Replay traces\n"
+set -l trace (mktemp)
+for file in 'Data/Map>Anchor, Alias.yaml' 'Data/Map>Block Scalars.yaml'
+    set -l expected (Build/yaypeg --trace "$trace" "$file" 2>/dev/null)
+    set -l result (Build/yaypeg-replay --print "$trace")
+    if test "$result" != "$expected"
+        printf "\nThe replay of “%s” returned “%s” instead of “%s”\n\n" \
+            "$file" "$result" "$expected" >&2
+        set failed 'true'
+    end
+
+    # A scrambled trace creates different keys and values of the same length
+    Build/yaypeg --trace "$trace" --scramble "$file" >/dev/null 2>&1
+    set -l result (Build/yaypeg-replay --print "$trace")
+    set -l lengths (string length -- $result)
+    set -l expected_lengths (string length -- $expected)
+    if test "$result" = "$expected"
+        or test "$lengths" != "$expected_lengths"
+        printf "\nThe scrambled replay of “%s” returned “%s”\n\n" \
+            "$file" "$result" >&2
+        set failed 'true'
+    end
+end
+
+# The tool does not record a trace for invalid input
+set -l invalid (mktemp)
+printf 'key: "unterminated\n' >"$invalid"
+rm -f "$trace"
+set -l error_message (Build/yaypeg --trace "$trace" "$invalid" 2>&1 >/dev/null)
+if test "$status" -ne 1
+    or ! string match -q 'Unable to parse input*' -- $error_message
+    or test -e "$trace"
+    printf "\nThe trace mode did not reject invalid input:\n\n" >&2
+    printf '%s\n\n' "$error_message" >&2
+    set failed 'true'
+end
+rm -f "$invalid"
+
+# The end of a pair (`\x03`) without a key is invalid
+printf 'YAYPEGTR\x01\x03' >"$trace"
+if Build/yaypeg-replay --print "$trace" >/dev/null 2>&1
+    printf "\nThe replay accepted an unbalanced trace\n\n" >&2
+    set failed 'true'
+end
+rm -f "$trace"
+
+# Check parts of the library the command line tool does not expose
+printf "• Run self test\n"
+if ! Build/yaypeg-selftest
+    printf "\nThe self test failed\n\n" >&2
+    set failed 'true'
+end
+
+# Convert all test files on multiple threads at the same time. Please use a
+# build with Thread Sanitizer (`ENABLE_THREAD_SANITIZER`) to detect data
+# races. Debug builds print the parse tree of every conversion, so we only
+# show the summary of the tool.
+printf "• Convert test files concurrently\n"
+set -l error_message (Build/yaypeg-stress --threads 4 --iterations 5 \
+    (find Data -depth 1 -type file -name '*.yaml' | sort) 2>&1)
+if test "$status" -ne 0
+    printf "\nConcurrent conversions failed:\n\n" >&2
+    printf '%s\n\n' "$error_message[-1]" >&2
+    set failed 'true'
 end
 
 if test "$failed" = 'true'